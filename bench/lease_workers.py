@@ -0,0 +1,142 @@
+"""Scale-out check on one host: a coordinator and several lease workers.
+
+Starts `miner --server --coordinator` and N `miner --worker` processes on
+localhost, then over gRPC:
+
+  1. starts a hard job and checks that worker progress shows up in
+     GetStatusV2 (hashes and hash rate) on the coordinator,
+  2. pauses it, resumes it by id and checks that it carries on from the
+     paused cursor and hash count instead of starting over,
+  3. starts an easy job and checks that the workers solve it once.
+
+    python lease_workers.py --miner ../build/miner --workers 3
+
+Exits non-zero on the first failed check. Needs grpcio (see
+rest_server/requirements.txt); the stubs are taken from rest_server.
+"""
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "rest_server"))
+import grpc  # noqa: E402
+import miner_pb2  # noqa: E402
+import miner_pb2_grpc  # noqa: E402
+
+HARD_TARGET = "00000000" + "f" * 56   # About 4e9 hashes per solution
+EASY_TARGET = "0000" + "f" * 60       # About 65536
+
+
+def job(target, seed):
+    return miner_pb2.StartMiningV2Request(
+        hash=bytes([seed]) * 32,
+        addr1=bytes([1]) * 20,
+        addr2=bytes([2]) * 20,
+        value=seed,
+        timestamp=int(time.time()),
+        target=bytes.fromhex(target),
+        time_limit=600,
+    )
+
+
+def status(stub, session_id):
+    return stub.GetStatusV2(miner_pb2.GetStatusRequest(session_id=session_id), timeout=5)
+
+
+def wait_for(what, stub, session_id, predicate, timeout):
+    """Polls the session's status until predicate accepts it"""
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        current = status(stub, session_id)
+        if predicate(current):
+            return current
+        time.sleep(0.25)
+    raise AssertionError(f"timed out waiting for {what}")
+
+
+def check(condition, message):
+    if not condition:
+        raise AssertionError(message)
+    print(f"ok: {message}")
+
+
+def run_checks(stub, workers):
+    # 1. Progress reported by workers reaches the coordinator's status
+    session_id = stub.StartMiningV2(job(HARD_TARGET, 7), timeout=5).session_id
+    first = wait_for("worker progress", stub, session_id, lambda s: s.total_hashes > 0, 30)
+    later = wait_for("more progress", stub, session_id,
+                     lambda s: s.total_hashes > first.total_hashes and s.hash_rate > 0, 30)
+    check(later.is_mining, f"hard job mining on {workers} workers, {later.total_hashes} hashes, "
+                           f"{later.hash_rate:.2f} MH/s")
+
+    # 2. Resume carries on from the completed frontier
+    stub.PauseMining(miner_pb2.PauseMiningRequest(session_id=session_id), timeout=5)
+    paused = status(stub, session_id)
+    check(paused.paused and paused.total_hashes >= later.total_hashes,
+          f"paused at nonce {paused.current_nonce:08x} after {paused.total_hashes} hashes")
+    reply = stub.ResumeMining(miner_pb2.ResumeMiningRequest(session_id=session_id), timeout=5)
+    check(reply.success and reply.session_id == session_id, "resumed under the same id")
+    resumed = status(stub, session_id)
+    check(resumed.total_hashes >= paused.total_hashes, "hash count kept across the pause")
+    moved = wait_for("progress after resume", stub, session_id, lambda s: s.total_hashes > paused.total_hashes, 30)
+    check(moved.current_nonce >= paused.current_nonce,
+          f"cursor moved on from the pause, now {moved.current_nonce:08x}")
+    stub.PauseMining(miner_pb2.PauseMiningRequest(session_id=session_id), timeout=5)
+
+    # 3. An easy job is solved once and re-verified by the coordinator
+    session_id = stub.StartMiningV2(job(EASY_TARGET, 9), timeout=5).session_id
+    solved = wait_for("a solution", stub, session_id, lambda s: s.solution_found, 60)
+    check(not solved.is_mining and solved.verified_solutions == 1,
+          f"easy job solved after {solved.total_hashes} hashes")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Coordinator and lease workers on localhost")
+    parser.add_argument("--miner", default=os.path.join("..", "build", "miner"), help="Path to the miner binary")
+    parser.add_argument("--port", type=int, default=50071)
+    parser.add_argument("--workers", type=int, default=3)
+    parser.add_argument("--cpu-engines", type=int, default=1, help="CPU engines per worker")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as workdir:
+        config_path = os.path.join(workdir, "miner_config.json")
+        with open(config_path, "w") as f:
+            json.dump({
+                "cuda_engines": 0,
+                "cpu_engines": args.cpu_engines,
+                "auto_broadcast": False,
+                "lease_seconds": 1,
+                "lease_expiry_seconds": 5,
+                "stats_segment": "",
+                "session_archive": "",
+            }, f)
+
+        miner = os.path.abspath(args.miner)
+        common = ["--config", config_path, "--log-level", "warning"]
+        processes = [subprocess.Popen([miner, "--server", str(args.port), "--coordinator"] + common, cwd=workdir)]
+        try:
+            for i in range(args.workers):
+                processes.append(subprocess.Popen(
+                    [miner, "--worker", f"127.0.0.1:{args.port}", "--worker-id", f"w{i}"] + common, cwd=workdir))
+
+            channel = grpc.insecure_channel(f"127.0.0.1:{args.port}")
+            grpc.channel_ready_future(channel).result(timeout=15)
+            run_checks(miner_pb2_grpc.MinerServiceStub(channel), args.workers)
+        except AssertionError as e:
+            print(f"FAILED: {e}")
+            return 1
+        finally:
+            for process in processes:
+                process.terminate()
+            for process in processes:
+                process.wait()
+    print("All checks passed")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
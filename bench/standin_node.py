@@ -0,0 +1,71 @@
+"""Local stand-in for the node's JSON-RPC interface, used by submit_bench.
+
+Answers getsupportableleader and broadcastsupportticket like the node does,
+with an optional fixed delay, and keeps connections alive so the miner's
+RPC client can reuse them.
+
+    python standin_node.py --port 18443 --delay-ms 0
+"""
+import argparse
+import json
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class NodeHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    delay = 0.0
+    accepted = 0
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        try:
+            request = json.loads(self.rfile.read(length))
+        except ValueError:
+            self.reply({"result": None, "error": {"code": -32700, "message": "Parse error"}, "id": None})
+            return
+
+        if self.delay:
+            time.sleep(self.delay)
+
+        method = request.get("method")
+        if method == "broadcastsupportticket":
+            params = request.get("params") or [""]
+            if len(params[0]) != 176:  # 88-byte ticket as hex
+                result, error = None, {"code": -22, "message": "Ticket decode failed"}
+            else:
+                NodeHandler.accepted += 1
+                result, error = True, None
+        elif method == "getsupportableleader":
+            result, error = {"leader": "00" * 20, "height": 1}, None
+        else:
+            result, error = None, {"code": -32601, "message": "Method not found"}
+
+        self.reply({"result": result, "error": error, "id": request.get("id")})
+
+    def reply(self, body):
+        data = json.dumps(body).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def log_message(self, format, *args):
+        pass
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Stand-in node for submission load tests")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=18443)
+    parser.add_argument("--delay-ms", type=float, default=0.0, help="Fixed processing delay per request")
+    args = parser.parse_args()
+
+    NodeHandler.delay = args.delay_ms / 1000.0
+    server = ThreadingHTTPServer((args.host, args.port), NodeHandler)
+    print(f"Stand-in node listening on {args.host}:{args.port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        print(f"Accepted {NodeHandler.accepted} tickets")
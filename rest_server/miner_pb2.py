@@ -14,7 +14,7 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x0bminer.proto\x12\x05miner\"\x94\x01\n\x12StartMiningRequest\x12\x0c\n\x04hash\x18\x01 \x01(\t\x12\r\n\x05\x61\x64\x64r1\x18\x02 \x01(\t\x12\r\n\x05\x61\x64\x64r2\x18\x03 \x01(\t\x12\r\n\x05value\x18\x04 \x01(\x04\x12\x11\n\ttimestamp\x18\x05 \x01(\x04\x12\x0e\n\x06target\x18\x06 \x01(\t\x12\x12\n\ntime_limit\x18\x07 \x01(\r\x12\x0c\n\x04\x66lag\x18\x08 \x01(\r\"K\n\x13StartMiningResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0f\n\x07message\x18\x02 \x01(\t\x12\x12\n\nsession_id\x18\x03 \x01(\t\"(\n\x12PauseMiningRequest\x12\x12\n\nsession_id\x18\x01 \x01(\t\"K\n\x13PauseMiningResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0f\n\x07message\x18\x02 \x01(\t\x12\x12\n\nstate_file\x18\x03 \x01(\t\"=\n\x13ResumeMiningRequest\x12\x12\n\nstate_file\x18\x01 \x01(\t\x12\x12\n\ntime_limit\x18\x02 \x01(\r\"L\n\x14ResumeMiningResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0f\n\x07message\x18\x02 \x01(\t\x12\x12\n\nsession_id\x18\x03 \x01(\t\"&\n\x10GetStatusRequest\x12\x12\n\nsession_id\x18\x01 \x01(\t\"w\n\x11GetStatusResponse\x12\x11\n\tis_mining\x18\x01 \x01(\x08\x12\x14\n\x0ctotal_hashes\x18\x02 \x01(\x04\x12\x11\n\thash_rate\x18\x03 \x01(\x01\x12\x15\n\rcurrent_nonce\x18\x04 \x01(\t\x12\x0f\n\x07message\x18\x05 \x01(\t2\xa3\x02\n\x0cMinerService\x12\x44\n\x0bStartMining\x12\x19.miner.StartMiningRequest\x1a\x1a.miner.StartMiningResponse\x12\x44\n\x0bPauseMining\x12\x19.miner.PauseMiningRequest\x1a\x1a.miner.PauseMiningResponse\x12G\n\x0cResumeMining\x12\x1a.miner.ResumeMiningRequest\x1a\x1b.miner.ResumeMiningResponse\x12>\n\tGetStatus\x12\x17.miner.GetStatusRequest\x1a\x18.miner.GetStatusResponseb\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x0bminer.proto\x12\x05miner\"\xa6\x01\n\x12StartMiningRequest\x12\x0c\n\x04hash\x18\x01 \x01(\t\x12\r\n\x05\x61\x64\x64r1\x18\x02 \x01(\t\x12\r\n\x05\x61\x64\x64r2\x18\x03 \x01(\t\x12\r\n\x05value\x18\x04 \x01(\x04\x12\x11\n\ttimestamp\x18\x05 \x01(\x04\x12\x0e\n\x06target\x18\x06 \x01(\t\x12\x12\n\ntime_limit\x18\x07 \x01(\r\x12\x0c\n\x04\x66lag\x18\x08 \x01(\r\x12\x10\n\x08group_id\x18\t \x01(\t\"]\n\x13StartMiningResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0f\n\x07message\x18\x02 \x01(\t\x12\x12\n\nsession_id\x18\x03 \x01(\t\x12\x10\n\x08\x61ttached\x18\x04 \x01(\x08\"8\n\x12PauseMiningRequest\x12\x12\n\nsession_id\x18\x01 \x01(\t\x12\x0e\n\x06\x63\x61ncel\x18\x02 \x01(\x08\"K\n\x13PauseMiningResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0f\n\x07message\x18\x02 \x01(\t\x12\x12\n\nstate_file\x18\x03 \x01(\t\"Q\n\x13ResumeMiningRequest\x12\x12\n\nstate_file\x18\x01 \x01(\t\x12\x12\n\ntime_limit\x18\x02 \x01(\r\x12\x12\n\nsession_id\x18\x03 \x01(\t\"L\n\x14ResumeMiningResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0f\n\x07message\x18\x02 \x01(\t\x12\x12\n\nsession_id\x18\x03 \x01(\t\"&\n\x10GetStatusRequest\x12\x12\n\nsession_id\x18\x01 \x01(\t\"\xaf\x01\n\x11GetStatusResponse\x12\x11\n\tis_mining\x18\x01 \x01(\x08\x12\x14\n\x0ctotal_hashes\x18\x02 \x01(\x04\x12\x11\n\thash_rate\x18\x03 \x01(\x01\x12\x15\n\rcurrent_nonce\x18\x04 \x01(\t\x12\x0f\n\x07message\x18\x05 \x01(\t\x12\x1a\n\x12verified_solutions\x18\x06 \x01(\x04\x12\x1a\n\x12rejected_solutions\x18\x07 \x01(\x04\"\xe3\x01\n\x14StartMiningV2Request\x12\x0c\n\x04hash\x18\x01 \x01(\x0c\x12\r\n\x05\x61\x64\x64r1\x18\x02 \x01(\x0c\x12\r\n\x05\x61\x64\x64r2\x18\x03 \x01(\x0c\x12\r\n\x05value\x18\x04 \x01(\x07\x12\x11\n\ttimestamp\x18\x05 \x01(\x07\x12\x0e\n\x06target\x18\x06 \x01(\x0c\x12\x12\n\ntime_limit\x18\x07 \x01(\r\x12\x0c\n\x04\x66lag\x18\x08 \x01(\r\x12\x0e\n\x06weight\x18\t \x01(\x01\x12\x15\n\rmax_hash_rate\x18\n \x01(\x01\x12\x12\n\nduty_cycle\x18\x0b \x01(\x01\x12\x10\n\x08group_id\x18\x0c \x01(\t\"\xb3\x03\n\x13GetStatusV2Response\x12\x11\n\tis_mining\x18\x01 \x01(\x08\x12\x14\n\x0ctotal_hashes\x18\x02 \x01(\x06\x12\x11\n\thash_rate\x18\x03 \x01(\x01\x12\x15\n\rcurrent_nonce\x18\x04 \x01(\x07\x12\x16\n\x0esolution_found\x18\x05 \x01(\x08\x12\x1a\n\x12verified_solutions\x18\x06 \x01(\x06\x12\x1a\n\x12rejected_solutions\x18\x07 \x01(\x06\x12\x1d\n\x15time_to_first_hash_ms\x18\x08 \x01(\x01\x12-\n\x0esubmit_latency\x18\t \x03(\x0b\x32\x15.miner.LatencySummary\x12\x12\n\ndifficulty\x18\n \x01(\x01\x12\x17\n\x0f\x65xpected_hashes\x18\x0b \x01(\x01\x12\x1b\n\x13success_probability\x18\x0c \x01(\x01\x12\x13\n\x0b\x65ta_seconds\x18\r \x01(\x01\x12\x12\n\ntime_limit\x18\x0e \x01(\x02\x12\x0e\n\x06paused\x18\x0f \x01(\x08\x12\x14\n\x0c\x63\x61ncelled_by\x18\x10 \x01(\t\x12\x12\n\nstate_file\x18\x11 \x01(\t\"m\n\x0eLatencySummary\x12\x0b\n\x03hop\x18\x01 \x01(\t\x12\r\n\x05\x63ount\x18\x02 \x01(\x06\x12\x0e\n\x06p50_ms\x18\x03 \x01(\x01\x12\x0e\n\x06p99_ms\x18\x04 \x01(\x01\x12\x0f\n\x07p999_ms\x18\x05 \x01(\x01\x12\x0e\n\x06max_ms\x18\x06 \x01(\x01\"S\n\x12SetThrottleRequest\x12\x12\n\nsession_id\x18\x01 \x01(\t\x12\x15\n\rmax_hash_rate\x18\x02 \x01(\x01\x12\x12\n\nduty_cycle\x18\x03 \x01(\x01\"7\n\x13SetThrottleResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0f\n\x07message\x18\x02 \x01(\t\"=\n\x12WatchStatusRequest\x12\x12\n\nsession_id\x18\x01 \x01(\t\x12\x13\n\x0binterval_ms\x18\x02 \x01(\r\"\x13\n\x11GetMetricsRequest\";\n\x0cMetricSample\x12\x0c\n\x04name\x18\x01 \x01(\t\x12\x0e\n\x06labels\x18\x02 \x01(\t\x12\r\n\x05value\x18\x03 \x01(\x01\"w\n\x12GetMetricsResponse\x12$\n\x07samples\x18\x01 \x03(\x0b\x32\x13.miner.MetricSample\x12\x0c\n\x04text\x18\x02 \x01(\t\x12-\n\x0esubmit_latency\x18\x03 \x03(\x0b\x32\x15.miner.LatencySummary\"P\n\x13\x41\x63quireLeaseRequest\x12\x11\n\tworker_id\x18\x01 \x01(\t\x12\x11\n\thash_rate\x18\x02 \x01(\x01\x12\x13\n\x0bgranularity\x18\x03 \x01(\r\"\x90\x02\n\x14\x41\x63quireLeaseResponse\x12\x11\n\thas_lease\x18\x01 \x01(\x08\x12\x10\n\x08lease_id\x18\x02 \x01(\x06\x12\x0e\n\x06job_id\x18\x03 \x01(\t\x12\x0c\n\x04hash\x18\x04 \x01(\x0c\x12\r\n\x05\x61\x64\x64r1\x18\x05 \x01(\x0c\x12\r\n\x05\x61\x64\x64r2\x18\x06 \x01(\x0c\x12\r\n\x05value\x18\x07 \x01(\x07\x12\x11\n\ttimestamp\x18\x08 \x01(\x07\x12\x0e\n\x06target\x18\t \x01(\x0c\x12\x0c\n\x04\x66lag\x18\n \x01(\r\x12\x13\n\x0bnonce_begin\x18\x0b \x01(\x07\x12\x13\n\x0bnonce_count\x18\x0c \x01(\x07\x12\x15\n\rexpires_in_ms\x18\r \x01(\r\x12\x16\n\x0eretry_after_ms\x18\x0e \x01(\r\"\x82\x01\n\x14\x43ompleteLeaseRequest\x12\x11\n\tworker_id\x18\x01 \x01(\t\x12\x10\n\x08lease_id\x18\x02 \x01(\x06\x12\x0e\n\x06hashes\x18\x03 \x01(\x06\x12\x17\n\x0f\x65lapsed_seconds\x18\x04 \x01(\x01\x12\r\n\x05\x66ound\x18\x05 \x01(\x08\x12\r\n\x05nonce\x18\x06 \x01(\x07\"L\n\x15\x43ompleteLeaseResponse\x12\x10\n\x08\x61\x63\x63\x65pted\x18\x01 \x01(\x08\x12\x10\n\x08job_done\x18\x02 \x01(\x08\x12\x0f\n\x07message\x18\x03 \x01(\t\"\x9b\x01\n\x0eTicketToVerify\x12\x0e\n\x06ticket\x18\x01 \x01(\x0c\x12\x0c\n\x04hash\x18\x02 \x01(\x0c\x12\r\n\x05\x61\x64\x64r1\x18\x03 \x01(\x0c\x12\r\n\x05\x61\x64\x64r2\x18\x04 \x01(\x0c\x12\r\n\x05value\x18\x05 \x01(\x07\x12\x11\n\ttimestamp\x18\x06 \x01(\x07\x12\x0c\n\x04\x66lag\x18\x07 \x01(\r\x12\r\n\x05nonce\x18\x08 \x01(\x07\x12\x0e\n\x06target\x18\t \x01(\x0c\"N\n\x14VerifyTicketsRequest\x12&\n\x07tickets\x18\x01 \x03(\x0b\x32\x15.miner.TicketToVerify\x12\x0e\n\x06target\x18\x02 \x01(\x0c\";\n\rTicketVerdict\x12\r\n\x05valid\x18\x01 \x01(\x08\x12\x0c\n\x04hash\x18\x02 \x01(\x0c\x12\r\n\x05\x65rror\x18\x03 \x01(\t\"?\n\x15VerifyTicketsResponse\x12&\n\x08verdicts\x18\x01 \x03(\x0b\x32\x14.miner.TicketVerdict2\xd2\x05\n\x0cMinerService\x12\x44\n\x0bStartMining\x12\x19.miner.StartMiningRequest\x1a\x1a.miner.StartMiningResponse\x12\x44\n\x0bPauseMining\x12\x19.miner.PauseMiningRequest\x1a\x1a.miner.PauseMiningResponse\x12G\n\x0cResumeMining\x12\x1a.miner.ResumeMiningRequest\x1a\x1b.miner.ResumeMiningResponse\x12>\n\tGetStatus\x12\x17.miner.GetStatusRequest\x1a\x18.miner.GetStatusResponse\x12H\n\rStartMiningV2\x12\x1b.miner.StartMiningV2Request\x1a\x1a.miner.StartMiningResponse\x12\x42\n\x0bGetStatusV2\x12\x17.miner.GetStatusRequest\x1a\x1a.miner.GetStatusV2Response\x12\x46\n\x0bWatchStatus\x12\x19.miner.WatchStatusRequest\x1a\x1a.miner.GetStatusV2Response0\x01\x12\x41\n\nGetMetrics\x12\x18.miner.GetMetricsRequest\x1a\x19.miner.GetMetricsResponse\x12\x44\n\x0bSetThrottle\x12\x19.miner.SetThrottleRequest\x1a\x1a.miner.SetThrottleResponse\x12N\n\rVerifyTickets\x12\x1b.miner.VerifyTicketsRequest\x1a\x1c.miner.VerifyTicketsResponse(\x01\x30\x01\x32\xa7\x01\n\x10LeaseCoordinator\x12G\n\x0c\x41\x63quireLease\x12\x1a.miner.AcquireLeaseRequest\x1a\x1b.miner.AcquireLeaseResponse\x12J\n\rCompleteLease\x12\x1b.miner.CompleteLeaseRequest\x1a\x1c.miner.CompleteLeaseResponseb\x06proto3')
 
 _globals = globals()
 _builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, _globals)
@@ -22,21 +22,57 @@ _builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'miner_pb2', _globals)
 if _descriptor._USE_C_DESCRIPTORS == False:
   DESCRIPTOR._options = None
   _globals['_STARTMININGREQUEST']._serialized_start=23
-  _globals['_STARTMININGREQUEST']._serialized_end=171
-  _globals['_STARTMININGRESPONSE']._serialized_start=173
-  _globals['_STARTMININGRESPONSE']._serialized_end=248
-  _globals['_PAUSEMININGREQUEST']._serialized_start=250
-  _globals['_PAUSEMININGREQUEST']._serialized_end=290
-  _globals['_PAUSEMININGRESPONSE']._serialized_start=292
-  _globals['_PAUSEMININGRESPONSE']._serialized_end=367
-  _globals['_RESUMEMININGREQUEST']._serialized_start=369
-  _globals['_RESUMEMININGREQUEST']._serialized_end=430
-  _globals['_RESUMEMININGRESPONSE']._serialized_start=432
-  _globals['_RESUMEMININGRESPONSE']._serialized_end=508
-  _globals['_GETSTATUSREQUEST']._serialized_start=510
-  _globals['_GETSTATUSREQUEST']._serialized_end=548
-  _globals['_GETSTATUSRESPONSE']._serialized_start=550
-  _globals['_GETSTATUSRESPONSE']._serialized_end=669
-  _globals['_MINERSERVICE']._serialized_start=672
-  _globals['_MINERSERVICE']._serialized_end=963
+  _globals['_STARTMININGREQUEST']._serialized_end=189
+  _globals['_STARTMININGRESPONSE']._serialized_start=191
+  _globals['_STARTMININGRESPONSE']._serialized_end=284
+  _globals['_PAUSEMININGREQUEST']._serialized_start=286
+  _globals['_PAUSEMININGREQUEST']._serialized_end=342
+  _globals['_PAUSEMININGRESPONSE']._serialized_start=344
+  _globals['_PAUSEMININGRESPONSE']._serialized_end=419
+  _globals['_RESUMEMININGREQUEST']._serialized_start=421
+  _globals['_RESUMEMININGREQUEST']._serialized_end=502
+  _globals['_RESUMEMININGRESPONSE']._serialized_start=504
+  _globals['_RESUMEMININGRESPONSE']._serialized_end=580
+  _globals['_GETSTATUSREQUEST']._serialized_start=582
+  _globals['_GETSTATUSREQUEST']._serialized_end=620
+  _globals['_GETSTATUSRESPONSE']._serialized_start=623
+  _globals['_GETSTATUSRESPONSE']._serialized_end=798
+  _globals['_STARTMININGV2REQUEST']._serialized_start=801
+  _globals['_STARTMININGV2REQUEST']._serialized_end=1028
+  _globals['_GETSTATUSV2RESPONSE']._serialized_start=1031
+  _globals['_GETSTATUSV2RESPONSE']._serialized_end=1466
+  _globals['_LATENCYSUMMARY']._serialized_start=1468
+  _globals['_LATENCYSUMMARY']._serialized_end=1577
+  _globals['_SETTHROTTLEREQUEST']._serialized_start=1579
+  _globals['_SETTHROTTLEREQUEST']._serialized_end=1662
+  _globals['_SETTHROTTLERESPONSE']._serialized_start=1664
+  _globals['_SETTHROTTLERESPONSE']._serialized_end=1719
+  _globals['_WATCHSTATUSREQUEST']._serialized_start=1721
+  _globals['_WATCHSTATUSREQUEST']._serialized_end=1782
+  _globals['_GETMETRICSREQUEST']._serialized_start=1784
+  _globals['_GETMETRICSREQUEST']._serialized_end=1803
+  _globals['_METRICSAMPLE']._serialized_start=1805
+  _globals['_METRICSAMPLE']._serialized_end=1864
+  _globals['_GETMETRICSRESPONSE']._serialized_start=1866
+  _globals['_GETMETRICSRESPONSE']._serialized_end=1985
+  _globals['_ACQUIRELEASEREQUEST']._serialized_start=1987
+  _globals['_ACQUIRELEASEREQUEST']._serialized_end=2067
+  _globals['_ACQUIRELEASERESPONSE']._serialized_start=2070
+  _globals['_ACQUIRELEASERESPONSE']._serialized_end=2342
+  _globals['_COMPLETELEASEREQUEST']._serialized_start=2345
+  _globals['_COMPLETELEASEREQUEST']._serialized_end=2475
+  _globals['_COMPLETELEASERESPONSE']._serialized_start=2477
+  _globals['_COMPLETELEASERESPONSE']._serialized_end=2553
+  _globals['_TICKETTOVERIFY']._serialized_start=2556
+  _globals['_TICKETTOVERIFY']._serialized_end=2711
+  _globals['_VERIFYTICKETSREQUEST']._serialized_start=2713
+  _globals['_VERIFYTICKETSREQUEST']._serialized_end=2791
+  _globals['_TICKETVERDICT']._serialized_start=2793
+  _globals['_TICKETVERDICT']._serialized_end=2852
+  _globals['_VERIFYTICKETSRESPONSE']._serialized_start=2854
+  _globals['_VERIFYTICKETSRESPONSE']._serialized_end=2917
+  _globals['_MINERSERVICE']._serialized_start=2920
+  _globals['_MINERSERVICE']._serialized_end=3642
+  _globals['_LEASECOORDINATOR']._serialized_start=3645
+  _globals['_LEASECOORDINATOR']._serialized_end=3812
 # @@protoc_insertion_point(module_scope)
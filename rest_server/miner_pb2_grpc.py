@@ -34,6 +34,36 @@ class MinerServiceStub(object):
                 request_serializer=miner__pb2.GetStatusRequest.SerializeToString,
                 response_deserializer=miner__pb2.GetStatusResponse.FromString,
                 )
+        self.StartMiningV2 = channel.unary_unary(
+                '/miner.MinerService/StartMiningV2',
+                request_serializer=miner__pb2.StartMiningV2Request.SerializeToString,
+                response_deserializer=miner__pb2.StartMiningResponse.FromString,
+                )
+        self.GetStatusV2 = channel.unary_unary(
+                '/miner.MinerService/GetStatusV2',
+                request_serializer=miner__pb2.GetStatusRequest.SerializeToString,
+                response_deserializer=miner__pb2.GetStatusV2Response.FromString,
+                )
+        self.GetMetrics = channel.unary_unary(
+                '/miner.MinerService/GetMetrics',
+                request_serializer=miner__pb2.GetMetricsRequest.SerializeToString,
+                response_deserializer=miner__pb2.GetMetricsResponse.FromString,
+                )
+        self.WatchStatus = channel.unary_stream(
+                '/miner.MinerService/WatchStatus',
+                request_serializer=miner__pb2.WatchStatusRequest.SerializeToString,
+                response_deserializer=miner__pb2.GetStatusV2Response.FromString,
+                )
+        self.SetThrottle = channel.unary_unary(
+                '/miner.MinerService/SetThrottle',
+                request_serializer=miner__pb2.SetThrottleRequest.SerializeToString,
+                response_deserializer=miner__pb2.SetThrottleResponse.FromString,
+                )
+        self.VerifyTickets = channel.stream_stream(
+                '/miner.MinerService/VerifyTickets',
+                request_serializer=miner__pb2.VerifyTicketsRequest.SerializeToString,
+                response_deserializer=miner__pb2.VerifyTicketsResponse.FromString,
+                )
 
 
 class MinerServiceServicer(object):
@@ -67,6 +97,49 @@ class MinerServiceServicer(object):
         context.set_details('Method not implemented!')
         raise NotImplementedError('Method not implemented!')
 
+    def StartMiningV2(self, request, context):
+        """v2: binary job fields and fixed-width numbers, no hex or decimal strings on the hot path
+        """
+        context.set_code(grpc.StatusCode.UNIMPLEMENTED)
+        context.set_details('Method not implemented!')
+        raise NotImplementedError('Method not implemented!')
+
+    def GetStatusV2(self, request, context):
+        """Missing associated documentation comment in .proto file.
+        """
+        context.set_code(grpc.StatusCode.UNIMPLEMENTED)
+        context.set_details('Method not implemented!')
+        raise NotImplementedError('Method not implemented!')
+
+    def GetMetrics(self, request, context):
+        """Snapshot of the miner metrics registry
+        """
+        context.set_code(grpc.StatusCode.UNIMPLEMENTED)
+        context.set_details('Method not implemented!')
+        raise NotImplementedError('Method not implemented!')
+
+    def WatchStatus(self, request, context):
+        """GetStatusV2 pushed every interval_ms until the session stops mining
+        """
+        context.set_code(grpc.StatusCode.UNIMPLEMENTED)
+        context.set_details('Method not implemented!')
+        raise NotImplementedError('Method not implemented!')
+
+    def SetThrottle(self, request, context):
+        """Cap throughput of every engine (empty session_id) or of one session, effective immediately
+        """
+        context.set_code(grpc.StatusCode.UNIMPLEMENTED)
+        context.set_details('Method not implemented!')
+        raise NotImplementedError('Method not implemented!')
+
+    def VerifyTickets(self, request_iterator, context):
+        """Bulk ticket validation: each request message is answered by one response
+        with a verdict per ticket, in the same order
+        """
+        context.set_code(grpc.StatusCode.UNIMPLEMENTED)
+        context.set_details('Method not implemented!')
+        raise NotImplementedError('Method not implemented!')
+
 
 def add_MinerServiceServicer_to_server(servicer, server):
     rpc_method_handlers = {
@@ -90,6 +163,36 @@ def add_MinerServiceServicer_to_server(servicer, server):
                     request_deserializer=miner__pb2.GetStatusRequest.FromString,
                     response_serializer=miner__pb2.GetStatusResponse.SerializeToString,
             ),
+            'StartMiningV2': grpc.unary_unary_rpc_method_handler(
+                    servicer.StartMiningV2,
+                    request_deserializer=miner__pb2.StartMiningV2Request.FromString,
+                    response_serializer=miner__pb2.StartMiningResponse.SerializeToString,
+            ),
+            'GetStatusV2': grpc.unary_unary_rpc_method_handler(
+                    servicer.GetStatusV2,
+                    request_deserializer=miner__pb2.GetStatusRequest.FromString,
+                    response_serializer=miner__pb2.GetStatusV2Response.SerializeToString,
+            ),
+            'GetMetrics': grpc.unary_unary_rpc_method_handler(
+                    servicer.GetMetrics,
+                    request_deserializer=miner__pb2.GetMetricsRequest.FromString,
+                    response_serializer=miner__pb2.GetMetricsResponse.SerializeToString,
+            ),
+            'WatchStatus': grpc.unary_stream_rpc_method_handler(
+                    servicer.WatchStatus,
+                    request_deserializer=miner__pb2.WatchStatusRequest.FromString,
+                    response_serializer=miner__pb2.GetStatusV2Response.SerializeToString,
+            ),
+            'SetThrottle': grpc.unary_unary_rpc_method_handler(
+                    servicer.SetThrottle,
+                    request_deserializer=miner__pb2.SetThrottleRequest.FromString,
+                    response_serializer=miner__pb2.SetThrottleResponse.SerializeToString,
+            ),
+            'VerifyTickets': grpc.stream_stream_rpc_method_handler(
+                    servicer.VerifyTickets,
+                    request_deserializer=miner__pb2.VerifyTicketsRequest.FromString,
+                    response_serializer=miner__pb2.VerifyTicketsResponse.SerializeToString,
+            ),
     }
     generic_handler = grpc.method_handlers_generic_handler(
             'miner.MinerService', rpc_method_handlers)
@@ -167,3 +270,105 @@ class MinerService(object):
             miner__pb2.GetStatusResponse.FromString,
             options, channel_credentials,
             insecure, call_credentials, compression, wait_for_ready, timeout, metadata)
+
+    @staticmethod
+    def StartMiningV2(request,
+            target,
+            options=(),
+            channel_credentials=None,
+            call_credentials=None,
+            insecure=False,
+            compression=None,
+            wait_for_ready=None,
+            timeout=None,
+            metadata=None):
+        return grpc.experimental.unary_unary(request, target, '/miner.MinerService/StartMiningV2',
+            miner__pb2.StartMiningV2Request.SerializeToString,
+            miner__pb2.StartMiningResponse.FromString,
+            options, channel_credentials,
+            insecure, call_credentials, compression, wait_for_ready, timeout, metadata)
+
+    @staticmethod
+    def GetStatusV2(request,
+            target,
+            options=(),
+            channel_credentials=None,
+            call_credentials=None,
+            insecure=False,
+            compression=None,
+            wait_for_ready=None,
+            timeout=None,
+            metadata=None):
+        return grpc.experimental.unary_unary(request, target, '/miner.MinerService/GetStatusV2',
+            miner__pb2.GetStatusRequest.SerializeToString,
+            miner__pb2.GetStatusV2Response.FromString,
+            options, channel_credentials,
+            insecure, call_credentials, compression, wait_for_ready, timeout, metadata)
+
+    @staticmethod
+    def GetMetrics(request,
+            target,
+            options=(),
+            channel_credentials=None,
+            call_credentials=None,
+            insecure=False,
+            compression=None,
+            wait_for_ready=None,
+            timeout=None,
+            metadata=None):
+        return grpc.experimental.unary_unary(request, target, '/miner.MinerService/GetMetrics',
+            miner__pb2.GetMetricsRequest.SerializeToString,
+            miner__pb2.GetMetricsResponse.FromString,
+            options, channel_credentials,
+            insecure, call_credentials, compression, wait_for_ready, timeout, metadata)
+
+    @staticmethod
+    def WatchStatus(request,
+            target,
+            options=(),
+            channel_credentials=None,
+            call_credentials=None,
+            insecure=False,
+            compression=None,
+            wait_for_ready=None,
+            timeout=None,
+            metadata=None):
+        return grpc.experimental.unary_stream(request, target, '/miner.MinerService/WatchStatus',
+            miner__pb2.WatchStatusRequest.SerializeToString,
+            miner__pb2.GetStatusV2Response.FromString,
+            options, channel_credentials,
+            insecure, call_credentials, compression, wait_for_ready, timeout, metadata)
+
+    @staticmethod
+    def SetThrottle(request,
+            target,
+            options=(),
+            channel_credentials=None,
+            call_credentials=None,
+            insecure=False,
+            compression=None,
+            wait_for_ready=None,
+            timeout=None,
+            metadata=None):
+        return grpc.experimental.unary_unary(request, target, '/miner.MinerService/SetThrottle',
+            miner__pb2.SetThrottleRequest.SerializeToString,
+            miner__pb2.SetThrottleResponse.FromString,
+            options, channel_credentials,
+            insecure, call_credentials, compression, wait_for_ready, timeout, metadata)
+
+    @staticmethod
+    def VerifyTickets(request_iterator,
+            target,
+            options=(),
+            channel_credentials=None,
+            call_credentials=None,
+            insecure=False,
+            compression=None,
+            wait_for_ready=None,
+            timeout=None,
+            metadata=None):
+        return grpc.experimental.stream_stream(request_iterator, target, '/miner.MinerService/VerifyTickets',
+            miner__pb2.VerifyTicketsRequest.SerializeToString,
+            miner__pb2.VerifyTicketsResponse.FromString,
+            options, channel_credentials,
+            insecure, call_credentials, compression, wait_for_ready, timeout, metadata)
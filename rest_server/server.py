@@ -1,6 +1,7 @@
 from fastapi import FastAPI, HTTPException
+from fastapi.responses import PlainTextResponse
 from fastapi.middleware.cors import CORSMiddleware
-from pydantic import BaseModel, Field, field_validator
+from pydantic import BaseModel, Field
 from typing import Optional
 import grpc
 import sys
@@ -27,24 +28,17 @@ app.add_middleware(
 
 # Pydantic models for request/response
 class StartMiningRequest(BaseModel):
-    hash: str = Field(..., min_length=64, max_length=64, pattern=r"^[0-9a-fA-F]+$")
-    addr1: str = Field(..., min_length=40, max_length=40, pattern=r"^[0-9a-fA-F]+$")
-    addr2: str = Field(..., min_length=40, max_length=40, pattern=r"^[0-9a-fA-F]+$")
-    value: int = Field(..., ge=0)
+    # Hex fields are decoded once with bytes.fromhex and sent to the v2 RPC as raw bytes
+    hash: str = Field(..., min_length=64, max_length=64)
+    addr1: str = Field(..., min_length=40, max_length=40)
+    addr2: str = Field(..., min_length=40, max_length=40)
+    value: int = Field(..., ge=0, le=0xFFFFFFFF)  # fixed32 in the v2 RPC
     timestamp: Optional[int] = None
     target: str = Field(default="000000ffffff0000000000000000000000000000000000000000000000000000", 
-                       min_length=64, max_length=64, pattern=r"^[0-9a-fA-F]+$")
+                       min_length=64, max_length=64)
     time_limit: Optional[int] = Field(default=0, ge=0)
     flag: Optional[int] = Field(default=0, ge=0, le=1)  # Flag value must be 0 or 1
-
-    @field_validator('hash', 'addr1', 'addr2', 'target')
-    @classmethod
-    def validate_hex(cls, v: str) -> str:
-        try:
-            int(v, 16)
-            return v
-        except ValueError:
-            raise ValueError("Value must be a valid hexadecimal string")
+    group_id: Optional[str] = None  # The first solution in a group cancels the other sessions in it
 
 class StartMiningResponse(BaseModel):
     session_id: str
@@ -53,7 +47,8 @@ class PauseMiningResponse(BaseModel):
     state_file: str
 
 class ResumeMiningRequest(BaseModel):
-    state_file: str
+    state_file: Optional[str] = None  # After a restart
+    session_id: Optional[str] = None  # Paused session still held by the server
 
 class ResumeMiningResponse(BaseModel):
     session_id: str
@@ -66,6 +61,9 @@ class StatusResponse(BaseModel):
     message: str = ""
     solution_found: bool = False
     solution_nonce: Optional[str] = None
+    time_to_first_hash_ms: float = 0.0
+    submit_latency: list = []  # Per-hop found-to-accepted percentiles (ms)
+    state_file: str = ""  # Paused session's state, set once it is on disk
 
 # gRPC client
 channel = grpc.insecure_channel('localhost:50051')
@@ -85,21 +83,25 @@ async def start_mining(request: StartMiningRequest):
             request.time_limit = 0
             
         # Create gRPC request
-        grpc_request = miner_pb2.StartMiningRequest(
-            hash=request.hash,
-            addr1=request.addr1,
-            addr2=request.addr2,
-            value=request.value,
-            timestamp=request.timestamp,
-            target=request.target,
-            time_limit=request.time_limit,
-            flag=request.flag  # Include flag in gRPC request
-        )
+        try:
+            grpc_request = miner_pb2.StartMiningV2Request(
+                hash=bytes.fromhex(request.hash),
+                addr1=bytes.fromhex(request.addr1),
+                addr2=bytes.fromhex(request.addr2),
+                value=request.value,
+                timestamp=request.timestamp,
+                target=bytes.fromhex(request.target),
+                time_limit=request.time_limit,
+                flag=request.flag,  # Include flag in gRPC request
+                group_id=request.group_id or ""
+            )
+        except ValueError:
+            raise HTTPException(status_code=400, detail="Value must be a valid hexadecimal string")
         
         # Call gRPC service
         try:
-            logger.info("Calling gRPC StartMining service")
-            response = stub.StartMining(grpc_request)
+            logger.info("Calling gRPC StartMiningV2 service")
+            response = stub.StartMiningV2(grpc_request)
             if not response.success:
                 error_msg = response.message or "Failed to start mining"
                 logger.error(f"Mining service error: {error_msg}")
@@ -141,8 +143,11 @@ async def pause_mining(session_id: str):
 @app.post("/mine/resume", response_model=ResumeMiningResponse)
 async def resume_mining(request: ResumeMiningRequest):
     try:
-        logger.info(f"Received resume request for state file: {request.state_file}")
-        grpc_request = miner_pb2.ResumeMiningRequest(state_file=request.state_file)
+        if not request.session_id and not request.state_file:
+            raise HTTPException(status_code=422, detail="Field 'session_id' or 'state_file' is required")
+        logger.info(f"Received resume request for {request.session_id or request.state_file}")
+        grpc_request = miner_pb2.ResumeMiningRequest(session_id=request.session_id or "",
+                                                     state_file=request.state_file or "")
         response = stub.ResumeMining(grpc_request)
         logger.info(f"Resume successful with session ID: {response.session_id}")
         return {"session_id": response.session_id}
@@ -158,21 +163,31 @@ async def get_status(session_id: str):
     try:
         logger.info(f"Received status request for session ID: {session_id}")
         request = miner_pb2.GetStatusRequest(session_id=session_id)
-        response = stub.GetStatus(request)
+        response = stub.GetStatusV2(request)
         
-        # Check if a solution was found
-        solution_found = "Solution found" in response.message
-        solution_nonce = response.current_nonce if solution_found else None
+        current_nonce = str(response.current_nonce)
+        solution_found = response.solution_found
+        solution_nonce = current_nonce if solution_found else None
+        message = f"Mining complete. Found nonce: 0x{response.current_nonce:x}" if solution_found else ""
+        if not solution_found and response.cancelled_by:
+            message = f"Cancelled: session {response.cancelled_by} of the group found a solution"
         
-        logger.info(f"Status for session ID: {session_id} - is_mining: {response.is_mining}, current_nonce: {response.current_nonce}, total_hashes: {response.total_hashes}, hash_rate: {response.hash_rate}, message: {response.message}")
+        logger.info(f"Status for session ID: {session_id} - is_mining: {response.is_mining}, current_nonce: {current_nonce}, total_hashes: {response.total_hashes}, hash_rate: {response.hash_rate}, solution_found: {solution_found}")
         return {
             "is_mining": response.is_mining,
-            "current_nonce": response.current_nonce,
+            "current_nonce": current_nonce,
             "total_hashes": response.total_hashes,
             "hash_rate": response.hash_rate,
-            "message": response.message,
+            "message": message,
             "solution_found": solution_found,
-            "solution_nonce": solution_nonce
+            "solution_nonce": solution_nonce,
+            "time_to_first_hash_ms": response.time_to_first_hash_ms,
+            "submit_latency": [
+                {"hop": s.hop, "count": s.count, "p50_ms": s.p50_ms, "p99_ms": s.p99_ms,
+                 "p999_ms": s.p999_ms, "max_ms": s.max_ms}
+                for s in response.submit_latency
+            ],
+            "state_file": response.state_file
         }
     except grpc.RpcError as e:
         if "not found" in str(e.details()).lower():
@@ -181,6 +196,16 @@ async def get_status(session_id: str):
         logger.error(f"gRPC error: {e.details()}")
         raise HTTPException(status_code=500, detail=f"gRPC error: {e.details()}")
 
+@app.get("/metrics", response_class=PlainTextResponse)
+async def get_metrics():
+    # Prometheus scrape endpoint, rendered by the miner's metrics registry
+    try:
+        response = stub.GetMetrics(miner_pb2.GetMetricsRequest())
+        return PlainTextResponse(response.text, media_type="text/plain; version=0.0.4")
+    except grpc.RpcError as e:
+        logger.error(f"gRPC error: {e.details()}")
+        raise HTTPException(status_code=500, detail=f"gRPC error: {e.details()}")
+
 if __name__ == "__main__":
     import uvicorn
     uvicorn.run(app, host="0.0.0.0", port=8001)
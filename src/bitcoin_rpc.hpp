@@ -2,10 +2,15 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
-#include <iostream>
-#include <iomanip>
+#include <chrono>
+#include <stdexcept>
+#include "log.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+#include "submit_latency.hpp"
 
 class BitcoinRPC {
 public:
@@ -13,7 +18,7 @@ public:
         : url_(host + ":" + std::to_string(port))
         , auth_(user + ":" + pass)
         , curl_(nullptr) {
-        std::cout << "Initializing Bitcoin RPC client for " << url_ << std::endl;
+        LOG_INFO("Initializing Bitcoin RPC client for {}", url_);
         curl_ = curl_easy_init();
         if (!curl_) {
             throw std::runtime_error("Failed to initialize CURL");
@@ -26,9 +31,9 @@ public:
         }
     }
 
-    bool broadcastSupportTicket(const std::string& hexData) {
-        std::cout << "\nCalling broadcastsupportticket RPC method" << std::endl;
-        std::cout << "Hex data to broadcast: " << hexData << std::endl;
+    // timeline (optional) receives the sent and responded times
+    bool broadcastSupportTicket(const std::string& hexData, SubmitTimeline* timeline = nullptr) {
+        TraceSpan span("broadcastSupportTicket", "rpc");
         
         nlohmann::json request;
         request["jsonrpc"] = "1.0";
@@ -36,38 +41,43 @@ public:
         request["method"] = "broadcastsupportticket";
         request["params"] = nlohmann::json::array({hexData});
 
-        std::string requestStr = request.dump(2);
-        std::cout << "Request JSON:\n" << requestStr << std::endl;
-
-        std::string response = makeRequest(requestStr);
-        std::cout << "Response from Bitcoin RPC:\n" << response << std::endl;
+        // Nothing is logged until the node has answered, the ticket goes out first
+        std::string requestStr = request.dump();
+        std::string response = timedRequest("broadcastsupportticket", requestStr, timeline);
+        LOG_DEBUG("broadcastsupportticket {} -> {}", hexData, response);
         
         try {
             auto json = nlohmann::json::parse(response);
             bool success = json["error"].is_null();
-            std::cout << "RPC call " << (success ? "succeeded" : "failed") << std::endl;
+            if (!success) {
+                countError("broadcastsupportticket");
+            }
+            if (success) {
+                LOG_INFO("broadcastsupportticket succeeded");
+            } else {
+                LOG_WARNING("broadcastsupportticket failed: {}", response);
+            }
             return success;
         } catch (const std::exception& e) {
-            std::cerr << "Failed to parse RPC response: " << e.what() << std::endl;
+            LOG_ERROR("Failed to parse RPC response: {}", e.what());
             return false;
         }
     }
     
     std::pair<std::string, uint32_t> getSupportableLeader() {
-        std::cout << "\nCalling getsupportableleader RPC method" << std::endl;
-        
+        TraceSpan span("getSupportableLeader", "rpc");
         nlohmann::json request;
         request["jsonrpc"] = "1.0";
         request["id"] = "curltest";
         request["method"] = "getsupportableleader";
         request["params"] = nlohmann::json::array();
 
-        std::string requestStr = request.dump(2);
-        std::cout << "Request JSON:\n" << requestStr << std::endl;
+        std::string requestStr = request.dump();
+        LOG_DEBUG("getsupportableleader request {}", requestStr);
 
         try {
-            std::string response = makeRequest(requestStr);
-            std::cout << "Response from Bitcoin RPC:\n" << response << std::endl;
+            std::string response = timedRequest("getsupportableleader", requestStr);
+            LOG_DEBUG("getsupportableleader response {}", response);
             
             auto json = nlohmann::json::parse(response);
             
@@ -75,8 +85,7 @@ public:
                 std::string leader = json["result"]["leader"].get<std::string>();
                 uint32_t height = json["result"]["height"].get<uint32_t>();
                 
-                std::cout << "Retrieved leader: " << leader << std::endl;
-                std::cout << "Retrieved height: " << height << std::endl;
+                LOG_INFO("Retrieved leader {} at height {}", leader, height);
                 
                 return { leader, height };
             } else {
@@ -84,11 +93,12 @@ public:
                 if (!json["error"].is_null()) {
                     errorMsg = json["error"]["message"].get<std::string>();
                 }
-                std::cerr << "RPC call failed: " << errorMsg << std::endl;
+                LOG_ERROR("getsupportableleader failed: {}", errorMsg);
+                countError("getsupportableleader");
                 return { "", 0 };
             }
         } catch (const std::exception& e) {
-            std::cerr << "Failed to execute RPC call: " << e.what() << std::endl;
+            LOG_ERROR("Failed to execute getsupportableleader: {}", e.what());
             return { "", 0 };
         }
     }
@@ -99,11 +109,41 @@ private:
         return size * nmemb;
     }
 
+    // makeRequest plus node round-trip latency; transport failures count as errors.
+    // Calls from different threads take turns on the one curl handle.
+    std::string timedRequest(const std::string& method, const std::string& data,
+                             SubmitTimeline* timeline = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto start = std::chrono::steady_clock::now();
+        try {
+            std::string response = makeRequest(data);
+            auto end = std::chrono::steady_clock::now();
+            if (timeline) {
+                // curl reports when the connection was ready and the request started going out
+                curl_off_t pretransfer_us = 0;
+                curl_easy_getinfo(curl_, CURLINFO_PRETRANSFER_TIME_T, &pretransfer_us);
+                timeline->sent = start + std::chrono::microseconds(pretransfer_us);
+                timeline->responded = end;
+            }
+            std::chrono::duration<double> elapsed = end - start;
+            miner_metrics().histogram("miner_node_rpc_seconds", "Node RPC round-trip time",
+                                      metric_label("method", method),
+                                      Histogram::exponential_bounds(0.001, 2, 14)).observe(elapsed.count());
+            return response;
+        } catch (...) {
+            countError(method);
+            throw;
+        }
+    }
+
+    void countError(const std::string& method) {
+        miner_metrics().counter("miner_node_rpc_errors_total", "Node RPC calls that failed",
+                                metric_label("method", method)).add();
+    }
+
     std::string makeRequest(const std::string& data) {
         std::string response;
         
-        std::cout << "Making HTTP request to " << url_ << std::endl;
-        
         curl_easy_setopt(curl_, CURLOPT_URL, url_.c_str());
         curl_easy_setopt(curl_, CURLOPT_USERPWD, auth_.c_str());
         curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, data.c_str());
@@ -121,7 +161,6 @@ private:
         if (res != CURLE_OK) {
             std::string error = "CURL error: ";
             error += curl_easy_strerror(res);
-            std::cerr << error << std::endl;
             throw std::runtime_error(error);
         }
         
@@ -130,5 +169,6 @@ private:
 
     std::string url_;
     std::string auth_;
+    std::mutex mutex_;  // Guards curl_
     CURL* curl_;
 };
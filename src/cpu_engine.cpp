@@ -0,0 +1,144 @@
+#include "cpu_engine.hpp"
+#include "sha256_host.hpp"
+#include <cstring>
+
+CpuEngine::CpuEngine(int threads, uint32_t batch_size, int slots)
+    : batch_size_(batch_size)
+    , slots_(slots > 0 ? slots : 1)
+    , shutdown_(false) {
+    memset(midstate_, 0, sizeof(midstate_));
+    memset(tail_, 0, sizeof(tail_));
+    memset(target_, 0, sizeof(target_));
+    for (Slot& slot : slots_) {
+        slot.pending = 0;
+        slot.busy = false;
+    }
+
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) {
+            threads = 1;
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        workers_.emplace_back(&CpuEngine::worker_loop, this);
+    }
+}
+
+CpuEngine::~CpuEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    work_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+bool CpuEngine::set_job(const TicketJobConstants& job, const Target& target) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Slot& slot : slots_) {
+        if (slot.busy) {
+            return false;
+        }
+    }
+    ticket_midstate(job, midstate_);
+    memcpy(tail_, job.words + TicketLayout::kTailWord, sizeof(tail_));
+    memcpy(target_, target.words, sizeof(target_));
+    return true;
+}
+
+bool CpuEngine::launch(int slot_index, uint32_t base_nonce) {
+    if (slot_index < 0 || slot_index >= (int)slots_.size()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& slot = slots_[slot_index];
+    if (slot.busy) {
+        return false;
+    }
+
+    slot.busy = true;
+    slot.result.base_nonce = base_nonce;
+    slot.result.count = batch_size_;
+    slot.result.found = false;
+
+    // One chunk per worker so a batch spreads over the whole pool
+    uint32_t chunks = (uint32_t)workers_.size();
+    uint32_t per_chunk = (batch_size_ + chunks - 1) / chunks;
+    slot.pending = 0;
+    for (uint32_t offset = 0; offset < batch_size_; offset += per_chunk) {
+        uint32_t count = (batch_size_ - offset < per_chunk) ? batch_size_ - offset : per_chunk;
+        queue_.push_back(Chunk{slot_index, base_nonce + offset, count});
+        slot.pending++;
+    }
+    work_cv_.notify_all();
+    return true;
+}
+
+bool CpuEngine::collect(int slot_index, BatchResult* result) {
+    if (slot_index < 0 || slot_index >= (int)slots_.size()) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    Slot& slot = slots_[slot_index];
+    if (!slot.busy) {
+        return false;
+    }
+    done_cv_.wait(lock, [&slot]() { return slot.pending == 0; });
+    *result = slot.result;
+    slot.busy = false;
+    return true;
+}
+
+void CpuEngine::worker_loop() {
+    for (;;) {
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this]() { return shutdown_ || !queue_.empty(); });
+            if (shutdown_) {
+                return;
+            }
+            chunk = queue_.front();
+            queue_.pop_front();
+        }
+        hash_chunk(chunk);
+    }
+}
+
+void CpuEngine::hash_chunk(const Chunk& chunk) {
+    bool found = false;
+    uint32_t winning_nonce = 0;
+    uint32_t hash[8];
+    uint32_t winning_hash[8];
+    std::chrono::steady_clock::time_point found_at;
+
+    for (uint32_t i = 0; i < chunk.count && !found; i++) {
+        uint32_t nonce = chunk.begin + i;
+        ticket_hash_from_midstate(midstate_, tail_, nonce, hash);
+        if (hash_meets_target(hash, target_)) {
+            found = true;
+            found_at = std::chrono::steady_clock::now();
+            winning_nonce = nonce;
+            memcpy(winning_hash, hash, sizeof(hash));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Slot& slot = slots_[chunk.slot];
+    // Keep the lowest winning nonce so results are deterministic
+    if (found && (!slot.result.found || winning_nonce - slot.result.base_nonce <
+                                        slot.result.nonce - slot.result.base_nonce)) {
+        slot.result.found = true;
+        slot.result.nonce = winning_nonce;
+        slot.result.found_at = found_at;
+        memcpy(slot.result.hash, winning_hash, sizeof(winning_hash));
+    }
+    if (--slot.pending == 0) {
+        done_cv_.notify_all();
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "mining_engine.hpp"
+
+// CPU implementation of MiningEngine. Uses the same job constants and
+// midstate as the CUDA kernel, so it doubles as a stand-in engine for
+// exercising the pipeline on machines without a GPU.
+class CpuEngine : public MiningEngine {
+public:
+    // threads = 0 uses every hardware thread
+    explicit CpuEngine(int threads = 0, uint32_t batch_size = 1u << 16, int slots = 2);
+    ~CpuEngine() override;
+
+    const char* name() const override { return "cpu"; }
+    uint32_t batch_size() const override { return batch_size_; }
+    int slots() const override { return (int)slots_.size(); }
+
+    bool set_job(const TicketJobConstants& job, const Target& target) override;
+    bool launch(int slot, uint32_t base_nonce) override;
+    bool collect(int slot, BatchResult* result) override;
+
+private:
+    struct Slot {
+        int pending;          // Chunks still being hashed
+        bool busy;            // Launched and not yet collected
+        BatchResult result;
+    };
+
+    struct Chunk {
+        int slot;
+        uint32_t begin;
+        uint32_t count;
+    };
+
+    void worker_loop();
+    void hash_chunk(const Chunk& chunk);
+
+    uint32_t batch_size_;
+    uint32_t midstate_[8];
+    uint32_t tail_[16];
+    uint32_t target_[8];
+
+    std::vector<Slot> slots_;
+    std::deque<Chunk> queue_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool shutdown_;
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cuda_runtime.h>
+#include <cstdint>
+#include "mining_engine.hpp"
+
+struct DeviceJob;
+struct DeviceResult;
+
+// CUDA implementation of MiningEngine. Device buffers, streams and events
+// are created once; job constants are uploaded once per job and each slot
+// reports its result through pinned, device-mapped host memory so no copy
+// or memset is issued between launches.
+class CudaEngine : public MiningEngine {
+public:
+    static const int kThreadsPerBlock = 256;
+    static const int kSlots = 2;
+
+    explicit CudaEngine(int device = 0, int blocks = 8192);
+    ~CudaEngine() override;
+
+    // False if any device resource failed to initialize
+    bool ok() const { return ok_; }
+
+    const char* name() const override { return "cuda"; }
+    uint32_t batch_size() const override { return (uint32_t)blocks_ * kThreadsPerBlock; }
+    int slots() const override { return kSlots; }
+
+    bool set_job(const TicketJobConstants& job, const Target& target) override;
+    bool launch(int slot, uint32_t base_nonce) override;
+    bool collect(int slot, BatchResult* result) override;
+
+private:
+    int device_;
+    int blocks_;
+    bool ok_;
+
+    DeviceJob* d_job_;                  // Midstate, tail block and target
+    DeviceResult* h_results_;           // Pinned + mapped, one entry per slot
+    DeviceResult* d_results_;           // Device view of h_results_
+    cudaStream_t streams_[kSlots];
+    cudaEvent_t done_[kSlots];
+    uint32_t base_nonce_[kSlots];
+    bool busy_[kSlots];
+};
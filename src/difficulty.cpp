@@ -0,0 +1,47 @@
+#include "difficulty.hpp"
+#include <cmath>
+
+double target_value(const Target& target) {
+    double value = 0;
+    for (int i = 0; i < 8; i++) {
+        value = value * 4294967296.0 + target.words[i];
+    }
+    return value;
+}
+
+double expected_hashes(const Target& target) {
+    // 2^256 fits a double; the + 1 only matters for tiny targets
+    return std::ldexp(1.0, 256) / (target_value(target) + 1.0);
+}
+
+double target_difficulty(const Target& target) {
+    static const double kDifficultyOne = std::ldexp(65535.0, 208);  // 0x00000000ffff0000...
+    double value = target_value(target);
+    return value > 0 ? kDifficultyOne / value : INFINITY;
+}
+
+double success_probability(double hashes, const Target& target) {
+    // 1 - (1 - p)^n, via log1p/expm1 so tiny p keeps its precision
+    if (hashes <= 0) {
+        return 0.0;
+    }
+    return -std::expm1(hashes * std::log1p(-1.0 / expected_hashes(target)));
+}
+
+double expected_seconds(const Target& target, double hash_rate) {
+    return hash_rate > 0 ? expected_hashes(target) / hash_rate : 0.0;
+}
+
+double seconds_for_probability(const Target& target, double hash_rate, double probability) {
+    if (hash_rate <= 0 || probability <= 0) {
+        return 0.0;
+    }
+    if (probability >= 1) {
+        return INFINITY;
+    }
+    double per_hash = std::log1p(-1.0 / expected_hashes(target));
+    if (per_hash == -INFINITY) {
+        return 0.0;  // Every hash meets the target
+    }
+    return std::log1p(-probability) / per_hash / hash_rate;
+}
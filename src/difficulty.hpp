@@ -0,0 +1,26 @@
+#pragma once
+#include "miner.cuh"
+
+// Work estimates for a 256-bit target (big-endian words, as compared by the
+// miner). Each hash meets the target independently with probability
+// (target + 1) / 2^256, so solutions arrive as a Poisson process: the
+// expected work per solution is the inverse of that, and it stays the same
+// however long a job has already run.
+
+// Target as a floating-point value (exact up to double precision)
+double target_value(const Target& target);
+
+// Expected hashes per solution, 2^256 / (target + 1)
+double expected_hashes(const Target& target);
+
+// Relative to the Bitcoin difficulty-1 target (compact 0x1d00ffff)
+double target_difficulty(const Target& target);
+
+// Chance that a solution has been found after hashes attempts
+double success_probability(double hashes, const Target& target);
+
+// Expected seconds per solution at hash_rate (H/s), 0 if the rate is unknown
+double expected_seconds(const Target& target, double hash_rate);
+
+// Seconds of mining needed to find a solution with the given probability
+double seconds_for_probability(const Target& target, double hash_rate, double probability);
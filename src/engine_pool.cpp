@@ -0,0 +1,177 @@
+#include "engine_pool.hpp"
+#include "log.hpp"
+#include <chrono>
+#include <cstring>
+
+EngineLease::EngineLease(EngineLease&& other) noexcept
+    : pool_(other.pool_)
+    , engine_(other.engine_) {
+    other.pool_ = nullptr;
+    other.engine_ = nullptr;
+}
+
+EngineLease& EngineLease::operator=(EngineLease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        engine_ = other.engine_;
+        other.pool_ = nullptr;
+        other.engine_ = nullptr;
+    }
+    return *this;
+}
+
+EngineLease::~EngineLease() {
+    release();
+}
+
+void EngineLease::release() {
+    if (pool_ && engine_) {
+        pool_->release(engine_);
+    }
+    pool_ = nullptr;
+    engine_ = nullptr;
+}
+
+EnginePool::EnginePool()
+    : next_arrival_(0)
+    , available_metric_(miner_metrics().gauge("miner_engines_available", "Pooled engines not leased"))
+    , waiters_metric_(miner_metrics().gauge("miner_engine_waiters", "Sessions waiting for an engine"))
+    , first_hash_metric_(miner_metrics().histogram("miner_time_to_first_hash_seconds",
+          "Session start to first completed batch", "", Histogram::exponential_bounds(0.001, 2, 14))) {
+    memset(&first_hash_, 0, sizeof(first_hash_));
+}
+
+// Leases must not outlive the pool
+EnginePool::~EnginePool() {}
+
+bool EnginePool::warm_up(MiningEngine& engine) {
+    // All-zero target: the batch runs the real kernel path but never reports a winner
+    TicketJobConstants job;
+    memset(&job, 0, sizeof(job));
+    Target target;
+    memset(&target, 0, sizeof(target));
+
+    if (!engine.set_job(job, target) || !engine.launch(0, 0)) {
+        return false;
+    }
+    BatchResult result;
+    return engine.collect(0, &result);
+}
+
+size_t EnginePool::add_engines(const EngineFactory& factory, size_t count) {
+    size_t added = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<MiningEngine> engine = factory();
+        if (!engine || !warm_up(*engine)) {
+            LOG_ERROR("Engine {} failed to warm up, not added to pool", i);
+            continue;
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        LOG_INFO("Engine {} #{} warmed up in {:.1f} ms", engine->name(), i, elapsed.count());
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(engine.get());
+        engines_.push_back(std::move(engine));
+        available_metric_.add(1);
+        added++;
+    }
+    if (added) {
+        available_cv_.notify_all();
+    }
+    return added;
+}
+
+EngineLease EnginePool::acquire(float timeout_seconds, double priority, const std::function<bool()>& cancelled) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (free_.empty() || !waiters_.empty()) {
+        if (timeout_seconds <= 0) {
+            return EngineLease();
+        }
+        // Queue up; an engine goes to the front waiter only, so a late
+        // arrival can't take it from a waiter that ranks higher
+        const std::pair<double, uint64_t> ticket(-priority, next_arrival_++);
+        waiters_.insert(ticket);
+        waiters_metric_.add(1);
+        bool got = available_cv_.wait_for(lock, std::chrono::duration<float>(timeout_seconds),
+            [this, &ticket, &cancelled] {
+                return (cancelled && cancelled()) || (!free_.empty() && *waiters_.begin() == ticket);
+            });
+        waiters_.erase(ticket);
+        waiters_metric_.add(-1);
+        // The next waiter in line may be able to go now (or be first at last)
+        available_cv_.notify_all();
+        if (!got || (cancelled && cancelled())) {
+            return EngineLease();
+        }
+    }
+    MiningEngine* engine = free_.back();
+    free_.pop_back();
+    available_metric_.add(-1);
+    return EngineLease(this, engine);
+}
+
+void EnginePool::release(MiningEngine* engine) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(engine);
+        available_metric_.add(1);
+    }
+    // Every waiter checks whether it is first in line
+    available_cv_.notify_all();
+}
+
+void EnginePool::wake_waiters() {
+    // Taken so a waiter can't miss the wake between its check and its wait
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    available_cv_.notify_all();
+}
+
+size_t EnginePool::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return engines_.size();
+}
+
+size_t EnginePool::available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_.size();
+}
+
+size_t EnginePool::waiting() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return waiters_.size();
+}
+
+int EnginePool::index_of(const MiningEngine* engine) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < engines_.size(); i++) {
+        if (engines_[i].get() == engine) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+const char* EnginePool::engine_name(size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index < engines_.size() ? engines_[index]->name() : "";
+}
+
+void EnginePool::record_first_hash(double ms) {
+    first_hash_metric_.observe(ms / 1000.0);
+    std::lock_guard<std::mutex> lock(first_hash_mutex_);
+    first_hash_.count++;
+    first_hash_.last_ms = ms;
+    first_hash_.avg_ms += (ms - first_hash_.avg_ms) / first_hash_.count;
+    if (ms > first_hash_.max_ms) {
+        first_hash_.max_ms = ms;
+    }
+}
+
+FirstHashStats EnginePool::first_hash_stats() const {
+    std::lock_guard<std::mutex> lock(first_hash_mutex_);
+    return first_hash_;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+#include "mining_engine.hpp"
+#include "metrics.hpp"
+
+class EnginePool;
+
+typedef std::function<std::unique_ptr<MiningEngine>()> EngineFactory;
+
+// Exclusive use of a pooled engine; the engine goes back to the pool when
+// the lease is destroyed. An empty lease means no engine was available.
+class EngineLease {
+public:
+    EngineLease() : pool_(nullptr), engine_(nullptr) {}
+    EngineLease(EngineLease&& other) noexcept;
+    EngineLease& operator=(EngineLease&& other) noexcept;
+    EngineLease(const EngineLease&) = delete;
+    EngineLease& operator=(const EngineLease&) = delete;
+    ~EngineLease();
+
+    MiningEngine* get() const { return engine_; }
+    MiningEngine* operator->() const { return engine_; }
+    MiningEngine& operator*() const { return *engine_; }
+    explicit operator bool() const { return engine_ != nullptr; }
+
+    // Return the engine to the pool early
+    void release();
+
+private:
+    friend class EnginePool;
+    EngineLease(EnginePool* pool, MiningEngine* engine) : pool_(pool), engine_(engine) {}
+
+    EnginePool* pool_;
+    MiningEngine* engine_;
+};
+
+// Time from session start to the first completed batch
+struct FirstHashStats {
+    uint64_t count;
+    double last_ms;
+    double avg_ms;
+    double max_ms;
+};
+
+// Engines created and warmed once (device context, buffers, streams, worker
+// threads), then leased to sessions so starting a job costs no setup.
+class EnginePool {
+public:
+    EnginePool();
+    ~EnginePool();
+
+    // Create and warm up to count engines, returns how many joined the pool.
+    // Engines that fail to initialize or warm up are dropped.
+    size_t add_engines(const EngineFactory& factory, size_t count);
+
+    // Wait up to timeout_seconds for a free engine (0 = don't wait). Waiters
+    // are served highest priority first, in arrival order among equals. A
+    // waiter whose cancelled predicate turns true leaves with an empty lease
+    // at the next wake_waiters().
+    EngineLease acquire(float timeout_seconds, double priority = 0,
+                        const std::function<bool()>& cancelled = std::function<bool()>());
+
+    // Has every waiter re-check its cancelled predicate
+    void wake_waiters();
+
+    size_t size() const;
+    size_t available() const;
+    size_t waiting() const;  // Callers blocked in acquire
+
+    // Position of an engine in creation order (stable for the pool's lifetime), -1 if unknown
+    int index_of(const MiningEngine* engine) const;
+    const char* engine_name(size_t index) const;
+
+    void record_first_hash(double ms);
+    FirstHashStats first_hash_stats() const;
+
+    // Run one throwaway batch so lazy runtime setup happens before any session
+    static bool warm_up(MiningEngine& engine);
+
+private:
+    friend class EngineLease;
+    void release(MiningEngine* engine);
+
+    std::vector<std::unique_ptr<MiningEngine>> engines_;
+    std::vector<MiningEngine*> free_;
+    std::set<std::pair<double, uint64_t>> waiters_;  // (-priority, arrival), front is next
+    uint64_t next_arrival_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_cv_;
+    Gauge& available_metric_;
+    Gauge& waiters_metric_;
+    Histogram& first_hash_metric_;
+
+    FirstHashStats first_hash_;
+    mutable std::mutex first_hash_mutex_;
+};
@@ -0,0 +1,250 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "hdr_histogram.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+static void close_socket(socket_t socket) { closesocket(socket); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+static void close_socket(socket_t socket) { ::close(socket); }
+#endif
+
+// REST gateway load test: keep-alive connections issuing back-to-back
+// requests against either the miner's native gateway (--http) or
+// rest_server/server.py, with per-request latency in an HDR histogram.
+//
+//     gateway_bench --port 8080 --connections 8 --seconds 10   # native
+//     gateway_bench --port 8001 --connections 8 --seconds 10   # Python
+
+static const char* const kJobBody =
+    "{\"hash\":\"0000000000000000000000000000000000000000000000000000000000000000\","
+    "\"addr1\":\"0000000000000000000000000000000000000000\","
+    "\"addr2\":\"0000000000000000000000000000000000000000\","
+    "\"value\":1,\"time_limit\":1,"
+    "\"target\":\"0000000000000000000000000000000000000000000000000000000000000000\"}";
+
+void PrintUsage() {
+    std::cout << "REST gateway load test\n";
+    std::cout << "Usage: gateway_bench [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help            Show this help message\n";
+    std::cout << "  --host <ip>           Gateway address (default: 127.0.0.1)\n";
+    std::cout << "  --port <port>         Gateway port (default: 8080)\n";
+    std::cout << "  --connections <n>     Concurrent keep-alive connections (default: 8)\n";
+    std::cout << "  --seconds <n>         Test duration (default: 10)\n";
+    std::cout << "  --endpoint <name>     status (GET /mine/{id}/status) or start (POST /mine/start)\n";
+    std::cout << "  --session <id>        Session to poll for status (default: start one)\n";
+}
+
+// One keep-alive HTTP/1.1 connection
+class Connection {
+public:
+    Connection() : socket_((socket_t)-1) {}
+    ~Connection() { close(); }
+
+    bool connect(const std::string& host, uint16_t port) {
+        close();
+        socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1 ||
+            ::connect(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close();
+            return false;
+        }
+        int nodelay = 1;
+        setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay), sizeof(nodelay));
+        buffer_.clear();
+        return true;
+    }
+
+    void close() {
+        if (socket_ != (socket_t)-1) {
+            close_socket(socket_);
+            socket_ = (socket_t)-1;
+        }
+    }
+
+    // Status code, or -1 when the connection failed
+    int request(const std::string& method, const std::string& path, const std::string& body, std::string* out) {
+        std::string request = method + " " + path + " HTTP/1.1\r\nHost: bench\r\n";
+        if (!body.empty()) {
+            request += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        request += "\r\n" + body;
+        for (size_t sent = 0; sent < request.size();) {
+            int n = send(socket_, request.data() + sent, (int)(request.size() - sent), 0);
+            if (n <= 0) {
+                return -1;
+            }
+            sent += (size_t)n;
+        }
+
+        size_t header_end;
+        while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) {
+                return -1;
+            }
+        }
+        int status = atoi(buffer_.c_str() + buffer_.find(' ') + 1);
+        size_t length = 0;
+        std::string headers = buffer_.substr(0, header_end);
+        for (char& c : headers) {
+            c = (char)tolower((unsigned char)c);
+        }
+        size_t field = headers.find("content-length:");
+        if (field != std::string::npos) {
+            length = (size_t)strtoull(headers.c_str() + field + 15, nullptr, 10);
+        }
+        while (buffer_.size() < header_end + 4 + length) {
+            if (!fill()) {
+                return -1;
+            }
+        }
+        if (out) {
+            *out = buffer_.substr(header_end + 4, length);
+        }
+        buffer_.erase(0, header_end + 4 + length);
+        return status;
+    }
+
+private:
+    bool fill() {
+        char chunk[8192];
+        int n = recv(socket_, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer_.append(chunk, (size_t)n);
+        return true;
+    }
+
+    socket_t socket_;
+    std::string buffer_;
+};
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string host = "127.0.0.1";
+    uint16_t port = 8080;
+    int connections = 8;
+    int seconds = 10;
+    std::string endpoint = "status";
+    std::string session_id;
+
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "-h" || args[i] == "--help") {
+            PrintUsage();
+            return 0;
+        }
+        else if (args[i] == "--host" && i + 1 < args.size()) {
+            host = args[++i];
+        }
+        else if (args[i] == "--port" && i + 1 < args.size()) {
+            port = (uint16_t)std::stoi(args[++i]);
+        }
+        else if (args[i] == "--connections" && i + 1 < args.size()) {
+            connections = std::stoi(args[++i]);
+        }
+        else if (args[i] == "--seconds" && i + 1 < args.size()) {
+            seconds = std::stoi(args[++i]);
+        }
+        else if (args[i] == "--endpoint" && i + 1 < args.size()) {
+            endpoint = args[++i];
+        }
+        else if (args[i] == "--session" && i + 1 < args.size()) {
+            session_id = args[++i];
+        }
+    }
+    if (endpoint != "status" && endpoint != "start") {
+        PrintUsage();
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+    if (endpoint == "status" && session_id.empty()) {
+        // An unsolvable one-second job, so status is polled on a real session
+        Connection setup;
+        std::string body;
+        if (!setup.connect(host, port) || setup.request("POST", "/mine/start", kJobBody, &body) != 200) {
+            std::cerr << "Failed to start a session on " << host << ":" << port << ": " << body << std::endl;
+            return 1;
+        }
+        size_t key = body.find("\"session_id\"");
+        size_t open = body.find('"', body.find(':', key) + 1);
+        session_id = body.substr(open + 1, body.find('"', open + 1) - open - 1);
+    }
+    const std::string path = endpoint == "status" ? "/mine/" + session_id + "/status" : "/mine/start";
+    const std::string method = endpoint == "status" ? "GET" : "POST";
+    const std::string body = endpoint == "status" ? "" : kJobBody;
+
+    HdrHistogram latency;
+    std::atomic<uint64_t> errors(0);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> clients;
+    for (int c = 0; c < connections; c++) {
+        clients.emplace_back([&] {
+            Connection connection;
+            bool connected = false;
+            while (std::chrono::steady_clock::now() < deadline) {
+                if (!connected && !(connected = connection.connect(host, port))) {
+                    errors++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+                auto sent = std::chrono::steady_clock::now();
+                int status = connection.request(method, path, body, nullptr);
+                auto received = std::chrono::steady_clock::now();
+                if (status < 0) {
+                    connected = false;
+                    errors++;
+                    continue;
+                }
+                if (status != 200) {
+                    errors++;
+                }
+                latency.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(received - sent).count());
+            }
+        });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "\n" << method << " " << path << " on " << host << ":" << port << ", " << connections
+              << " connection(s), " << std::fixed << std::setprecision(1) << elapsed.count() << " s\n\n";
+    std::cout << std::setprecision(3);
+    std::cout << "requests  " << latency.count() << " (" << errors.load() << " errors)\n";
+    std::cout << "req/s     " << std::setprecision(0) << latency.count() / elapsed.count() << "\n";
+    std::cout << std::setprecision(3);
+    std::cout << "p50 ms    " << latency.percentile(50) / 1e6 << "\n";
+    std::cout << "p99 ms    " << latency.percentile(99) / 1e6 << "\n";
+    std::cout << "p999 ms   " << latency.percentile(99.9) / 1e6 << "\n";
+    std::cout << "max ms    " << latency.max() / 1e6 << std::endl;
+    return 0;
+}
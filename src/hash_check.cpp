@@ -0,0 +1,330 @@
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include "miner.cuh"
+#include "cuda_engine.hpp"
+#include "cpu_engine.hpp"
+#include "sha256_host.hpp"
+#include "support_ticket.hpp"
+#include "ticket_verifier.hpp"
+
+// Differential check of every hashing path against the OpenSSL reference
+// (TicketVerifier::ticket_hash, built on HashWriter): the host midstate path
+// and each engine variant must produce byte-identical hashes and the same
+// target decisions. Runs without a GPU; the CUDA engine is skipped when no
+// device is found. Exits non-zero on any mismatch.
+
+void PrintUsage() {
+    std::cout << "Hashing path differential check\n";
+    std::cout << "Usage: hash_check [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help            Show this help message\n";
+    std::cout << "  --rounds <n>          Random jobs per engine (default: 50)\n";
+    std::cout << "  --seed <n>            Seed for the random jobs (default: random, printed)\n";
+    std::cout << "  --no-cuda             Skip the CUDA engine\n";
+}
+
+// Known tickets: header fields, target, the nonce the search started at, the
+// first nonce from there that meets the target and its hash (display order).
+// Hashes were computed independently of this code base (Python hashlib).
+struct CorpusTicket {
+    const char* hash;
+    const char* address1;
+    uint32_t value;
+    const char* address2;
+    uint8_t flag;
+    uint32_t timestamp;
+    const char* target;
+    uint32_t start_nonce;
+    uint32_t nonce;
+    const char* expected;
+};
+
+static const CorpusTicket kCorpus[] = {
+    {"073ff90209cde3a9ce4ccd23598fd1b50e6a1fe34f30bd7240587f0bde6f65af",
+     "00e72f85c49171825a87a84142bdf02022a75479", 3768u,
+     "2ecaa57da5fcc9d45bc2d512eeb2b3e98e0393b7", 0, 1737835291u,
+     "0000ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     0x0000332cu, 0x0000b11bu,
+     "000044051fc61163e858a62727111bb0427cac081cd1cc7ea3ff558030f05561"},
+    {"073ff90209cde3a9ce4ccd23598fd1b50e6a1fe34f30bd7240587f0bde6f65af",
+     "00e72f85c49171825a87a84142bdf02022a75479", 3768u,
+     "2ecaa57da5fcc9d45bc2d512eeb2b3e98e0393b7", 0, 1737835291u,
+     "00000fffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     0x0000332cu, 0x00032390u,
+     "00000efaa6defd176714ebba2440f0d63ba395ae5d5e5f6578934f1956f2bc2a"},
+    {"fd692ecfd1c2f109afba240b4fc2c4e91208c6d222bf142db7e809fca64f41fe",
+     "adff7ba0a63e11ff303f75314af499db3e2ee6cf", 4252077824u,
+     "08431fa04bb018e19741d10cd692c5cce9ff3502", 0, 1734379819u,
+     "000fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     0xed69cfeeu, 0xed69e06fu,
+     "00081d190397187eb727fd7c3fbc099a6146855f34326014c93d37fdfb3b7faf"},
+    {"d8ebd55b1d9902ce52364b90f29f10c675b8584b21349770c29623b371732614",
+     "b5e2390f20ff16fc3ae926f1c9ebcedc86ef72f2", 744056498u,
+     "b51e636dd01fce9e8d71de5935a6160630519309", 1, 1762567514u,
+     "0000ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     0x328a233fu, 0x328aad86u,
+     "00005be514f8738f78a0d03eac3a00dbb8cf5d9d7099857fd25a6db42456e554"},
+    {"dca271941b0a7dec324fa6bbad2883a1ae8355e3f9eaabd1b830b3d89da55d29",
+     "56820d9f771ac770f22640c698bdf7642688b167", 1891298943u,
+     "6d948fb59c2ea72063d2209dbeaf41faa160a3be", 0, 1725879871u,
+     "00003fffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     0x441bf5fau, 0x441cde67u,
+     "00000f11d672a1f880802c76b7876e892f6d1883da03c2dfc5ec2ff736d66cab"},
+    {"293d6d04525c105f4445c839286ca6ecfc604035c503d9f09b2dd41552c5a5b2",
+     "431b6a985f3dbb69ae8b66b359af0d760aa6a4cf", 1429366971u,
+     "6e3feeaf1c4884df38ebe19e60e1ba188e11b4e8", 1, 1738982785u,
+     "00000fffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     0x71159a2cu, 0x7117c0d4u,
+     "00000fc73a2606ea36df34a21a65fc138354ac79516ee2e6c34f5fcd2f8facfd"},
+    // Search wraps past nonce 0xffffffff
+    {"293d6d04525c105f4445c839286ca6ecfc604035c503d9f09b2dd41552c5a5b2",
+     "431b6a985f3dbb69ae8b66b359af0d760aa6a4cf", 1429366971u,
+     "6e3feeaf1c4884df38ebe19e60e1ba188e11b4e8", 1, 1738982785u,
+     "000fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     0xffffff00u, 0x000013a4u,
+     "000573ef9db3f97e9716047180b2a1f66e151e833eeb86502038405d45b50c8e"},
+};
+
+static int failures = 0;
+
+static std::string HashHex(const uint32_t hash[8]) {
+    std::ostringstream out;
+    for (int i = 0; i < 8; i++) {
+        out << std::hex << std::setw(8) << std::setfill('0') << hash[i];
+    }
+    return out.str();
+}
+
+// "cpu/65536": engines of one kind differ by batch size
+static std::string EngineLabel(const MiningEngine& engine) {
+    return std::string(engine.name()) + "/" + std::to_string(engine.batch_size());
+}
+
+static void Fail(const std::string& path, const std::string& what) {
+    failures++;
+    std::cout << "FAIL [" << path << "] " << what << std::endl;
+}
+
+static bool ParseHash(const char* hex, uint32_t hash[8]) {
+    uint8_t bytes[32];
+    if (!hex_decode(hex, bytes, sizeof(bytes))) {
+        return false;
+    }
+    Target words = target_from_bytes(bytes);
+    memcpy(hash, words.words, sizeof(words.words));
+    return true;
+}
+
+static MiningHeader CorpusHeader(const CorpusTicket& ticket) {
+    MiningHeader header;
+    memset(&header, 0, sizeof(header));
+    header.hash_length = 32;
+    header.address1_length = 20;
+    header.address2_length = 20;
+    hex_decode(ticket.hash, header.hash, sizeof(header.hash));
+    hex_decode(ticket.address1, header.address1, sizeof(header.address1));
+    hex_decode(ticket.address2, header.address2, sizeof(header.address2));
+    header.value = ticket.value;
+    header.flag = ticket.flag;
+    header.timestamp = ticket.timestamp;
+    header.nonce = ticket.nonce;
+    return header;
+}
+
+static MiningHeader RandomHeader(std::mt19937& rng) {
+    MiningHeader header;
+    memset(&header, 0, sizeof(header));
+    header.hash_length = 32;
+    header.address1_length = 20;
+    header.address2_length = 20;
+    for (uint8_t& byte : header.hash) byte = (uint8_t)rng();
+    for (uint8_t& byte : header.address1) byte = (uint8_t)rng();
+    for (uint8_t& byte : header.address2) byte = (uint8_t)rng();
+    header.value = rng();
+    header.flag = rng() & 1;
+    header.timestamp = rng();
+    header.nonce = rng();
+    return header;
+}
+
+// Host midstate path (CPU engine, job setup) against the reference
+static void CheckHostPath(const MiningHeader& header, uint32_t nonce, const std::string& label) {
+    TicketJobConstants job;
+    uint32_t midstate[8];
+    build_job_constants(header, &job);
+    ticket_midstate(job, midstate);
+
+    MiningHeader reference_header = header;
+    reference_header.nonce = nonce;
+    uint32_t reference[8], host[8];
+    TicketVerifier::ticket_hash(reference_header, reference);
+    ticket_hash_from_midstate(midstate, job.words + TicketLayout::kTailWord, nonce, host);
+    if (memcmp(reference, host, sizeof(host)) != 0) {
+        Fail("host", label + ": nonce " + std::to_string(nonce) + " hashed to " + HashHex(host) +
+             ", reference " + HashHex(reference));
+    }
+}
+
+// One batch on an engine; a reported winner must lie in the batch, carry the
+// reference hash for its nonce and meet the target. Returns whether one was found.
+static bool CheckBatch(MiningEngine& engine, const MiningHeader& header, const Target& target,
+                       uint32_t base_nonce, const std::string& label, BatchResult* out = nullptr) {
+    const std::string path = EngineLabel(engine);
+    TicketJobConstants job;
+    build_job_constants(header, &job);
+    BatchResult result;
+    if (!engine.set_job(job, target) || !engine.launch(0, base_nonce) || !engine.collect(0, &result)) {
+        Fail(path, label + ": engine error");
+        return false;
+    }
+    if (out) {
+        *out = result;
+    }
+    if (!result.found) {
+        return false;
+    }
+    if (result.nonce - base_nonce >= engine.batch_size()) {
+        Fail(path, label + ": winner " + std::to_string(result.nonce) + " outside the batch at " +
+             std::to_string(base_nonce));
+        return true;
+    }
+    MiningHeader winner = header;
+    winner.nonce = result.nonce;
+    uint32_t reference[8];
+    TicketVerifier::ticket_hash(winner, reference);
+    if (memcmp(reference, result.hash, sizeof(reference)) != 0) {
+        Fail(path, label + ": nonce " + std::to_string(result.nonce) + " hashed to " + HashHex(result.hash) +
+             ", reference " + HashHex(reference));
+    } else if (!hash_meets_target(reference, target.words)) {
+        Fail(path, label + ": nonce " + std::to_string(result.nonce) + " reported but misses the target");
+    }
+    return true;
+}
+
+static void CheckCorpus(const std::vector<std::unique_ptr<MiningEngine>>& engines) {
+    for (size_t i = 0; i < sizeof(kCorpus) / sizeof(kCorpus[0]); i++) {
+        const CorpusTicket& ticket = kCorpus[i];
+        const std::string label = "corpus #" + std::to_string(i);
+        MiningHeader header = CorpusHeader(ticket);
+        uint32_t expected[8], reference[8];
+        Target target;
+        if (!ParseHash(ticket.expected, expected) || !ParseHash(ticket.target, target.words)) {
+            Fail("corpus", label + ": malformed entry");
+            continue;
+        }
+
+        // The reference itself, against independently computed hashes
+        TicketVerifier::ticket_hash(header, reference);
+        if (memcmp(reference, expected, sizeof(expected)) != 0) {
+            Fail("reference", label + ": hashed to " + HashHex(reference) + ", expected " + ticket.expected);
+        }
+        if (!hash_meets_target(reference, target.words)) {
+            Fail("reference", label + ": winner misses its target");
+        }
+        CheckHostPath(header, ticket.nonce, label);
+
+        for (const auto& engine : engines) {
+            // From the search start when the batch reaches the winner, so engines
+            // that report the first winner must report the corpus nonce
+            uint32_t base = ticket.nonce - ticket.start_nonce < engine->batch_size() ? ticket.start_nonce : ticket.nonce;
+            BatchResult result;
+            if (!CheckBatch(*engine, header, target, base, label, &result)) {
+                Fail(EngineLabel(*engine), label + ": winner " + std::to_string(ticket.nonce) + " not found");
+            } else if (result.nonce == ticket.nonce && memcmp(result.hash, expected, sizeof(expected)) != 0) {
+                Fail(EngineLabel(*engine), label + ": hashed to " + HashHex(result.hash) + ", expected " + ticket.expected);
+            }
+        }
+    }
+}
+
+static void CheckRandom(const std::vector<std::unique_ptr<MiningEngine>>& engines, std::mt19937& rng, int rounds) {
+    Target all_pass, none_pass;
+    memset(all_pass.words, 0xFF, sizeof(all_pass.words));
+    memset(none_pass.words, 0, sizeof(none_pass.words));
+
+    for (int round = 0; round < rounds; round++) {
+        const std::string label = "round " + std::to_string(round);
+        MiningHeader header = RandomHeader(rng);
+        // A run of nonces, so bugs tied to particular nonce bytes show up
+        uint32_t first = rng();
+        for (uint32_t i = 0; i < 256; i++) {
+            CheckHostPath(header, first + i, label);
+        }
+
+        for (const auto& engine : engines) {
+            uint32_t base = rng();
+            // Every nonce passes: the engine's hash of its winner is compared
+            if (!CheckBatch(*engine, header, all_pass, base, label + " all-pass")) {
+                Fail(EngineLabel(*engine), label + ": nothing found with an all-pass target");
+            }
+            // A target equal to one nonce's hash must be met (the comparison is <=)
+            MiningHeader edge = header;
+            edge.nonce = base + rng() % engine->batch_size();
+            Target exact;
+            TicketVerifier::ticket_hash(edge, exact.words);
+            if (!CheckBatch(*engine, header, exact, base, label + " exact")) {
+                Fail(EngineLabel(*engine), label + ": nonce " + std::to_string(edge.nonce) +
+                     " not found with its own hash as the target");
+            }
+            // Nothing may pass an all-zero target
+            if (CheckBatch(*engine, header, none_pass, base, label + " none-pass")) {
+                Fail(EngineLabel(*engine), label + ": winner reported with an all-zero target");
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    int rounds = 50;
+    uint32_t seed = std::random_device()();
+    bool use_cuda = true;
+
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "-h" || args[i] == "--help") {
+            PrintUsage();
+            return 0;
+        }
+        else if (args[i] == "--rounds" && i + 1 < args.size()) {
+            rounds = std::stoi(args[++i]);
+        }
+        else if (args[i] == "--seed" && i + 1 < args.size()) {
+            seed = (uint32_t)std::stoul(args[++i]);
+        }
+        else if (args[i] == "--no-cuda") {
+            use_cuda = false;
+        }
+    }
+
+    // Every engine variant, with batch sizes and slot counts that differ
+    std::vector<std::unique_ptr<MiningEngine>> engines;
+    if (use_cuda) {
+        std::unique_ptr<CudaEngine> cuda(new CudaEngine());
+        if (cuda->ok()) {
+            engines.push_back(std::move(cuda));
+        } else {
+            std::cout << "No usable CUDA device, skipping the cuda engine" << std::endl;
+        }
+    }
+    engines.push_back(std::unique_ptr<MiningEngine>(new CpuEngine()));
+    engines.push_back(std::unique_ptr<MiningEngine>(new CpuEngine(1, 4096, 3)));
+
+    std::cout << "Checking " << engines.size() << " engine(s), " << rounds << " random rounds, seed "
+              << seed << std::endl;
+    std::mt19937 rng(seed);
+    CheckCorpus(engines);
+    CheckRandom(engines, rng, rounds);
+
+    if (failures) {
+        std::cout << failures << " mismatch(es), rerun with --seed " << seed << std::endl;
+        return 1;
+    }
+    std::cout << "All hashing paths match the reference" << std::endl;
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "hdr_histogram.hpp"
+#include <cmath>
+
+static int highest_bit(uint64_t value) {
+    int bit = 63;
+    while (bit > 0 && !(value >> bit)) {
+        bit--;
+    }
+    return bit;
+}
+
+// Values below kSubBucketCount map to themselves. Above that, each doubling
+// gets kSubBucketHalf buckets keyed by the top kSubBucketBits bits.
+size_t HdrHistogram::index_of(uint64_t value) {
+    if (value < kSubBucketCount) {
+        return (size_t)value;
+    }
+    int shift = highest_bit(value) - (kSubBucketBits - 1);
+    uint64_t mantissa = value >> shift;  // In [kSubBucketHalf, kSubBucketCount)
+    return (size_t)(kSubBucketCount + (shift - 1) * kSubBucketHalf + (mantissa - kSubBucketHalf));
+}
+
+uint64_t HdrHistogram::highest_equivalent(size_t index) {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    uint64_t offset = index - kSubBucketCount;
+    int shift = (int)(offset / kSubBucketHalf) + 1;
+    uint64_t mantissa = offset % kSubBucketHalf + kSubBucketHalf;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+HdrHistogram::HdrHistogram(uint64_t max_value)
+    : max_value_(max_value)
+    , buckets_(index_of(max_value) + 1)
+    , counts_(new std::atomic<uint64_t>[buckets_])
+    , count_(0)
+    , sum_(0)
+    , max_(0) {
+    for (size_t i = 0; i < buckets_; i++) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void HdrHistogram::record(uint64_t value) {
+    if (value > max_value_) {
+        value = max_value_;
+    }
+    counts_[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+double HdrHistogram::mean() const {
+    uint64_t n = count();
+    return n ? (double)sum_.load(std::memory_order_relaxed) / n : 0.0;
+}
+
+uint64_t HdrHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)std::ceil(p / 100.0 * n);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_; i++) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t value = highest_equivalent(i);
+            return value < max() ? value : max();
+        }
+    }
+    return max();
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// High-dynamic-range histogram: log-linear buckets with 7 bits of mantissa,
+// so every recorded value is kept within 1/64 (~1.6%) relative error from
+// 1 up to max_value. Recording is a couple of relaxed atomic adds.
+class HdrHistogram {
+public:
+    // Values above max_value are clamped to it
+    explicit HdrHistogram(uint64_t max_value = kDefaultMax);
+
+    void record(uint64_t value);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Highest value within the bucket holding the given percentile (0-100)
+    uint64_t percentile(double p) const;
+
+    static const uint64_t kDefaultMax = (1ull << 36) - 1;  // ~68 s in nanoseconds
+
+private:
+    static const int kSubBucketBits = 7;
+    static const uint64_t kSubBucketCount = 1ull << kSubBucketBits;
+    static const uint64_t kSubBucketHalf = kSubBucketCount / 2;
+
+    static size_t index_of(uint64_t value);
+    static uint64_t highest_equivalent(size_t index);
+
+    uint64_t max_value_;
+    size_t buckets_;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};
@@ -0,0 +1,222 @@
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "host_lease_table.hpp"
+
+// Behavior of the shared host lease table (HostLeaseTable) on a scratch
+// file: fresh ranges and the 2^32 wrap, takeover of expired and released
+// leases, full and solved jobs, and open_job retiring idle entries. Two
+// mappings of the file stand in for two processes. Exits non-zero on any
+// failure.
+
+static int failures = 0;
+
+static const double kShortExpiry = 0.05;
+static const double kLongExpiry = 3600;
+// Past the table's idle limit for job entries (10 minutes)
+static const uint64_t kPastIdleMs = 11 * 60 * 1000;
+
+static void Expect(bool ok, const std::string& check, const std::string& what) {
+    if (!ok) {
+        failures++;
+        std::cout << "FAIL [" << check << "] " << what << std::endl;
+    }
+}
+
+static MiningHeader TestHeader(uint32_t nonce) {
+    MiningHeader header;
+    memset(&header, 0, sizeof(header));
+    header.hash_length = 32;
+    header.address1_length = 20;
+    header.address2_length = 20;
+    for (size_t i = 0; i < sizeof(header.hash); i++) header.hash[i] = (uint8_t)(i * 7 + 1);
+    header.value = 3768;
+    header.timestamp = 1737835291u;
+    header.nonce = nonce;
+    return header;
+}
+
+static void WaitExpiry() {
+    std::this_thread::sleep_for(std::chrono::duration<double>(kShortExpiry * 3));
+}
+
+static std::string Range(const HostLease& lease) {
+    return std::to_string(lease.begin) + "+" + std::to_string(lease.count);
+}
+
+// Same job, same fingerprint; a different start is a different job
+static void CheckFingerprint() {
+    const std::string check = "fingerprint";
+    Target target;
+    memset(target.words, 0, sizeof(target.words));
+    uint64_t fingerprint = HostLeaseTable::fingerprint(TestHeader(0), target);
+    Expect(fingerprint == HostLeaseTable::fingerprint(TestHeader(0), target), check, "not stable");
+    Expect(fingerprint != HostLeaseTable::fingerprint(TestHeader(1), target), check, "start nonce ignored");
+    target.words[7] = 1;
+    Expect(fingerprint != HostLeaseTable::fingerprint(TestHeader(0), target), check, "target ignored");
+    Expect(fingerprint > 1, check, "reserved fingerprint");
+}
+
+// Fresh ranges come from the cursor in order and never cross a wrap
+static void CheckClaim(HostLeaseTable& table) {
+    const std::string check = "claim";
+    const MiningHeader start = TestHeader(0xFFFFFFFFu - 1499);
+    int job = table.open_job(65);
+    Expect(job == 65 % kHostLeaseMaxJobs, check, "job entry " + std::to_string(job));
+    Expect(table.open_job(65) == job, check, "same fingerprint, another entry");
+
+    HostLease first, second, third;
+    table.claim(job, start.nonce, 1000, kShortExpiry, &first);
+    table.claim(job, start.nonce, 1000, kShortExpiry, &second);
+    table.claim(job, start.nonce, 1000, kShortExpiry, &third);
+    Expect(first.begin == 0 && first.count == 1000 && !first.resumed, check, "first lease " + Range(first));
+    Expect(second.begin == 1000 && second.count == 500, check, "lease before the wrap " + Range(second));
+    Expect(third.begin == 1500 && third.count == 1000, check, "lease after the wrap " + Range(third));
+    Expect(first.slot != second.slot && second.slot != third.slot && first.slot != third.slot, check,
+           "leases share a slot");
+
+    MiningHeader header;
+    host_lease_header(start, second.begin, &header);
+    Expect(header.timestamp == start.timestamp && header.nonce == 0xFFFFFFFFu - 499, check, "header before the wrap");
+    host_lease_header(start, third.begin, &header);
+    Expect(header.timestamp == start.timestamp + 1 && header.nonce == 0, check, "header after the wrap");
+    for (const HostLease& lease : {first, second, third}) {
+        table.release(lease, lease.count);
+    }
+}
+
+// An expired lease is taken over from where its owner got to, and the old
+// owner learns it lost it; a released remainder is claimable right away
+static void CheckTakeover(HostLeaseTable& table, HostLeaseTable& other) {
+    const std::string check = "takeover";
+    int job = table.open_job(66);
+    Expect(other.open_job(66) == job, check, "mappings disagree on the job entry");
+
+    HostLease lost;
+    table.claim(job, 0, 1000, kShortExpiry, &lost);
+    Expect(table.renew(lost, 300, kShortExpiry), check, "renew before expiry");
+    WaitExpiry();
+
+    HostLease taken;
+    Expect(other.claim(job, 0, 1000, kLongExpiry, &taken), check, "nothing to claim");
+    Expect(taken.resumed && taken.slot == lost.slot && taken.begin == 300 && taken.count == 700, check,
+           "took over " + Range(taken) + (taken.resumed ? "" : ", not resumed"));
+    Expect(!table.renew(lost, 600, kShortExpiry), check, "old owner renewed a lease taken over");
+    table.release(lost, 1000);
+    Expect(other.renew(taken, 200, kLongExpiry), check, "release by the old owner freed the lease");
+
+    // Given back unfinished: the rest is claimed next, without waiting
+    other.release(taken, 200);
+    HostLease rest;
+    table.claim(job, 0, 1000, kLongExpiry, &rest);
+    Expect(rest.resumed && rest.begin == 500 && rest.count == 500, check, "released remainder " + Range(rest));
+
+    // Given back finished: the slot is free and the next range is fresh
+    table.release(rest, rest.count);
+    HostLease fresh;
+    other.claim(job, 0, 1000, kLongExpiry, &fresh);
+    Expect(!fresh.resumed && fresh.begin == 1000, check, "after a finished release " + Range(fresh));
+    other.release(fresh, fresh.count);
+}
+
+// Every slot held: no claim until one is released
+static void CheckFull(HostLeaseTable& table) {
+    const std::string check = "full";
+    int job = table.open_job(67);
+    HostLease lease;
+    for (int i = 0; i < kHostLeaseMaxLeases; i++) {
+        Expect(table.claim(job, 0, 100, kLongExpiry, &lease), check, "claim " + std::to_string(i) + " refused");
+    }
+    HostLease extra;
+    Expect(!table.claim(job, 0, 100, kLongExpiry, &extra), check, "claim past the last slot");
+    table.release(lease, lease.count);
+    Expect(table.claim(job, 0, 100, kLongExpiry, &extra) && extra.slot == lease.slot, check,
+           "released slot not reused");
+}
+
+// A solved job hands out nothing and tells holders to stop
+static void CheckSolved(HostLeaseTable& table, HostLeaseTable& other) {
+    const std::string check = "solved";
+    int job = table.open_job(68);
+    HostLease lease;
+    table.claim(job, 0, 1000, kLongExpiry, &lease);
+    other.mark_solved(job);
+    Expect(table.solved(job), check, "not seen as solved");
+    Expect(!table.renew(lease, 500, kLongExpiry), check, "renew after solve");
+    Expect(!table.claim(job, 0, 1000, kLongExpiry, &lease), check, "claim after solve");
+}
+
+// Moves the table's epoch back, so every entry looks unused for that long
+static bool AgeTable(const std::filesystem::path& path, uint64_t ms) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    uint64_t epoch_ms = 0;
+    file.seekg(offsetof(HostLeaseHeader, epoch_ms));
+    file.read(reinterpret_cast<char*>(&epoch_ms), sizeof(epoch_ms));
+    epoch_ms -= ms;
+    file.seekp(offsetof(HostLeaseHeader, epoch_ms));
+    file.write(reinterpret_cast<const char*>(&epoch_ms), sizeof(epoch_ms));
+    return file.good();
+}
+
+// A full table turns new jobs away until an entry has been idle long
+// enough; entries with a live lease are kept, and a retired one starts over
+static void CheckRetire(HostLeaseTable& table, const std::filesystem::path& path) {
+    const std::string check = "retire";
+    const uint64_t first = kHostLeaseMaxJobs;
+    for (uint64_t fingerprint = first; fingerprint < first + kHostLeaseMaxJobs; fingerprint++) {
+        int job = table.open_job(fingerprint);
+        Expect(job == (int)(fingerprint % kHostLeaseMaxJobs), check,
+               "fingerprint " + std::to_string(fingerprint) + " in entry " + std::to_string(job));
+    }
+    const uint64_t newcomer = 1000;
+    const int home = (int)(newcomer % kHostLeaseMaxJobs);
+    Expect(table.open_job(newcomer) == -1, check, "entry taken from a job in use");
+
+    HostLease live, idle;
+    table.claim(home, 0, 1000, kLongExpiry, &live);
+    table.claim(home + 1, 0, 1000, kShortExpiry, &idle);
+    Expect(AgeTable(path, kPastIdleMs), check, "could not age the table");
+
+    int job = table.open_job(newcomer);
+    Expect(job == home + 1, check, "newcomer in entry " + std::to_string(job) + ", expected " +
+           std::to_string(home + 1) + " (the home entry has a live lease)");
+    HostLease lease;
+    Expect(table.claim(job, 0, 1000, kLongExpiry, &lease) && !lease.resumed && lease.begin == 0, check,
+           "retired entry kept its old ranges: " + Range(lease));
+    Expect(table.open_job(first + home) == home, check, "job with a live lease lost its entry");
+}
+
+int main() {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "host_lease_check.bin";
+    std::filesystem::remove(path);
+
+    CheckFingerprint();
+    {
+        HostLeaseTable table;
+        HostLeaseTable other;
+        if (!table.open(path.string()) || !other.open(path.string())) {
+            std::cout << "Cannot open " << path.string() << std::endl;
+            return 1;
+        }
+        // Released leases expire at 0 ms; let the table's clock move past it
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        CheckClaim(table);
+        CheckTakeover(table, other);
+        CheckFull(table);
+        CheckSolved(table, other);
+        CheckRetire(table, path);
+    }
+    std::filesystem::remove(path);
+
+    if (failures) {
+        std::cout << failures << " host lease check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Host lease checks passed" << std::endl;
+    return 0;
+}
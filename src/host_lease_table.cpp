@@ -0,0 +1,350 @@
+#include "host_lease_table.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Lease table atomics must be lock-free to be shared");
+
+static const uint64_t kJobRetiring = 1;
+static const uint64_t kJobIdleMs = 10 * 60 * 1000;  // A job unused this long may be replaced
+static const uint64_t kExpiryMask = (1ull << 40) - 1;
+static const uint64_t kNonceSpan = 1ull << 32;
+// Header magic while the file is being initialized: 1, one higher for each
+// takeover. Initializing takes microseconds, so a marker that stays put this
+// long was left by a process that died halfway.
+static const uint32_t kInitMarkerMax = 256;
+static const int kInitStaleMs = 1000;
+
+static uint64_t unix_ms() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t lease_state(uint64_t tag, uint64_t expires_ms) {
+    return tag << 40 | (expires_ms & kExpiryMask);
+}
+
+static uint64_t state_tag(uint64_t state) {
+    return state >> 40;
+}
+
+static uint64_t state_expiry(uint64_t state) {
+    return state & kExpiryMask;
+}
+
+static void fnv1a(uint64_t* hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        *hash = (*hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+}
+
+HostLeaseTable::~HostLeaseTable() {
+    close();
+}
+
+bool HostLeaseTable::open(const std::string& path) {
+    close();
+    size_t size = sizeof(HostLeaseLayout);
+    void* view = nullptr;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    // Grows a new file to size, zero-filled
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, (DWORD)size, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    handle_ = mapping;
+    file_ = file;
+#else
+    int fd = ::open(path.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ((size_t)st.st_size < size && ftruncate(fd, (off_t)size) != 0)) {
+        ::close(fd);
+        return false;
+    }
+    view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+#endif
+    layout_ = static_cast<HostLeaseLayout*>(view);
+
+    // First process in initializes the header; the rest wait for the magic,
+    // and take over a marker that is stale
+    HostLeaseHeader& header = layout_->header;
+    uint32_t magic = 0;
+    bool initialize = header.magic.compare_exchange_strong(magic, 1);
+    int waited = 0;
+    while (!initialize && magic >= 1 && magic < kInitMarkerMax) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        uint32_t current = header.magic.load(std::memory_order_acquire);
+        if (current != magic) {
+            magic = current;
+            waited = 0;
+        } else if (++waited >= kInitStaleMs) {
+            initialize = header.magic.compare_exchange_strong(magic, magic + 1 < kInitMarkerMax ? magic + 1 : 1);
+            waited = 0;
+        }
+    }
+    if (initialize) {
+        // Nothing else is written before the magic, so a takeover starts from scratch too
+        header.version = kHostLeaseVersion;
+        header.size = (uint32_t)size;
+        header.next_tag.store(1);
+        header.epoch_ms = unix_ms();
+        header.magic.store(kHostLeaseMagic, std::memory_order_release);
+    }
+    if (header.magic.load(std::memory_order_acquire) != kHostLeaseMagic ||
+        header.version != kHostLeaseVersion || header.size != size) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void HostLeaseTable::close() {
+    if (!layout_) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(layout_);
+    CloseHandle((HANDLE)handle_);
+    CloseHandle((HANDLE)file_);
+    handle_ = nullptr;
+    file_ = nullptr;
+#else
+    // The file stays: other processes may be using it, and a restart resumes from it
+    munmap(layout_, sizeof(HostLeaseLayout));
+#endif
+    layout_ = nullptr;
+}
+
+uint64_t HostLeaseTable::now_ms() const {
+    return unix_ms() - layout_->header.epoch_ms;
+}
+
+uint64_t HostLeaseTable::next_tag() {
+    // 24-bit tags, never 0
+    return layout_->header.next_tag.fetch_add(1) % ((1u << 24) - 1) + 1;
+}
+
+uint64_t HostLeaseTable::fingerprint(const MiningHeader& header, const Target& target) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    fnv1a(&hash, header.hash, sizeof(header.hash));
+    fnv1a(&hash, header.address1, sizeof(header.address1));
+    fnv1a(&hash, &header.value, sizeof(header.value));
+    fnv1a(&hash, header.address2, sizeof(header.address2));
+    fnv1a(&hash, &header.flag, sizeof(header.flag));
+    fnv1a(&hash, &header.timestamp, sizeof(header.timestamp));
+    fnv1a(&hash, &header.nonce, sizeof(header.nonce));
+    fnv1a(&hash, target.words, sizeof(target.words));
+    return hash > kJobRetiring ? hash : hash + 2;
+}
+
+int HostLeaseTable::open_job(uint64_t fingerprint) {
+    if (!layout_) {
+        return -1;
+    }
+    int home = (int)(fingerprint % kHostLeaseMaxJobs);
+    uint64_t now = now_ms();
+
+    for (int i = 0; i < kHostLeaseMaxJobs; i++) {
+        int index = (home + i) % kHostLeaseMaxJobs;
+        if (layout_->jobs[index].fingerprint.load() == fingerprint) {
+            layout_->jobs[index].last_used_ms.store(now);
+            return index;
+        }
+    }
+
+    // Same probe order in every process, so racing inserts meet at one entry
+    for (int i = 0; i < kHostLeaseMaxJobs; i++) {
+        int index = (home + i) % kHostLeaseMaxJobs;
+        HostLeaseJob& job = layout_->jobs[index];
+        uint64_t current = job.fingerprint.load();
+        if (current == fingerprint) {
+            job.last_used_ms.store(now);
+            return index;
+        }
+        if (current > kJobRetiring && job.last_used_ms.load() + kJobIdleMs < now) {
+            bool live = false;
+            for (HostLeaseSlot& slot : job.leases) {
+                uint64_t state = slot.state.load();
+                live = live || (state != 0 && state_expiry(state) >= now);
+            }
+            if (!live && job.fingerprint.compare_exchange_strong(current, kJobRetiring)) {
+                job.cursor.store(0);
+                job.solved.store(0);
+                for (HostLeaseSlot& slot : job.leases) {
+                    slot.state.store(0);
+                    slot.begin.store(0);
+                    slot.count.store(0);
+                    slot.done.store(0);
+                }
+                current = kJobRetiring;
+                job.fingerprint.compare_exchange_strong(current, 0);
+                current = 0;
+            }
+        }
+        if (current == 0) {
+            job.last_used_ms.store(now);
+            if (job.fingerprint.compare_exchange_strong(current, fingerprint) || current == fingerprint) {
+                return index;
+            }
+        }
+    }
+    return -1;
+}
+
+bool HostLeaseTable::claim(int job_index, uint32_t start_nonce, uint64_t want, double expiry_seconds,
+                           HostLease* lease) {
+    if (!layout_ || job_index < 0) {
+        return false;
+    }
+    HostLeaseJob& job = layout_->jobs[job_index];
+    if (job.solved.load()) {
+        return false;
+    }
+    uint64_t now = now_ms();
+    uint64_t expires = now + (uint64_t)(expiry_seconds * 1000);
+    job.last_used_ms.store(now);
+
+    // Expired leases first: their owner died, stalled, or gave them back
+    for (int i = 0; i < kHostLeaseMaxLeases; i++) {
+        HostLeaseSlot& slot = job.leases[i];
+        uint64_t state = slot.state.load();
+        if (state == 0 || state_expiry(state) >= now) {
+            continue;
+        }
+        uint64_t tag = next_tag();
+        if (!slot.state.compare_exchange_strong(state, lease_state(tag, expires))) {
+            continue;
+        }
+        uint64_t done = slot.done.load();
+        uint64_t count = slot.count.load();
+        if (done >= count) {
+            // Finished, or the owner died before filling it in
+            slot.state.store(0);
+            continue;
+        }
+        lease->begin = slot.begin.load() + done;
+        lease->count = count - done;
+        slot.begin.store(lease->begin);
+        slot.count.store(lease->count);
+        slot.done.store(0);
+        lease->job = job_index;
+        lease->slot = i;
+        lease->tag = tag;
+        lease->resumed = true;
+        return true;
+    }
+
+    for (int i = 0; i < kHostLeaseMaxLeases; i++) {
+        HostLeaseSlot& slot = job.leases[i];
+        uint64_t state = 0;
+        if (slot.state.load() != 0) {
+            continue;
+        }
+        uint64_t tag = next_tag();
+        if (!slot.state.compare_exchange_strong(state, lease_state(tag, expires))) {
+            continue;
+        }
+        // The slot describes the range before the cursor moves past it, so a
+        // crash in between leaves at worst a range that gets hashed twice
+        uint64_t begin = job.cursor.load();
+        for (;;) {
+            uint64_t wrap = ((start_nonce + begin) / kNonceSpan + 1) * kNonceSpan - start_nonce;
+            uint64_t end = std::min(begin + want, wrap);
+            slot.done.store(0);
+            slot.begin.store(begin);
+            slot.count.store(end - begin);
+            if (job.cursor.compare_exchange_weak(begin, end)) {
+                lease->count = end - begin;
+                break;
+            }
+        }
+        lease->job = job_index;
+        lease->slot = i;
+        lease->tag = tag;
+        lease->begin = begin;
+        lease->resumed = false;
+        return true;
+    }
+    return false;
+}
+
+bool HostLeaseTable::renew(const HostLease& lease, uint64_t done, double expiry_seconds) {
+    if (!layout_ || lease.job < 0) {
+        return false;
+    }
+    HostLeaseJob& job = layout_->jobs[lease.job];
+    HostLeaseSlot& slot = job.leases[lease.slot];
+    uint64_t state = slot.state.load();
+    if (state_tag(state) != lease.tag) {
+        return false;
+    }
+    uint64_t now = now_ms();
+    slot.done.store(std::min(done, lease.count));
+    job.last_used_ms.store(now);
+    if (!slot.state.compare_exchange_strong(state, lease_state(lease.tag, now + (uint64_t)(expiry_seconds * 1000)))) {
+        return false;
+    }
+    return !job.solved.load();
+}
+
+void HostLeaseTable::release(const HostLease& lease, uint64_t done) {
+    if (!layout_ || lease.job < 0) {
+        return;
+    }
+    HostLeaseSlot& slot = layout_->jobs[lease.job].leases[lease.slot];
+    uint64_t state = slot.state.load();
+    if (state_tag(state) != lease.tag) {
+        return;
+    }
+    slot.done.store(std::min(done, lease.count));
+    // Expiry 0: the next claim for the job resumes the remainder
+    slot.state.compare_exchange_strong(state, done >= lease.count ? 0 : lease_state(lease.tag, 0));
+}
+
+void HostLeaseTable::mark_solved(int job) {
+    if (layout_ && job >= 0) {
+        layout_->jobs[job].solved.store(1);
+    }
+}
+
+bool HostLeaseTable::solved(int job) const {
+    return layout_ && job >= 0 && layout_->jobs[job].solved.load() != 0;
+}
+
+void host_lease_header(const MiningHeader& start, uint64_t offset, MiningHeader* out) {
+    *out = start;
+    uint64_t position = start.nonce + offset;
+    out->timestamp = start.timestamp + (uint32_t)(position / kNonceSpan);
+    out->nonce = (uint32_t)position;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "miner.cuh"
+
+// Nonce partitioning between miner processes on one host, without a
+// coordinator: every process maps the same file and claims ranges of a job
+// from a shared cursor keyed by the job's fingerprint. Nothing in the table
+// is ever locked. A lease is one 64-bit word holding its owner tag and
+// expiry, so claiming, renewing and taking over are single CAS operations,
+// and a crashed process only leaves behind leases that expire and are
+// resumed by the next process to claim work for the job.
+//
+// Offsets count nonces from the job's starting (timestamp, nonce); the
+// timestamp moves on each time the 32-bit nonce space wraps, and no range
+// crosses a wrap.
+
+static const uint32_t kHostLeaseMagic = 0x4c48424b;  // "KBHL"
+static const uint32_t kHostLeaseVersion = 1;
+static const int kHostLeaseMaxJobs = 64;
+static const int kHostLeaseMaxLeases = 32;  // Outstanding leases per job
+
+struct HostLeaseSlot {
+    std::atomic<uint64_t> state;  // Owner tag << 40 | expiry in ms since the table epoch, 0 when free
+    std::atomic<uint64_t> begin;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> done;   // Nonces from begin known to be hashed
+};
+
+struct HostLeaseJob {
+    std::atomic<uint64_t> fingerprint;  // 0 free, 1 being retired
+    std::atomic<uint64_t> cursor;       // First offset never handed out
+    std::atomic<uint64_t> last_used_ms;
+    std::atomic<uint32_t> solved;
+    uint32_t reserved;
+    HostLeaseSlot leases[kHostLeaseMaxLeases];
+};
+
+struct HostLeaseHeader {
+    std::atomic<uint32_t> magic;  // Stored last when the file is initialized; a small marker until then
+    uint32_t version;
+    uint32_t size;                // sizeof(HostLeaseLayout)
+    std::atomic<uint32_t> next_tag;
+    uint64_t epoch_ms;            // Unix time the expiries count from
+};
+
+struct HostLeaseLayout {
+    HostLeaseHeader header;
+    HostLeaseJob jobs[kHostLeaseMaxJobs];
+};
+
+// One claimed range of a job
+struct HostLease {
+    int job = -1;
+    int slot = -1;
+    uint64_t tag = 0;
+    uint64_t begin = 0;     // Offset of the first nonce
+    uint64_t count = 0;
+    bool resumed = false;   // Left unfinished by a process that died or gave it back
+};
+
+class HostLeaseTable {
+public:
+    HostLeaseTable() : layout_(nullptr), handle_(nullptr), file_(nullptr) {}
+    ~HostLeaseTable();
+    HostLeaseTable(const HostLeaseTable&) = delete;
+    HostLeaseTable& operator=(const HostLeaseTable&) = delete;
+
+    // Maps the file, creating and initializing it if needed
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return layout_ != nullptr; }
+
+    // Same ticket, target and starting point give the same fingerprint in every process
+    static uint64_t fingerprint(const MiningHeader& header, const Target& target);
+
+    // Entry for a job, -1 when every entry belongs to a job used recently
+    int open_job(uint64_t fingerprint);
+
+    // Next range of up to want nonces: an expired lease first, then fresh
+    // nonces from the cursor. False when the job is solved or all of its
+    // lease slots are held.
+    bool claim(int job, uint32_t start_nonce, uint64_t want, double expiry_seconds, HostLease* lease);
+
+    // Records progress and extends the lease; false once the lease was taken
+    // over or the job solved, and the caller should stop
+    bool renew(const HostLease& lease, uint64_t done, double expiry_seconds);
+
+    // Frees a finished lease, or leaves an unfinished one claimable right away
+    void release(const HostLease& lease, uint64_t done);
+
+    void mark_solved(int job);
+    bool solved(int job) const;
+
+private:
+    uint64_t now_ms() const;
+    uint64_t next_tag();
+
+    HostLeaseLayout* layout_;
+    void* handle_;  // File mapping handle on Windows
+    void* file_;    // File handle on Windows
+};
+
+// Header for a lease offset from the job's starting header
+void host_lease_header(const MiningHeader& start, uint64_t offset, MiningHeader* out);
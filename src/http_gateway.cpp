@@ -0,0 +1,704 @@
+#include "http_gateway.hpp"
+#include "miner_service.h"
+#include "log.hpp"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+static const int kSendFlags = 0;
+static void close_socket(intptr_t socket) { closesocket((SOCKET)socket); }
+static int poll_sockets(pollfd* fds, size_t count, int timeout_ms) { return WSAPoll(fds, (ULONG)count, timeout_ms); }
+static void set_nonblocking(intptr_t socket, bool on) {
+    u_long mode = on ? 1 : 0;
+    ioctlsocket((SOCKET)socket, FIONBIO, &mode);
+}
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+static const int kSendFlags = MSG_NOSIGNAL;
+static void close_socket(intptr_t socket) { ::close((int)socket); }
+static int poll_sockets(pollfd* fds, size_t count, int timeout_ms) { return poll(fds, (nfds_t)count, timeout_ms); }
+static void set_nonblocking(intptr_t socket, bool on) {
+    int flags = fcntl((int)socket, F_GETFL, 0);
+    fcntl((int)socket, F_SETFL, on ? flags | O_NONBLOCK : flags & ~O_NONBLOCK);
+}
+#endif
+
+static const intptr_t kInvalidSocket = -1;
+static const size_t kMaxHeaderBytes = 16 * 1024;
+static const size_t kMaxBodyBytes = 1024 * 1024;
+static const int kIdleTimeoutMs = 5000;      // Keep-alive connections idle this long are closed
+static const int kRequestTimeoutMs = 10000;  // A request must arrive in full this long after its first byte
+static const char* const kDefaultTarget = "000000ffffff0000000000000000000000000000000000000000000000000000";
+
+static const char* status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 422: return "Unprocessable Entity";
+        case 431: return "Request Header Fields Too Large";
+        default: return "Internal Server Error";
+    }
+}
+
+// Receives what has arrived, waiting no later than the deadline. Returns -1
+// once it has passed, so a client trickling bytes can't hold a worker.
+static int recv_before(intptr_t socket, char* data, size_t size, std::chrono::steady_clock::time_point deadline) {
+    auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0) {
+        return -1;
+    }
+    pollfd fd{(socket_t)socket, POLLIN, 0};
+    if (poll_sockets(&fd, 1, (int)remaining) <= 0) {
+        return -1;
+    }
+    return (int)recv((socket_t)socket, data, (int)size, 0);
+}
+
+// FastAPI's error body, so clients of the Python gateway need no changes
+static HttpResponse error_response(int status, const std::string& detail) {
+    HttpResponse response;
+    response.status = status;
+    response.body = nlohmann::json{{"detail", detail}}.dump();
+    return response;
+}
+
+static HttpResponse json_response(const nlohmann::ordered_json& body) {
+    HttpResponse response;
+    response.body = body.dump();
+    return response;
+}
+
+// Same mapping as the Python gateway's except clauses
+static HttpResponse grpc_error(const grpc::Status& status) {
+    if (status.error_code() == grpc::StatusCode::UNAVAILABLE) {
+        return error_response(503, "Mining service is not available. Is the gRPC server running?");
+    }
+    return error_response(500, "gRPC error: " + status.error_message());
+}
+
+static std::string to_lower(std::string value) {
+    for (char& c : value) {
+        c = (char)tolower((unsigned char)c);
+    }
+    return value;
+}
+
+static bool send_all(intptr_t client, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int n = send((socket_t)client, data.data() + sent, (int)(data.size() - sent), kSendFlags);
+        if (n <= 0) {
+            return false;
+        }
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// Answers a request that didn't arrive in time; the connection is then closed
+static bool request_timeout(intptr_t client) {
+    HttpResponse response = error_response(408, "Request timed out");
+    send_all(client, "HTTP/1.1 408 Request Timeout\r\nConnection: close\r\nContent-Length: " +
+                     std::to_string(response.body.size()) + "\r\n\r\n" + response.body);
+    return false;
+}
+
+// Hex JSON field of an exact length, decoded into bytes
+static bool hex_field(const nlohmann::json& body, const char* name, size_t bytes, std::string* out,
+                      std::string* error) {
+    if (!body.contains(name) || !body[name].is_string()) {
+        *error = std::string("Field '") + name + "' is required";
+        return false;
+    }
+    const std::string& hex = body[name].get_ref<const std::string&>();
+    if (hex.size() != bytes * 2) {
+        *error = std::string("Field '") + name + "' must be " + std::to_string(bytes * 2) + " hex characters";
+        return false;
+    }
+    out->assign(bytes, '\0');
+    if (!hex_to_bytes(hex.c_str(), reinterpret_cast<uint8_t*>(&(*out)[0]), bytes)) {
+        *error = "Value must be a valid hexadecimal string";
+        return false;
+    }
+    return true;
+}
+
+// Optional integer field in [min, max]; missing or null keeps the default
+static bool int_field(const nlohmann::json& body, const char* name, int64_t min, int64_t max, int64_t* value,
+                      std::string* error) {
+    if (!body.contains(name) || body[name].is_null()) {
+        return true;
+    }
+    if (!body[name].is_number_integer() || body[name].get<int64_t>() < min || body[name].get<int64_t>() > max) {
+        *error = std::string("Field '") + name + "' must be an integer from " + std::to_string(min) + " to " +
+                 std::to_string(max);
+        return false;
+    }
+    *value = body[name].get<int64_t>();
+    return true;
+}
+
+static Histogram& route_histogram(const char* route) {
+    return miner_metrics().histogram("miner_http_request_seconds", "Native REST request handling time",
+                                     metric_label("route", route), Histogram::exponential_bounds(1e-5, 2, 20));
+}
+
+HttpGateway::HttpGateway(MinerServiceImpl& service)
+    : service_(service)
+    , listener_(kInvalidSocket)
+    , wake_(kInvalidSocket)
+    , running_(false)
+    , start_metric_(route_histogram("start"))
+    , pause_metric_(route_histogram("pause"))
+    , resume_metric_(route_histogram("resume"))
+    , status_metric_(route_histogram("status"))
+    , errors_metric_(miner_metrics().counter("miner_http_errors_total", "Native REST responses with status 400 or above")) {}
+
+HttpGateway::~HttpGateway() {
+    stop();
+}
+
+bool HttpGateway::start(const std::string& address, uint16_t port, int threads) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        return false;
+    }
+#endif
+    socket_t listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if ((intptr_t)listener == kInvalidSocket) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+        bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listener, 128) != 0) {
+        close_socket((intptr_t)listener);
+        return false;
+    }
+
+    // The poller's wake-up channel: a UDP socket on loopback connected to itself
+    socket_t wake = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in wake_addr;
+    socklen_t wake_len = sizeof(wake_addr);
+    memset(&wake_addr, 0, sizeof(wake_addr));
+    wake_addr.sin_family = AF_INET;
+    wake_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if ((intptr_t)wake == kInvalidSocket ||
+        bind(wake, reinterpret_cast<sockaddr*>(&wake_addr), sizeof(wake_addr)) != 0 ||
+        getsockname(wake, reinterpret_cast<sockaddr*>(&wake_addr), &wake_len) != 0 ||
+        connect(wake, reinterpret_cast<sockaddr*>(&wake_addr), wake_len) != 0) {
+        if ((intptr_t)wake != kInvalidSocket) {
+            close_socket((intptr_t)wake);
+        }
+        close_socket((intptr_t)listener);
+        return false;
+    }
+    set_nonblocking((intptr_t)wake, true);
+    set_nonblocking((intptr_t)listener, true);
+
+    listener_ = (intptr_t)listener;
+    wake_ = (intptr_t)wake;
+    running_ = true;
+    poller_ = std::thread([this] { poll_loop(); });
+    for (int i = 0; i < (threads > 0 ? threads : 1); i++) {
+        threads_.emplace_back([this] { worker_loop(); });
+    }
+    return true;
+}
+
+void HttpGateway::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    // The poller closes the listener and idle connections; a worker in the
+    // middle of a request finishes it first
+    wake_poller();
+    poller_.join();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    ready_cv_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+    for (Connection& connection : ready_) {
+        close_socket(connection.socket);
+    }
+    for (Connection& connection : returned_) {
+        close_socket(connection.socket);
+    }
+    ready_.clear();
+    returned_.clear();
+    close_socket(wake_);
+    wake_ = kInvalidSocket;
+    listener_ = kInvalidSocket;
+}
+
+void HttpGateway::wake_poller() {
+    char byte = 0;
+    send((socket_t)wake_, &byte, 1, 0);
+}
+
+// Accepts connections and watches the idle ones; a connection with data
+// waiting goes to a worker and comes back after its response is sent
+void HttpGateway::poll_loop() {
+    std::vector<Connection> idle;
+    std::vector<pollfd> fds;
+    while (running_) {
+        fds.clear();
+        fds.push_back(pollfd{(socket_t)listener_, POLLIN, 0});
+        fds.push_back(pollfd{(socket_t)wake_, POLLIN, 0});
+        for (const Connection& connection : idle) {
+            fds.push_back(pollfd{(socket_t)connection.socket, POLLIN, 0});
+        }
+        // Woken for new work; the timeout only paces idle expiry
+        if (poll_sockets(fds.data(), fds.size(), 1000) < 0) {
+            MINER_LOG_RATE_LIMITED(LogSeverity::Warning, 1, "REST gateway poll failed");
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        auto now = std::chrono::steady_clock::now();
+
+        std::vector<Connection> readable;
+        std::vector<Connection> still_idle;
+        for (size_t i = 0; i < idle.size(); i++) {
+            if (fds[i + 2].revents != 0) {
+                readable.push_back(std::move(idle[i]));  // A request, or the client hung up
+            } else if (now - idle[i].idle_since >= std::chrono::milliseconds(kIdleTimeoutMs)) {
+                close_socket(idle[i].socket);
+            } else {
+                still_idle.push_back(std::move(idle[i]));
+            }
+        }
+        idle.swap(still_idle);
+
+        if (fds[1].revents != 0) {
+            char drain[64];
+            while (recv((socket_t)wake_, drain, sizeof(drain), 0) > 0) {
+            }
+        }
+        if (fds[0].revents != 0) {
+            for (;;) {
+                socket_t client = accept((socket_t)listener_, nullptr, nullptr);
+                if ((intptr_t)client == kInvalidSocket) {
+                    break;  // Backlog drained
+                }
+                set_nonblocking((intptr_t)client, false);  // Windows hands down the listener's mode
+                int nodelay = 1;
+                setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay),
+                           sizeof(nodelay));
+#ifdef _WIN32
+                DWORD timeout = kIdleTimeoutMs;
+#else
+                timeval timeout = {kIdleTimeoutMs / 1000, (kIdleTimeoutMs % 1000) * 1000};
+#endif
+                setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout),
+                           sizeof(timeout));
+                idle.push_back(Connection{(intptr_t)client, std::string(), now});
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Connection& connection : returned_) {
+            connection.idle_since = now;
+            idle.push_back(std::move(connection));
+        }
+        returned_.clear();
+        if (!readable.empty()) {
+            for (Connection& connection : readable) {
+                ready_.push_back(std::move(connection));
+            }
+            ready_cv_.notify_all();
+        }
+    }
+
+    for (Connection& connection : idle) {
+        close_socket(connection.socket);
+    }
+#ifdef _WIN32
+    closesocket((SOCKET)listener_);
+#else
+    shutdown((int)listener_, SHUT_RDWR);
+    ::close((int)listener_);
+#endif
+}
+
+void HttpGateway::worker_loop() {
+    for (;;) {
+        Connection connection;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_cv_.wait(lock, [this] { return !running_ || !ready_.empty(); });
+            if (!running_) {
+                return;
+            }
+            connection = std::move(ready_.front());
+            ready_.pop_front();
+        }
+        if (!serve(connection)) {
+            close_socket(connection.socket);
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            returned_.push_back(std::move(connection));
+        }
+        wake_poller();
+    }
+}
+
+// Serves the requests that have arrived on a readable connection. Returns
+// true to keep it open, once nothing more is waiting to be handled.
+bool HttpGateway::serve(Connection& connection) {
+    const intptr_t client = connection.socket;
+    std::string& buffer = connection.buffer;
+    char chunk[8192];
+
+    // Called because the socket is readable, so the first receive won't wait
+    bool readable = true;
+    while (running_) {
+        // The whole request must arrive by this deadline, counted from its first byte
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kRequestTimeoutMs);
+        size_t header_end;
+        while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (buffer.empty() && !readable) {
+                return true;  // Nothing more sent yet: back to the poller
+            }
+            if (buffer.size() > kMaxHeaderBytes) {
+                HttpResponse response = error_response(431, "Request headers too large");
+                send_all(client, "HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\nContent-Length: " +
+                                 std::to_string(response.body.size()) + "\r\n\r\n" + response.body);
+                return false;
+            }
+            if (buffer.empty()) {
+                deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kRequestTimeoutMs);
+            }
+            // Waits only while the rest of a request is on its way
+            int n = recv_before(client, chunk, sizeof(chunk), deadline);
+            if (n < 0 && !buffer.empty() && std::chrono::steady_clock::now() >= deadline) {
+                return request_timeout(client);
+            }
+            if (n <= 0) {
+                return false;  // Closed or error
+            }
+            buffer.append(chunk, (size_t)n);
+            readable = false;
+        }
+
+        // Request line and headers
+        HttpRequest request;
+        std::string version;
+        size_t line_end = buffer.find("\r\n");
+        {
+            std::string line = buffer.substr(0, line_end);
+            size_t first = line.find(' ');
+            size_t second = line.find(' ', first + 1);
+            if (first == std::string::npos || second == std::string::npos) {
+                return false;
+            }
+            request.method = line.substr(0, first);
+            request.path = line.substr(first + 1, second - first - 1);
+            version = line.substr(second + 1);
+            size_t query = request.path.find('?');
+            if (query != std::string::npos) {
+                request.path.resize(query);
+            }
+        }
+        for (size_t pos = line_end + 2; pos < header_end;) {
+            size_t end = buffer.find("\r\n", pos);
+            size_t colon = buffer.find(':', pos);
+            if (colon != std::string::npos && colon < end) {
+                size_t value = buffer.find_first_not_of(' ', colon + 1);
+                request.headers[to_lower(buffer.substr(pos, colon - pos))] =
+                    value < end ? buffer.substr(value, end - value) : "";
+            }
+            pos = end + 2;
+        }
+
+        size_t length = 0;
+        auto content_length = request.headers.find("content-length");
+        if (content_length != request.headers.end()) {
+            length = (size_t)strtoull(content_length->second.c_str(), nullptr, 10);
+        }
+        if (length > kMaxBodyBytes) {
+            HttpResponse response = error_response(413, "Request body too large");
+            send_all(client, "HTTP/1.1 413 Payload Too Large\r\nConnection: close\r\nContent-Length: " +
+                             std::to_string(response.body.size()) + "\r\n\r\n" + response.body);
+            return false;
+        }
+        size_t body_start = header_end + 4;
+        while (buffer.size() < body_start + length) {
+            int n = recv_before(client, chunk, sizeof(chunk), deadline);
+            if (n < 0 && std::chrono::steady_clock::now() >= deadline) {
+                return request_timeout(client);
+            }
+            if (n <= 0) {
+                return false;
+            }
+            buffer.append(chunk, (size_t)n);
+        }
+        request.body = buffer.substr(body_start, length);
+        buffer.erase(0, body_start + length);
+
+        auto connection = request.headers.find("connection");
+        std::string connection_value = connection != request.headers.end() ? to_lower(connection->second) : "";
+        bool keep_alive = version == "HTTP/1.1" ? connection_value != "close" : connection_value == "keep-alive";
+
+        HttpResponse response = handle(request);
+        if (response.status >= 400) {
+            errors_metric_.add();
+        }
+
+        std::string out;
+        out.reserve(256 + response.body.size());
+        out += "HTTP/1.1 " + std::to_string(response.status) + " " + status_text(response.status) + "\r\n";
+        out += "Content-Type: " + response.content_type + "\r\n";
+        out += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+        out += "Access-Control-Allow-Origin: *\r\n";
+        if (request.method == "OPTIONS") {
+            out += "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n";
+            out += "Access-Control-Allow-Headers: *\r\n";
+        }
+        out += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+        out += response.body;
+        if (!send_all(client, out) || !keep_alive) {
+            return false;
+        }
+    }
+    return false;
+}
+
+HttpResponse HttpGateway::handle(const HttpRequest& request) {
+    if (request.method == "OPTIONS") {
+        // CORS preflight, same policy as the Python gateway (any origin)
+        HttpResponse response;
+        response.status = 204;
+        return response;
+    }
+
+    // /mine/start, /mine/resume, /mine/{id}/pause, /mine/{id}/status, /metrics
+    std::vector<std::string> parts;
+    for (size_t pos = 1; pos <= request.path.size();) {
+        size_t end = request.path.find('/', pos);
+        if (end == std::string::npos) {
+            end = request.path.size();
+        }
+        parts.push_back(request.path.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    auto timed = [](Histogram& metric, auto&& handler) {
+        auto start = std::chrono::steady_clock::now();
+        HttpResponse response = handler();
+        metric.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        return response;
+    };
+
+    if (parts.size() == 1 && parts[0] == "metrics") {
+        return request.method == "GET" ? get_metrics() : error_response(405, "Method Not Allowed");
+    }
+    if (parts.size() == 2 && parts[0] == "mine" && (parts[1] == "start" || parts[1] == "resume")) {
+        if (request.method != "POST") {
+            return error_response(405, "Method Not Allowed");
+        }
+        return parts[1] == "start"
+            ? timed(start_metric_, [&] { return start_mining(request); })
+            : timed(resume_metric_, [&] { return resume_mining(request); });
+    }
+    if (parts.size() == 3 && parts[0] == "mine" && (parts[2] == "pause" || parts[2] == "status")) {
+        const std::string& session_id = parts[1];
+        if (parts[2] == "pause") {
+            if (request.method != "POST") {
+                return error_response(405, "Method Not Allowed");
+            }
+            if (session_id.empty()) {
+                return error_response(400, "Invalid session ID");
+            }
+            return timed(pause_metric_, [&] { return pause_mining(session_id); });
+        }
+        if (request.method != "GET") {
+            return error_response(405, "Method Not Allowed");
+        }
+        if (session_id.empty()) {
+            return error_response(400, "Invalid session ID");
+        }
+        return timed(status_metric_, [&] { return get_status(session_id); });
+    }
+    return error_response(404, "Not Found");
+}
+
+HttpResponse HttpGateway::start_mining(const HttpRequest& request) {
+    nlohmann::json body = nlohmann::json::parse(request.body, nullptr, false);
+    if (body.is_discarded() || !body.is_object()) {
+        return error_response(422, "Request body must be a JSON object");
+    }
+
+    miner::StartMiningV2Request rpc_request;
+    std::string error, hash, addr1, addr2, target;
+    int64_t value = -1;
+    int64_t timestamp = (int64_t)time(nullptr);
+    int64_t time_limit = 0;
+    int64_t flag = 0;
+    if (!hex_field(body, "hash", 32, &hash, &error) ||
+        !hex_field(body, "addr1", 20, &addr1, &error) ||
+        !hex_field(body, "addr2", 20, &addr2, &error) ||
+        !int_field(body, "value", 0, 0xFFFFFFFFll, &value, &error) ||
+        !int_field(body, "timestamp", 0, 0xFFFFFFFFll, &timestamp, &error) ||
+        !int_field(body, "time_limit", 0, 0xFFFFFFFFll, &time_limit, &error) ||
+        !int_field(body, "flag", 0, 1, &flag, &error)) {
+        return error_response(error.find("hexadecimal") != std::string::npos ? 400 : 422, error);
+    }
+    if (value < 0) {
+        return error_response(422, "Field 'value' is required");
+    }
+    nlohmann::json target_body = body;
+    if (!body.contains("target")) {
+        target_body["target"] = kDefaultTarget;
+    }
+    if (!hex_field(target_body, "target", 32, &target, &error)) {
+        return error_response(error.find("hexadecimal") != std::string::npos ? 400 : 422, error);
+    }
+
+    rpc_request.set_hash(hash);
+    rpc_request.set_addr1(addr1);
+    rpc_request.set_addr2(addr2);
+    rpc_request.set_value((uint32_t)value);
+    rpc_request.set_timestamp((uint32_t)timestamp);
+    rpc_request.set_target(target);
+    rpc_request.set_time_limit((uint32_t)time_limit);
+    rpc_request.set_flag((uint32_t)flag);
+    if (body.contains("group_id")) {
+        if (!body["group_id"].is_string()) {
+            return error_response(422, "Field 'group_id' must be a string");
+        }
+        rpc_request.set_group_id(body["group_id"].get<std::string>());
+    }
+
+    miner::StartMiningResponse rpc_response;
+    grpc::Status status = service_.StartMiningV2(nullptr, &rpc_request, &rpc_response);
+    if (!status.ok()) {
+        return grpc_error(status);
+    }
+    if (!rpc_response.success()) {
+        return error_response(400, rpc_response.message().empty() ? "Failed to start mining" : rpc_response.message());
+    }
+    return json_response({{"session_id", rpc_response.session_id()}});
+}
+
+HttpResponse HttpGateway::pause_mining(const std::string& session_id) {
+    miner::PauseMiningRequest rpc_request;
+    rpc_request.set_session_id(session_id);
+    miner::PauseMiningResponse rpc_response;
+    grpc::Status status = service_.PauseMining(nullptr, &rpc_request, &rpc_response);
+    if (!status.ok()) {
+        return grpc_error(status);
+    }
+    return json_response({{"state_file", rpc_response.state_file()}});
+}
+
+HttpResponse HttpGateway::resume_mining(const HttpRequest& request) {
+    nlohmann::json body = nlohmann::json::parse(request.body, nullptr, false);
+    if (body.is_discarded() || !body.is_object()) {
+        return error_response(422, "Field 'session_id' or 'state_file' is required");
+    }
+    // A paused session by id, or a state file after a restart
+    miner::ResumeMiningRequest rpc_request;
+    if (body.contains("session_id") && body["session_id"].is_string()) {
+        rpc_request.set_session_id(body["session_id"].get<std::string>());
+    } else if (body.contains("state_file") && body["state_file"].is_string()) {
+        rpc_request.set_state_file(body["state_file"].get<std::string>());
+    } else {
+        return error_response(422, "Field 'session_id' or 'state_file' is required");
+    }
+    miner::ResumeMiningResponse rpc_response;
+    grpc::Status status = service_.ResumeMining(nullptr, &rpc_request, &rpc_response);
+    if (!status.ok()) {
+        return grpc_error(status);
+    }
+    return json_response({{"session_id", rpc_response.session_id()}});
+}
+
+HttpResponse HttpGateway::get_status(const std::string& session_id) {
+    miner::GetStatusRequest rpc_request;
+    rpc_request.set_session_id(session_id);
+    miner::GetStatusV2Response rpc_response;
+    grpc::Status status = service_.GetStatusV2(nullptr, &rpc_request, &rpc_response);
+    if (!status.ok()) {
+        if (status.error_code() == grpc::StatusCode::NOT_FOUND) {
+            return error_response(404, "Mining session not found");
+        }
+        return grpc_error(status);
+    }
+
+    std::string current_nonce = std::to_string(rpc_response.current_nonce());
+    bool found = rpc_response.solution_found();
+    char message[96] = "";
+    if (found) {
+        snprintf(message, sizeof(message), "Mining complete. Found nonce: 0x%x", rpc_response.current_nonce());
+    } else if (!rpc_response.cancelled_by().empty()) {
+        snprintf(message, sizeof(message), "Cancelled: session %s of the group found a solution",
+                 rpc_response.cancelled_by().c_str());
+    }
+    nlohmann::ordered_json latency = nlohmann::ordered_json::array();
+    for (const miner::LatencySummary& summary : rpc_response.submit_latency()) {
+        latency.push_back({{"hop", summary.hop()}, {"count", summary.count()}, {"p50_ms", summary.p50_ms()},
+                           {"p99_ms", summary.p99_ms()}, {"p999_ms", summary.p999_ms()},
+                           {"max_ms", summary.max_ms()}});
+    }
+    nlohmann::ordered_json body;
+    body["is_mining"] = rpc_response.is_mining();
+    body["current_nonce"] = current_nonce;
+    body["total_hashes"] = rpc_response.total_hashes();
+    body["hash_rate"] = rpc_response.hash_rate();
+    body["message"] = message;
+    body["solution_found"] = found;
+    body["solution_nonce"] = found ? nlohmann::ordered_json(current_nonce) : nlohmann::ordered_json(nullptr);
+    body["time_to_first_hash_ms"] = rpc_response.time_to_first_hash_ms();
+    body["submit_latency"] = latency;
+    body["state_file"] = rpc_response.state_file();
+    return json_response(body);
+}
+
+HttpResponse HttpGateway::get_metrics() {
+    miner::GetMetricsRequest rpc_request;
+    miner::GetMetricsResponse rpc_response;
+    grpc::Status status = service_.GetMetrics(nullptr, &rpc_request, &rpc_response);
+    if (!status.ok()) {
+        return grpc_error(status);
+    }
+    HttpResponse response;
+    response.content_type = "text/plain; version=0.0.4";
+    response.body = rpc_response.text();
+    return response;
+}
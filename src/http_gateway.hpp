@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "metrics.hpp"
+
+class MinerServiceImpl;
+
+struct HttpRequest {
+    std::string method;
+    std::string path;                            // Without the query string
+    std::map<std::string, std::string> headers;  // Lower-case names
+    std::string body;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "application/json";
+    std::string body;
+};
+
+// The REST endpoints of rest_server/server.py (/mine/start, /mine/{id}/pause,
+// /mine/resume, /mine/{id}/status, /metrics) served by the miner itself. Handlers
+// call the service in-process, so a request costs one socket hop and no gRPC
+// round trip. Plain HTTP/1.1 with keep-alive: one poller thread accepts and
+// watches idle connections, and a fixed set of worker threads serves the
+// ones with a request waiting, so idle keep-alive clients hold no worker.
+class HttpGateway {
+public:
+    explicit HttpGateway(MinerServiceImpl& service);
+    ~HttpGateway();
+    HttpGateway(const HttpGateway&) = delete;
+    HttpGateway& operator=(const HttpGateway&) = delete;
+
+    bool start(const std::string& address, uint16_t port, int threads);
+    void stop();
+
+    HttpResponse handle(const HttpRequest& request);
+
+private:
+    struct Connection {
+        intptr_t socket;
+        std::string buffer;  // Received bytes not yet handled (a pipelined request)
+        std::chrono::steady_clock::time_point idle_since;
+    };
+
+    void poll_loop();
+    void worker_loop();
+    void wake_poller();
+    bool serve(Connection& connection);
+
+    HttpResponse start_mining(const HttpRequest& request);
+    HttpResponse pause_mining(const std::string& session_id);
+    HttpResponse resume_mining(const HttpRequest& request);
+    HttpResponse get_status(const std::string& session_id);
+    HttpResponse get_metrics();
+
+    MinerServiceImpl& service_;
+    intptr_t listener_;
+    intptr_t wake_;  // Loopback UDP socket connected to itself; a datagram wakes the poller
+    std::atomic<bool> running_;
+    std::thread poller_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable ready_cv_;
+    std::deque<Connection> ready_;      // Readable connections waiting for a worker, under mutex_
+    std::vector<Connection> returned_;  // Served keep-alive connections going back to the poller, under mutex_
+    Histogram& start_metric_;
+    Histogram& pause_metric_;
+    Histogram& resume_metric_;
+    Histogram& status_metric_;
+    Counter& errors_metric_;
+};
@@ -0,0 +1,213 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "nonce_lease.hpp"
+
+// Behavior of the coordinator's lease book (NonceLeaseBook): range order,
+// reclaim of expired leases, the completed frontier, the 2^32 wrap and
+// what finishing a job leaves behind. Single process, no GPU; exits
+// non-zero on any failure.
+
+static int failures = 0;
+
+// Leases are held for kExpiry when the worker's rate is unknown
+static const double kExpiry = 0.05;
+
+static void Expect(bool ok, const std::string& check, const std::string& what) {
+    if (!ok) {
+        failures++;
+        std::cout << "FAIL [" << check << "] " << what << std::endl;
+    }
+}
+
+static MiningHeader TestHeader(uint32_t nonce) {
+    MiningHeader header;
+    memset(&header, 0, sizeof(header));
+    header.hash_length = 32;
+    header.address1_length = 20;
+    header.address2_length = 20;
+    for (size_t i = 0; i < sizeof(header.hash); i++) header.hash[i] = (uint8_t)(i * 7 + 1);
+    header.value = 3768;
+    header.timestamp = 1737835291u;
+    header.nonce = nonce;
+    return header;
+}
+
+static Target NonePass() {
+    Target target;
+    memset(target.words, 0, sizeof(target.words));
+    return target;
+}
+
+static void WaitExpiry() {
+    std::this_thread::sleep_for(std::chrono::duration<double>(kExpiry * 3));
+}
+
+static std::string Position(uint32_t timestamp, uint32_t nonce) {
+    return std::to_string(timestamp) + ":" + std::to_string(nonce);
+}
+
+// Probe leases are one granule each, handed out in order from the start
+static void CheckOrder() {
+    const std::string check = "order";
+    NonceLeaseBook book(5.0, kExpiry);
+    book.add_job("a", TestHeader(5000), NonePass(), 0);
+    for (uint32_t i = 0; i < 3; i++) {
+        NonceLease lease;
+        Expect(book.acquire("w", 0, 1000, &lease), check, "no lease " + std::to_string(i));
+        Expect(lease.job_id == "a" && lease.nonce_count == 1000, check,
+               "lease " + std::to_string(i) + " is " + std::to_string(lease.nonce_count) + " nonces");
+        Expect(lease.header.nonce == 5000 + i * 1000, check, "lease " + std::to_string(i) + " starts at " +
+               std::to_string(lease.header.nonce));
+    }
+    // A measured rate gets lease_seconds of work, in whole granules
+    NonceLease sized;
+    book.acquire("w", 1500, 1000, &sized);
+    Expect(sized.nonce_count == 8000, check, "rated lease is " + std::to_string(sized.nonce_count) + " nonces");
+    Expect(book.stats().leases_issued == 4 && book.stats().leases_outstanding == 4, check, "stats");
+}
+
+// Expired leases go back to the job and are reissued, oldest first, before
+// any fresh range; a completed one is not
+static void CheckReclaim() {
+    const std::string check = "reclaim";
+    NonceLeaseBook book(5.0, kExpiry);
+    book.add_job("a", TestHeader(0), NonePass(), 0);
+    NonceLease first, second, third;
+    book.acquire("w1", 0, 1000, &first);
+    book.acquire("w2", 0, 1000, &second);
+    book.acquire("w3", 0, 1000, &third);
+    NonceLease done;
+    Expect(book.complete(second.id, 1000, &done) && done.header.nonce == 1000, check, "complete");
+    WaitExpiry();
+
+    NonceLease lease;
+    book.acquire("w4", 0, 1000, &lease);
+    Expect(lease.header.nonce == 0, check, "first reissue starts at " + std::to_string(lease.header.nonce));
+    book.acquire("w4", 0, 500, &lease);
+    Expect(lease.header.nonce == 2000 && lease.nonce_count == 500, check,
+           "second reissue starts at " + std::to_string(lease.header.nonce) + " for " +
+           std::to_string(lease.nonce_count));
+    book.acquire("w4", 0, 1000, &lease);
+    Expect(lease.header.nonce == 2500 && lease.nonce_count == 500, check,
+           "rest of the split range starts at " + std::to_string(lease.header.nonce));
+    book.acquire("w4", 0, 1000, &lease);
+    Expect(lease.header.nonce == 3000, check, "fresh range starts at " + std::to_string(lease.header.nonce));
+    Expect(book.stats().leases_expired == 2, check, std::to_string(book.stats().leases_expired) + " expired");
+
+    // An expired lease still completes, and its hashes count
+    Expect(book.complete(first.id, 1000, &done), check, "expired lease not completed");
+    Expect(!book.complete(first.id, 1000, &done), check, "lease completed twice");
+}
+
+// The frontier is the lowest range not completed, wherever it is
+static void CheckFrontier() {
+    const std::string check = "frontier";
+    const MiningHeader start = TestHeader(0);
+    NonceLeaseBook book(5.0, kExpiry);
+    book.add_job("a", start, NonePass(), 0, 700);
+    NonceLease first, second, third, done;
+    book.acquire("w", 0, 1000, &first);
+    book.acquire("w", 0, 1000, &second);
+    book.acquire("w", 0, 1000, &third);
+
+    LeaseJobProgress progress;
+    book.complete(second.id, 1000, &done);
+    book.complete(third.id, 1000, &done);
+    Expect(book.job_progress("a", &progress), check, "job not known");
+    Expect(progress.frontier.nonce == 0, check, "open lease: frontier at " + std::to_string(progress.frontier.nonce));
+    Expect(progress.hashes == 2700, check, std::to_string(progress.hashes) + " hashes");
+
+    book.complete(first.id, 1000, &done);
+    book.job_progress("a", &progress);
+    Expect(progress.frontier.nonce == 3000 && progress.frontier.timestamp == start.timestamp, check,
+           "all completed: frontier at " + Position(progress.frontier.timestamp, progress.frontier.nonce));
+
+    // An expired range holds the frontier back until it is completed again
+    NonceLease lost;
+    book.acquire("w", 0, 1000, &lost);
+    book.acquire("w", 0, 1000, &first);
+    book.complete(first.id, 1000, &done);
+    WaitExpiry();
+    Expect(book.finish_job("a", &progress), check, "finish_job");
+    Expect(progress.frontier.nonce == 3000, check, "expired lease: frontier at " +
+           std::to_string(progress.frontier.nonce));
+    Expect(progress.hashes == 4700, check, std::to_string(progress.hashes) + " hashes at finish");
+}
+
+// Ranges stop at the end of a timestamp's nonces and go on at the next one
+static void CheckWrap() {
+    const std::string check = "wrap";
+    const MiningHeader start = TestHeader(0xFFFFFFFFu - 1499);
+    NonceLeaseBook book(5.0, kExpiry);
+    book.add_job("a", start, NonePass(), 0);
+    NonceLease first, second, third, done;
+    book.acquire("w", 0, 1000, &first);
+    book.acquire("w", 0, 1000, &second);
+    book.acquire("w", 0, 1000, &third);
+    Expect(first.header.timestamp == start.timestamp && first.nonce_count == 1000, check, "first lease");
+    Expect(second.header.nonce == 0xFFFFFFFFu - 499 && second.nonce_count == 500, check,
+           "lease before the wrap is " + std::to_string(second.nonce_count) + " nonces");
+    Expect(third.header.timestamp == start.timestamp + 1 && third.header.nonce == 0 && third.nonce_count == 1000,
+           check, "lease after the wrap at " + Position(third.header.timestamp, third.header.nonce));
+
+    LeaseJobProgress progress;
+    book.complete(first.id, 1000, &done);
+    book.complete(second.id, 500, &done);
+    book.job_progress("a", &progress);
+    Expect(progress.frontier.timestamp == start.timestamp + 1 && progress.frontier.nonce == 0, check,
+           "frontier at " + Position(progress.frontier.timestamp, progress.frontier.nonce));
+    book.complete(third.id, 1000, &done);
+    book.job_progress("a", &progress);
+    Expect(progress.frontier.timestamp == start.timestamp + 1 && progress.frontier.nonce == 1000, check,
+           "frontier past the wrap at " + Position(progress.frontier.timestamp, progress.frontier.nonce));
+}
+
+// Finishing a job closes it once, moves work on to the next job, and the
+// leases it still had out are dropped once they expire
+static void CheckFinish() {
+    const std::string check = "finish";
+    NonceLeaseBook book(5.0, kExpiry);
+    book.add_job("a", TestHeader(0), NonePass(), 0);
+    book.add_job("b", TestHeader(0), NonePass(), 0);
+    NonceLease early, late, lease, done;
+    book.acquire("w", 0, 1000, &early);
+    book.acquire("w", 0, 1000, &late);
+    Expect(book.finish_job("a"), check, "first finish_job");
+    Expect(!book.finish_job("a"), check, "second finish_job");
+    Expect(!book.job_active("a"), check, "finished job still active");
+
+    book.acquire("w", 0, 1000, &lease);
+    Expect(lease.job_id == "b", check, "lease from " + lease.job_id + " after it finished");
+    Expect(book.complete(early.id, 1000, &done) && done.job_id == "a", check,
+           "lease completed before it expired is unknown");
+    WaitExpiry();
+    book.acquire("w", 0, 1000, &lease);
+    Expect(!book.complete(late.id, 1000, &done), check, "orphaned lease still known after it expired");
+    Expect(book.stats().jobs_active == 1, check, std::to_string(book.stats().jobs_active) + " jobs active");
+
+    // A job whose time is up finishes on its own
+    book.add_job("c", TestHeader(0), NonePass(), (float)kExpiry);
+    WaitExpiry();
+    LeaseJobProgress progress;
+    Expect(!book.job_progress("c", &progress) && !book.job_active("c"), check, "expired job still active");
+    Expect(book.finish_job("b"), check, "finish_job b");
+    Expect(!book.acquire("w", 0, 1000, &lease), check, "lease handed out with no job left");
+}
+
+int main() {
+    CheckOrder();
+    CheckReclaim();
+    CheckFrontier();
+    CheckWrap();
+    CheckFinish();
+
+    if (failures) {
+        std::cout << failures << " lease check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Lease checks passed" << std::endl;
+    return 0;
+}
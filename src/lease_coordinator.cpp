@@ -0,0 +1,91 @@
+#include "lease_coordinator.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <chrono>
+
+LeaseCoordinatorImpl::LeaseCoordinatorImpl(double lease_seconds, double expiry_seconds,
+                                           LeaseSolutionHandler on_solution)
+    : book_(lease_seconds, expiry_seconds)
+    , verifier_("lease")
+    , on_solution_(std::move(on_solution))
+    , leases_metric_(miner_metrics().counter("miner_leases_issued_total", "Nonce range leases handed to workers"))
+    , hashes_metric_(miner_metrics().counter("miner_lease_hashes_total", "Nonces hashed by workers for leases"))
+    , outstanding_metric_(miner_metrics().gauge("miner_leases_outstanding", "Leases issued and not yet completed or expired")) {}
+
+grpc::Status LeaseCoordinatorImpl::AcquireLease(
+    grpc::ServerContext* context,
+    const miner::AcquireLeaseRequest* request,
+    miner::AcquireLeaseResponse* response) {
+
+    NonceLease lease;
+    if (!book_.acquire(request->worker_id(), request->hash_rate(), request->granularity(), &lease)) {
+        response->set_has_lease(false);
+        response->set_retry_after_ms(1000);
+        return grpc::Status::OK;
+    }
+    leases_metric_.add();
+    outstanding_metric_.set((int64_t)book_.stats().leases_outstanding);
+
+    const MiningHeader& header = lease.header;
+    response->set_has_lease(true);
+    response->set_lease_id(lease.id);
+    response->set_job_id(lease.job_id);
+    response->set_hash(std::string(reinterpret_cast<const char*>(header.hash), sizeof(header.hash)));
+    response->set_addr1(std::string(reinterpret_cast<const char*>(header.address1), sizeof(header.address1)));
+    response->set_addr2(std::string(reinterpret_cast<const char*>(header.address2), sizeof(header.address2)));
+    response->set_value(header.value);
+    response->set_timestamp(header.timestamp);
+    uint8_t target[32];
+    target_to_bytes(lease.target, target);
+    response->set_target(std::string(reinterpret_cast<const char*>(target), sizeof(target)));
+    response->set_flag(header.flag);
+    response->set_nonce_begin(header.nonce);
+    response->set_nonce_count(lease.nonce_count);
+    auto hold = std::chrono::duration_cast<std::chrono::milliseconds>(lease.expires - std::chrono::steady_clock::now());
+    response->set_expires_in_ms((uint32_t)std::max<int64_t>(hold.count(), 0));
+
+    LOG_DEBUG("Lease {} for job {} to {}: timestamp {}, nonces {:08x}+{}", lease.id, lease.job_id,
+              lease.worker_id, header.timestamp, header.nonce, lease.nonce_count);
+    return grpc::Status::OK;
+}
+
+grpc::Status LeaseCoordinatorImpl::CompleteLease(
+    grpc::ServerContext* context,
+    const miner::CompleteLeaseRequest* request,
+    miner::CompleteLeaseResponse* response) {
+
+    NonceLease lease;
+    if (!book_.complete(request->lease_id(), request->hashes(), &lease)) {
+        // Coordinator restarted or the lease was already completed
+        response->set_accepted(false);
+        response->set_job_done(true);
+        response->set_message("Unknown lease");
+        return grpc::Status::OK;
+    }
+    hashes_metric_.add(request->hashes());
+    outstanding_metric_.set((int64_t)book_.stats().leases_outstanding);
+    response->set_accepted(true);
+
+    if (request->found()) {
+        MiningHeader header = lease.header;
+        header.nonce = request->nonce();
+        VerifyResult result;
+        LeaseJobProgress progress;
+        if (!verifier_.verify(header, lease.target, nullptr, &result)) {
+            LOG_WARNING("Worker {} reported nonce {:08x} for job {} that fails verification",
+                        request->worker_id(), request->nonce(), lease.job_id);
+            response->set_accepted(false);
+            response->set_message("Solution failed verification");
+        } else if (book_.finish_job(lease.job_id, &progress)) {
+            LOG_INFO("Job {} solved by {}: timestamp {}, nonce {:08x}", lease.job_id, request->worker_id(),
+                     header.timestamp, header.nonce);
+            response->set_message("Solution accepted");
+            on_solution_(lease.job_id, header, progress.hashes);
+        } else {
+            response->set_message("Job already finished");
+        }
+    }
+
+    response->set_job_done(!book_.job_active(lease.job_id));
+    return grpc::Status::OK;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <grpcpp/grpcpp.h>
+#include "miner.grpc.pb.h"
+#include "miner.cuh"
+#include "miner_config.hpp"
+#include "metrics.hpp"
+#include "nonce_lease.hpp"
+#include "ticket_verifier.hpp"
+
+// Called once per job with the solved header (timestamp and nonce set) and
+// the hashes workers reported for the job
+typedef std::function<void(const std::string& job_id, const MiningHeader& header, uint64_t hashes)>
+    LeaseSolutionHandler;
+
+// gRPC face of the lease book. Solutions reported by workers are verified
+// on the CPU again before the job is closed and the handler runs.
+class LeaseCoordinatorImpl final : public miner::LeaseCoordinator::Service {
+public:
+    LeaseCoordinatorImpl(double lease_seconds, double expiry_seconds, LeaseSolutionHandler on_solution);
+
+    NonceLeaseBook& book() { return book_; }
+
+    grpc::Status AcquireLease(grpc::ServerContext* context,
+                              const miner::AcquireLeaseRequest* request,
+                              miner::AcquireLeaseResponse* response) override;
+
+    grpc::Status CompleteLease(grpc::ServerContext* context,
+                               const miner::CompleteLeaseRequest* request,
+                               miner::CompleteLeaseResponse* response) override;
+
+private:
+    NonceLeaseBook book_;
+    TicketVerifier verifier_;
+    LeaseSolutionHandler on_solution_;
+    Counter& leases_metric_;
+    Counter& hashes_metric_;
+    Gauge& outstanding_metric_;
+};
+
+// Worker mode: pulls leases from the coordinator and mines them with this
+// process's engines (one lease loop per engine) until interrupted
+int run_lease_worker(const MinerConfig& config, const std::string& coordinator, const std::string& worker_id);
@@ -0,0 +1,147 @@
+#include "lease_coordinator.hpp"
+#include "cuda_engine.hpp"
+#include "cpu_engine.hpp"
+#include "engine_pool.hpp"
+#include "log.hpp"
+#include "throttle.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static void lease_loop(miner::LeaseCoordinator::Stub& stub, MiningEngine& engine, const std::string& worker_id,
+                       Throttle& throttle) {
+    TicketVerifier verifier(engine.name());
+    const uint32_t batch = engine.batch_size();
+    const int slots = engine.slots();
+    // Lease sizes in whole launch cycles, so a lease ends on a launch boundary
+    const uint32_t granularity = batch * (uint32_t)slots;
+    double hash_rate = 0;
+    double full_rate = 0;  // Unthrottled, for the duty cycle
+    ProgressObserver progress;  // Reset for every lease
+
+    for (;;) {
+        miner::AcquireLeaseRequest request;
+        request.set_worker_id(worker_id);
+        request.set_hash_rate(hash_rate);
+        request.set_granularity(granularity);
+        miner::AcquireLeaseResponse lease;
+        grpc::ClientContext acquire_context;
+        acquire_context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+        grpc::Status status = stub.AcquireLease(&acquire_context, request, &lease);
+        if (!status.ok()) {
+            MINER_LOG_RATE_LIMITED(LogSeverity::Warning, 1, "Worker {}: coordinator unreachable: {}",
+                                   worker_id, status.error_message());
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+        if (!lease.has_lease()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(lease.retry_after_ms()));
+            continue;
+        }
+        if (lease.hash().size() != sizeof(MiningHeader::hash) ||
+            lease.addr1().size() != sizeof(MiningHeader::address1) ||
+            lease.addr2().size() != sizeof(MiningHeader::address2) ||
+            lease.target().size() != 32) {
+            LOG_ERROR("Worker {}: malformed lease {}", worker_id, lease.lease_id());
+            continue;
+        }
+
+        MiningHeader header;
+        memset(&header, 0, sizeof(header));
+        header.hash_length = 32;
+        header.address1_length = 20;
+        header.address2_length = 20;
+        memcpy(header.hash, lease.hash().data(), sizeof(header.hash));
+        memcpy(header.address1, lease.addr1().data(), sizeof(header.address1));
+        memcpy(header.address2, lease.addr2().data(), sizeof(header.address2));
+        header.value = lease.value();
+        header.timestamp = lease.timestamp();
+        header.flag = lease.flag();
+        header.nonce = lease.nonce_begin();
+        Target target = target_from_bytes(reinterpret_cast<const uint8_t*>(lease.target().data()));
+
+        const uint32_t begin = lease.nonce_begin();
+        const uint64_t count = lease.nonce_count();
+        auto start = std::chrono::steady_clock::now();
+        BatchPacer pacer(&throttle, nullptr, &full_rate);
+        progress.reset();
+
+        // Stop launching at the end of the range; a rejected solution restarts
+        // the pipeline, and progress sums hashes across runs
+        bool found = mine_block_verified(engine, &header, target, lease.expires_in_ms() / 1000.0f, verifier,
+            [&](const PipelineStats& stats) {
+                progress.observe(stats);
+                uint64_t launched = (uint32_t)(stats.next_nonce - begin) + (uint64_t)(slots - 1) * batch;
+                if (launched >= count) {
+                    return false;
+                }
+                // The reported rate includes the pauses, so leases are sized for the capped speed
+                pacer.pace(progress);
+                return true;
+            });
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        uint64_t hashes = progress.latest().hashes;
+        if (elapsed.count() > 0 && hashes > 0) {
+            double rate = hashes / elapsed.count();
+            hash_rate = hash_rate > 0 ? 0.5 * hash_rate + 0.5 * rate : rate;
+        }
+
+        miner::CompleteLeaseRequest complete;
+        complete.set_worker_id(worker_id);
+        complete.set_lease_id(lease.lease_id());
+        complete.set_hashes(hashes);
+        complete.set_elapsed_seconds(elapsed.count());
+        complete.set_found(found);
+        complete.set_nonce(header.nonce);
+        miner::CompleteLeaseResponse reply;
+        grpc::ClientContext complete_context;
+        complete_context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+        status = stub.CompleteLease(&complete_context, complete, &reply);
+        if (!status.ok()) {
+            LOG_WARNING("Worker {}: failed to complete lease {}: {}", worker_id, lease.lease_id(), status.error_message());
+        } else if (found) {
+            LOG_INFO("Worker {}: nonce {:08x} for job {}: {}", worker_id, header.nonce, lease.job_id(), reply.message());
+        }
+        LOG_DEBUG("Worker {}: lease {} done, {} hashes in {:.2f} s", worker_id, lease.lease_id(), hashes, elapsed.count());
+    }
+}
+
+int run_lease_worker(const MinerConfig& config, const std::string& coordinator, const std::string& worker_id) {
+    EnginePool pool;
+    if (config.cuda_engines > 0) {
+        pool.add_engines([] { return std::unique_ptr<MiningEngine>(new CudaEngine()); }, config.cuda_engines);
+    }
+    if (config.cpu_engines > 0) {
+        pool.add_engines([] { return std::unique_ptr<MiningEngine>(new CpuEngine()); }, config.cpu_engines);
+    }
+    if (pool.size() == 0) {
+        LOG_WARNING("No engine warmed up, falling back to one CPU engine");
+        pool.add_engines([] { return std::unique_ptr<MiningEngine>(new CpuEngine()); }, 1);
+    }
+
+    // One stub shared by every engine loop; gRPC stubs are thread-safe
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(coordinator, grpc::InsecureChannelCredentials());
+    std::unique_ptr<miner::LeaseCoordinator::Stub> stub = miner::LeaseCoordinator::NewStub(channel);
+    LOG_INFO("Worker {} mining leases from {} with {} engine(s)", worker_id, coordinator, pool.size());
+    if (config.engine_max_hash_rate > 0 || (config.engine_duty_cycle > 0 && config.engine_duty_cycle < 1)) {
+        LOG_INFO("Engines capped at {:.1f} MH/s, duty cycle {:.2f}", config.engine_max_hash_rate / 1e6,
+                 config.engine_duty_cycle);
+    }
+
+    std::vector<std::thread> loops;
+    for (size_t i = 0; i < pool.size(); i++) {
+        loops.emplace_back([&pool, &stub, &config, worker_id, i] {
+            EngineLease engine = pool.acquire(0);
+            if (engine) {
+                Throttle throttle;
+                throttle.set_limits(config.engine_max_hash_rate, config.engine_duty_cycle);
+                lease_loop(*stub, *engine, worker_id + "/" + std::to_string(i), throttle);
+            }
+        });
+    }
+    for (std::thread& loop : loops) {
+        loop.join();
+    }
+    return 0;
+}
@@ -0,0 +1,357 @@
+#include "log.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+std::atomic<int> g_log_level((int)LogSeverity::Info);
+
+static const size_t kLogQueueSize = 4096;  // Power of two
+
+// Bounded multi-producer queue (Vyukov): each cell's sequence number says
+// whether it is free for the producer at a position or ready for the writer
+struct LogCell {
+    LogRecord record;  // First member, log_commit maps a record back to its cell
+    std::atomic<size_t> sequence;
+    size_t position;
+};
+
+class Logger {
+public:
+    Logger()
+        : enqueue_pos_(0)
+        , dequeue_pos_(0)
+        , dropped_(0)
+        , stop_(false)
+        , file_(nullptr) {
+        cells_ = new LogCell[kLogQueueSize];
+        for (size_t i = 0; i < kLogQueueSize; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        writer_ = std::thread(&Logger::writer_loop, this);
+    }
+
+    LogRecord* claim() {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            LogCell& cell = cells_[pos & (kLogQueueSize - 1)];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.position = pos;
+                    return &cell.record;
+                }
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void commit(LogRecord* record) {
+        LogCell* cell = reinterpret_cast<LogCell*>(record);
+        cell->sequence.store(cell->position + 1, std::memory_order_release);
+    }
+
+    void flush() {
+        size_t target = enqueue_pos_.load(std::memory_order_acquire);
+        for (int i = 0; i < 1000 && dequeue_pos_.load(std::memory_order_acquire) < target; i++) {
+            wake_.notify_one();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void shutdown() {
+        flush();
+        stop_.store(true, std::memory_order_release);
+        wake_.notify_one();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+        set_file("");
+    }
+
+    bool set_file(const std::string& path) {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        if (file_) {
+            fclose(file_);
+            file_ = nullptr;
+        }
+        if (path.empty()) {
+            return true;
+        }
+        file_ = fopen(path.c_str(), "a");
+        return file_ != nullptr;
+    }
+
+    void count_dropped() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void writer_loop() {
+        std::string line;
+        for (;;) {
+            bool wrote = false;
+            for (;;) {
+                size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+                LogCell& cell = cells_[pos & (kLogQueueSize - 1)];
+                if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+                    break;
+                }
+                format(cell.record, &line);
+                write(cell.record.level, line);
+                cell.sequence.store(pos + kLogQueueSize, std::memory_order_release);
+                dequeue_pos_.store(pos + 1, std::memory_order_release);
+                wrote = true;
+            }
+            if (wrote) {
+                fflush(stdout);
+                fflush(stderr);
+                std::lock_guard<std::mutex> lock(file_mutex_);
+                if (file_) {
+                    fflush(file_);
+                }
+            }
+            if (stop_.load(std::memory_order_acquire)) {
+                return;
+            }
+            // Producers never signal; the writer polls so logging stays lock-free
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(5));
+        }
+    }
+
+    void write(LogSeverity level, const std::string& line) {
+        FILE* console = level >= LogSeverity::Warning ? stderr : stdout;
+        fwrite(line.data(), 1, line.size(), console);
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        if (file_) {
+            fwrite(line.data(), 1, line.size(), file_);
+        }
+    }
+
+    static void format_arg(const LogRecord& record, const LogArg& arg, const std::string& spec,
+                           std::string* out);
+    static void format(const LogRecord& record, std::string* line);
+
+    LogCell* cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) std::atomic<size_t> dequeue_pos_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<bool> stop_;
+    std::thread writer_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::mutex file_mutex_;
+    FILE* file_;
+};
+
+static const char* level_name(LogSeverity level) {
+    switch (level) {
+        case LogSeverity::Debug: return "DEBUG";
+        case LogSeverity::Info: return "INFO";
+        case LogSeverity::Warning: return "WARNING";
+        case LogSeverity::Error: return "ERROR";
+        default: return "LOG";
+    }
+}
+
+// spec is what follows ':' inside the braces: [>][0][width][.precision][x|f]
+void Logger::format_arg(const LogRecord& record, const LogArg& arg, const std::string& spec,
+                        std::string* out) {
+    bool zero = false;
+    int width = 0;
+    int precision = -1;
+    char type = 0;
+    size_t i = 0;
+    if (i < spec.size() && spec[i] == '>') {
+        i++;
+    }
+    if (i < spec.size() && spec[i] == '0') {
+        zero = true;
+        i++;
+    }
+    while (i < spec.size() && spec[i] >= '0' && spec[i] <= '9') {
+        width = width * 10 + (spec[i++] - '0');
+    }
+    if (i < spec.size() && spec[i] == '.') {
+        precision = 0;
+        i++;
+        while (i < spec.size() && spec[i] >= '0' && spec[i] <= '9') {
+            precision = precision * 10 + (spec[i++] - '0');
+        }
+    }
+    if (i < spec.size()) {
+        type = spec[i];
+    }
+
+    char buf[64];
+    switch (arg.type) {
+        case LogArg::kInt:
+            snprintf(buf, sizeof(buf), type == 'x' ? (zero ? "%0*llx" : "%*llx") : (zero ? "%0*lld" : "%*lld"),
+                     width, (long long)arg.i);
+            out->append(buf);
+            break;
+        case LogArg::kUint:
+            snprintf(buf, sizeof(buf), type == 'x' ? (zero ? "%0*llx" : "%*llx") : (zero ? "%0*llu" : "%*llu"),
+                     width, (unsigned long long)arg.u);
+            out->append(buf);
+            break;
+        case LogArg::kDouble:
+            if (precision >= 0) {
+                snprintf(buf, sizeof(buf), "%*.*f", width, precision, arg.d);
+            } else {
+                snprintf(buf, sizeof(buf), "%*g", width, arg.d);
+            }
+            out->append(buf);
+            break;
+        case LogArg::kText:
+            if (arg.text.length < (uint16_t)width) {
+                out->append(width - arg.text.length, ' ');
+            }
+            out->append(record.text + arg.text.offset, arg.text.length);
+            break;
+    }
+}
+
+void Logger::format(const LogRecord& record, std::string* line) {
+    line->clear();
+
+    std::time_t seconds = std::chrono::system_clock::to_time_t(record.time);
+    int millis = (int)(std::chrono::duration_cast<std::chrono::milliseconds>(
+        record.time.time_since_epoch()).count() % 1000);
+    std::tm local;
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char prefix[64];
+    size_t n = strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &local);
+    snprintf(prefix + n, sizeof(prefix) - n, ".%03d [%s] [t%u] ", millis, level_name(record.level), record.thread);
+    line->append(prefix);
+
+    size_t next_arg = 0;
+    for (const char* p = record.format; *p; p++) {
+        if (*p == '{' && p[1] == '{') {
+            line->push_back('{');
+            p++;
+        } else if (*p == '}' && p[1] == '}') {
+            line->push_back('}');
+            p++;
+        } else if (*p == '{') {
+            const char* close = strchr(p, '}');
+            if (!close) {
+                line->append(p);
+                break;
+            }
+            std::string spec = p[1] == ':' ? std::string(p + 2, close) : std::string();
+            if (next_arg < record.argc) {
+                format_arg(record, record.args[next_arg++], spec, line);
+            }
+            p = close;
+        } else {
+            line->push_back(*p);
+        }
+    }
+    line->push_back('\n');
+}
+
+// Never destroyed: threads may still log while static destructors run
+static Logger& logger() {
+    static Logger* instance = [] {
+        Logger* created = new Logger();
+        std::atexit([] { logger().shutdown(); });
+        return created;
+    }();
+    return *instance;
+}
+
+static uint32_t log_thread_id() {
+    static std::atomic<uint32_t> next_id(1);
+    thread_local uint32_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+LogRecord* log_claim() {
+    LogRecord* record = logger().claim();
+    if (record) {
+        record->time = std::chrono::system_clock::now();
+        record->thread = log_thread_id();
+    }
+    return record;
+}
+
+void log_commit(LogRecord* record) {
+    logger().commit(record);
+}
+
+void log_set_level(LogSeverity level) {
+    g_log_level.store((int)level, std::memory_order_relaxed);
+}
+
+LogSeverity log_level() {
+    return (LogSeverity)g_log_level.load(std::memory_order_relaxed);
+}
+
+bool log_parse_level(const std::string& name, LogSeverity* level) {
+    if (name == "debug") {
+        *level = LogSeverity::Debug;
+    } else if (name == "info") {
+        *level = LogSeverity::Info;
+    } else if (name == "warning") {
+        *level = LogSeverity::Warning;
+    } else if (name == "error") {
+        *level = LogSeverity::Error;
+    } else if (name == "off") {
+        *level = LogSeverity::Off;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool log_set_file(const std::string& path) {
+    return logger().set_file(path);
+}
+
+bool log_configure(const std::string& name, const std::string& file) {
+    LogSeverity level;
+    bool known = log_parse_level(name, &level);
+    if (known) {
+        log_set_level(level);
+    } else {
+        LOG_WARNING("Unknown log level '{}', keeping {}", name, level_name(log_level()));
+    }
+    if (!file.empty() && !log_set_file(file)) {
+        LOG_ERROR("Failed to open log file: {}", file);
+    }
+    return known;
+}
+
+void log_flush() {
+    logger().flush();
+}
+
+uint64_t log_dropped() {
+    return logger().dropped();
+}
+
+bool LogRateLimiter::allow() {
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t window = window_.load(std::memory_order_relaxed);
+    if (window != now && window_.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+        count_.store(0, std::memory_order_relaxed);
+    }
+    if (count_.fetch_add(1, std::memory_order_relaxed) < max_per_second_) {
+        return true;
+    }
+    logger().count_dropped();
+    return false;
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Asynchronous leveled logging. Call sites capture their arguments into a
+// fixed-size record on a lock-free queue; a background thread formats and
+// writes them, so the caller never formats, allocates or touches the console.
+// When the queue is full records are dropped (and counted) rather than block.
+//
+//   LOG_INFO("Session {} found nonce {:08x}", session_id, nonce);
+//
+// Placeholders are {} with an optional spec: {:x}, {:08x}, {:.2f}, {:>8}.
+// The format string must be a literal. Strings are copied into the record
+// (up to kLogTextBytes in total per record), numbers are stored as-is.
+
+enum class LogSeverity : int {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+    Off = 4
+};
+
+// Levels below this are compiled out entirely
+#ifndef MINER_LOG_MIN_LEVEL
+#define MINER_LOG_MIN_LEVEL 0
+#endif
+
+static const size_t kLogMaxArgs = 8;
+static const size_t kLogTextBytes = 384;
+
+struct LogArg {
+    enum Type : uint8_t { kInt, kUint, kDouble, kText };
+    Type type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        struct {
+            uint16_t offset;
+            uint16_t length;
+        } text;
+    };
+};
+
+struct LogRecord {
+    LogSeverity level;
+    const char* format;
+    std::chrono::system_clock::time_point time;
+    uint32_t thread;
+    uint8_t argc;
+    uint16_t text_used;
+    LogArg args[kLogMaxArgs];
+    char text[kLogTextBytes];
+};
+
+extern std::atomic<int> g_log_level;
+
+inline bool log_enabled(LogSeverity level) {
+    return (int)level >= g_log_level.load(std::memory_order_relaxed);
+}
+
+void log_set_level(LogSeverity level);
+LogSeverity log_level();
+
+// "debug", "info", "warning", "error", "off"; false if the name is unknown
+bool log_parse_level(const std::string& name, LogSeverity* level);
+
+// Also append formatted lines to a file (empty path closes it)
+bool log_set_file(const std::string& path);
+
+// Applies config values; false (and level left unchanged) if the level is unknown
+bool log_configure(const std::string& name, const std::string& file);
+
+// Wait until everything queued so far has been written
+void log_flush();
+
+// Records dropped because the queue was full or a rate limit was hit
+uint64_t log_dropped();
+
+// Queue slot for the calling thread, or null when the queue is full
+LogRecord* log_claim();
+void log_commit(LogRecord* record);
+
+// Argument capture into a claimed record
+inline void log_capture_text(LogRecord* record, const char* text, size_t length) {
+    LogArg& arg = record->args[record->argc++];
+    size_t room = kLogTextBytes - record->text_used;
+    if (length > room) {
+        length = room;
+    }
+    memcpy(record->text + record->text_used, text, length);
+    arg.type = LogArg::kText;
+    arg.text.offset = record->text_used;
+    arg.text.length = (uint16_t)length;
+    record->text_used += (uint16_t)length;
+}
+
+inline void log_capture(LogRecord* record, const char* value) {
+    if (!value) {
+        value = "(null)";
+    }
+    log_capture_text(record, value, strlen(value));
+}
+
+inline void log_capture(LogRecord* record, const std::string& value) {
+    log_capture_text(record, value.data(), value.size());
+}
+
+inline void log_capture(LogRecord* record, bool value) {
+    log_capture(record, value ? "true" : "false");
+}
+
+inline void log_capture(LogRecord* record, char value) {
+    log_capture_text(record, &value, 1);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+log_capture(LogRecord* record, T value) {
+    LogArg& arg = record->args[record->argc++];
+    arg.type = LogArg::kInt;
+    arg.i = value;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+log_capture(LogRecord* record, T value) {
+    LogArg& arg = record->args[record->argc++];
+    arg.type = LogArg::kUint;
+    arg.u = value;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+log_capture(LogRecord* record, T value) {
+    LogArg& arg = record->args[record->argc++];
+    arg.type = LogArg::kDouble;
+    arg.d = value;
+}
+
+inline void log_capture_all(LogRecord*) {}
+
+template <typename T, typename... Rest>
+inline void log_capture_all(LogRecord* record, const T& value, const Rest&... rest) {
+    log_capture(record, value);
+    log_capture_all(record, rest...);
+}
+
+template <typename... Args>
+void log_write(LogSeverity level, const char* format, const Args&... args) {
+    static_assert(sizeof...(Args) <= kLogMaxArgs, "Too many log arguments");
+    LogRecord* record = log_claim();
+    if (!record) {
+        return;
+    }
+    record->level = level;
+    record->format = format;
+    record->argc = 0;
+    record->text_used = 0;
+    log_capture_all(record, args...);
+    log_commit(record);
+}
+
+// Allows max_per_second records per call site, drops (and counts) the rest
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(uint32_t max_per_second)
+        : max_per_second_(max_per_second)
+        , window_(0)
+        , count_(0) {}
+
+    bool allow();
+
+private:
+    uint32_t max_per_second_;
+    std::atomic<int64_t> window_;
+    std::atomic<uint32_t> count_;
+};
+
+#define MINER_LOG(level, ...)                                                           \
+    do {                                                                                \
+        if ((int)(level) >= MINER_LOG_MIN_LEVEL && log_enabled(level)) {                \
+            log_write(level, __VA_ARGS__);                                              \
+        }                                                                               \
+    } while (0)
+
+#define MINER_LOG_RATE_LIMITED(level, max_per_second, ...)                              \
+    do {                                                                                \
+        if ((int)(level) >= MINER_LOG_MIN_LEVEL && log_enabled(level)) {                \
+            static LogRateLimiter log_limiter_(max_per_second);                         \
+            if (log_limiter_.allow()) {                                                 \
+                log_write(level, __VA_ARGS__);                                          \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+
+#define LOG_DEBUG(...) MINER_LOG(LogSeverity::Debug, __VA_ARGS__)
+#define LOG_INFO(...) MINER_LOG(LogSeverity::Info, __VA_ARGS__)
+#define LOG_WARNING(...) MINER_LOG(LogSeverity::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) MINER_LOG(LogSeverity::Error, __VA_ARGS__)
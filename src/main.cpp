@@ -2,11 +2,16 @@
 #include <iomanip>
 #include <string>
 #include <cstdint>
+#include <cstdio>
+#include <random>
 #include <thread>
 #include <grpcpp/grpcpp.h>
 #include "miner.cuh"
 #include "miner_service.h"
 #include "hash_writer.hpp"
+#include "log.hpp"
+#include "lease_coordinator.hpp"
+#include "http_gateway.hpp"
 
 void print_usage() {
     std::cout << "Bitcoin Miner\n";
@@ -24,22 +29,6 @@ void print_usage() {
     std::cout << "  --server         Start RPC server on specified port\n";
 }
 
-// Helper function to convert hex string to bytes
-bool hex_to_bytes(const std::string& hex, uint8_t* bytes, size_t expected_length) {
-    if (hex.length() != expected_length * 2) {
-        return false;
-    }
-    try {
-        for (size_t i = 0; i < hex.length(); i += 2) {
-            std::string byteString = hex.substr(i, 2);
-            bytes[i/2] = static_cast<uint8_t>(std::stoi(byteString, nullptr, 16));
-        }
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
 // Generate random bytes
 void generate_random_bytes(uint8_t* buffer, size_t length) {
     std::random_device rd;
@@ -54,20 +43,31 @@ void generate_random_bytes(uint8_t* buffer, size_t length) {
 void RunServer(uint16_t port, const MinerConfig& config) {
     std::string server_address = "0.0.0.0:" + std::to_string(port);
     
-    std::cout << "\nStarting server with configuration:" << std::endl;
-    std::cout << "RPC Host: " << config.rpc_host << std::endl;
-    std::cout << "RPC Port: " << config.rpc_port << std::endl;
-    std::cout << "RPC User: " << config.rpc_user << std::endl;
-    std::cout << "Auto Broadcast: " << (config.auto_broadcast ? "true" : "false") << std::endl;
+    log_configure(config.log_level, config.log_file);
+    LOG_INFO("Starting server with configuration: RPC host {}, RPC port {}, RPC user {}, auto broadcast {}",
+             config.rpc_host, config.rpc_port, config.rpc_user, config.auto_broadcast);
     
     MinerServiceImpl service(config);
     
     grpc::ServerBuilder builder;
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
     builder.RegisterService(&service);
+    if (service.coordinator_service()) {
+        builder.RegisterService(service.coordinator_service());
+    }
     
     std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
-    std::cout << "Server listening on " << server_address << std::endl;
+    LOG_INFO("Server listening on {}", server_address);
+    
+    // REST clients skip the Python gateway and its extra hop
+    HttpGateway gateway(service);
+    if (config.http_port > 0) {
+        if (gateway.start("0.0.0.0", (uint16_t)config.http_port, config.http_threads)) {
+            LOG_INFO("REST gateway listening on 0.0.0.0:{}", config.http_port);
+        } else {
+            LOG_ERROR("Failed to start REST gateway on port {}", config.http_port);
+        }
+    }
     server->Wait();
 }
 
@@ -83,11 +83,20 @@ void PrintUsage() {
     std::cout << "  --rpc-user <user>     Bitcoin RPC username (overrides config)\n";
     std::cout << "  --rpc-pass <pass>     Bitcoin RPC password (overrides config)\n";
     std::cout << "  --no-broadcast        Disable auto-broadcasting of solutions\n";
+    std::cout << "  --trace <file>        Record pipeline spans to a Chrome trace JSON file\n";
+    std::cout << "  --log-level <level>   debug, info, warning, error or off (overrides config)\n";
+    std::cout << "  --log-file <file>     Also append log lines to this file (overrides config)\n";
+    std::cout << "  --coordinator         Lease jobs started on this server to worker processes\n";
+    std::cout << "  --worker <host:port>  Mine nonce ranges leased by a coordinator (no --server needed)\n";
+    std::cout << "  --worker-id <name>    Worker name reported to the coordinator (default: worker-<random>)\n";
+    std::cout << "  --host-leases <file>  Share nonce ranges with other servers on this host through a lease file\n";
+    std::cout << "  --http <port>         Serve the REST endpoints natively on this port\n";
 }
 
 int main(int argc, char* argv[]) {
     std::vector<std::string> args(argv + 1, argv + argc);
     uint16_t server_port = 0;
+    std::string coordinator_address;
     
     // Get the executable directory
     std::string exe_path = argv[0];
@@ -109,9 +118,12 @@ int main(int argc, char* argv[]) {
             // If config path is provided, use it as is
             config_path = args[++i];
         }
+        else if (args[i] == "--worker" && i + 1 < args.size()) {
+            coordinator_address = args[++i];
+        }
     }
     
-    if (server_port == 0) {
+    if (server_port == 0 && coordinator_address.empty()) {
         std::cerr << "Error: Server port must be specified\n";
         PrintUsage();
         return 1;
@@ -125,6 +137,7 @@ int main(int argc, char* argv[]) {
     // Load config and override with command line arguments
     std::cout << "Loading config from: " << config_path << std::endl;
     MinerConfig config = MinerConfig::fromFile(config_path);
+    std::string worker_id;
     
     for (size_t i = 0; i < args.size(); i++) {
         if (args[i] == "--rpc-host" && i + 1 < args.size()) {
@@ -142,12 +155,45 @@ int main(int argc, char* argv[]) {
         else if (args[i] == "--no-broadcast") {
             config.auto_broadcast = false;
         }
+        else if (args[i] == "--trace" && i + 1 < args.size()) {
+            config.trace_file = args[++i];
+        }
+        else if (args[i] == "--log-level" && i + 1 < args.size()) {
+            config.log_level = args[++i];
+        }
+        else if (args[i] == "--log-file" && i + 1 < args.size()) {
+            config.log_file = args[++i];
+        }
+        else if (args[i] == "--coordinator") {
+            config.coordinator = true;
+        }
+        else if (args[i] == "--worker-id" && i + 1 < args.size()) {
+            worker_id = args[++i];
+        }
+        else if (args[i] == "--host-leases" && i + 1 < args.size()) {
+            config.host_lease_file = args[++i];
+        }
+        else if (args[i] == "--http" && i + 1 < args.size()) {
+            config.http_port = std::stoi(args[++i]);
+        }
     }
     
     try {
+        if (!coordinator_address.empty()) {
+            if (worker_id.empty()) {
+                uint8_t id_bytes[4];
+                generate_random_bytes(id_bytes, sizeof(id_bytes));
+                char id_hex[9];
+                snprintf(id_hex, sizeof(id_hex), "%02x%02x%02x%02x", id_bytes[0], id_bytes[1], id_bytes[2], id_bytes[3]);
+                worker_id = std::string("worker-") + id_hex;
+            }
+            log_configure(config.log_level, config.log_file);
+            return run_lease_worker(config, coordinator_address, worker_id);
+        }
         RunServer(server_port, config);
     } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+        LOG_ERROR("Error: {}", e.what());
+        log_flush();
         return 1;
     }
     
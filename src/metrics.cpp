@@ -0,0 +1,205 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+static const double kSumScale = 1e9;  // Histogram sums are kept in nanoseconds
+
+size_t metric_shard_index() {
+    static std::atomic<size_t> next_shard(0);
+    thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return shard;
+}
+
+std::string metric_label(const std::string& key, const std::string& value) {
+    std::string label = key + "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            label += '\\';
+            label += c;
+        } else if (c == '\n') {
+            label += "\\n";
+        } else {
+            label += c;
+        }
+    }
+    label += '"';
+    return label;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < kMetricShards; i++) {
+        total += shards_[i].value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+Histogram::Histogram(const std::vector<double>& bounds)
+    : bounds_(bounds) {
+    // bounds + 1 buckets, then count and sum, rounded up to whole cache lines
+    const size_t cells_per_line = 64 / sizeof(std::atomic<uint64_t>);
+    stride_ = ((bounds_.size() + 3 + cells_per_line - 1) / cells_per_line) * cells_per_line;
+    cells_.reset(new std::atomic<uint64_t>[stride_ * kMetricShards]);
+    for (size_t i = 0; i < stride_ * kMetricShards; i++) {
+        cells_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double seconds) {
+    size_t bucket = 0;
+    while (bucket < bounds_.size() && seconds > bounds_[bucket]) {
+        bucket++;
+    }
+    std::atomic<uint64_t>* shard = &cells_[metric_shard_index() * stride_];
+    const size_t buckets = bounds_.size() + 1;
+    shard[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard[buckets].fetch_add(1, std::memory_order_relaxed);
+    shard[buckets + 1].fetch_add((uint64_t)std::llround(std::max(seconds, 0.0) * kSumScale),
+                                 std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    const size_t buckets = bounds_.size() + 1;
+    Snapshot snap;
+    snap.bounds = bounds_;
+    snap.counts.assign(buckets, 0);
+    snap.count = 0;
+    uint64_t sum = 0;
+    for (size_t s = 0; s < kMetricShards; s++) {
+        const std::atomic<uint64_t>* shard = &cells_[s * stride_];
+        for (size_t b = 0; b < buckets; b++) {
+            snap.counts[b] += shard[b].load(std::memory_order_relaxed);
+        }
+        snap.count += shard[buckets].load(std::memory_order_relaxed);
+        sum += shard[buckets + 1].load(std::memory_order_relaxed);
+    }
+    for (size_t b = 1; b < buckets; b++) {
+        snap.counts[b] += snap.counts[b - 1];
+    }
+    snap.sum = sum / kSumScale;
+    return snap;
+}
+
+std::vector<double> Histogram::exponential_bounds(double start, double factor, size_t count) {
+    std::vector<double> bounds;
+    double bound = start;
+    for (size_t i = 0; i < count; i++) {
+        bounds.push_back(bound);
+        bound *= factor;
+    }
+    return bounds;
+}
+
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help,
+                                                 const char* type) {
+    Family& fam = families_[name];
+    if (fam.type.empty()) {
+        fam.help = help;
+        fam.type = type;
+    } else if (fam.type != type) {
+        throw std::logic_error("Metric " + name + " already registered as " + fam.type);
+    }
+    return fam;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                  const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& series = family(name, help, "counter").series[labels];
+    if (!series.counter) {
+        series.counter.reset(new Counter());
+    }
+    return *series.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                              const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& series = family(name, help, "gauge").series[labels];
+    if (!series.gauge) {
+        series.gauge.reset(new Gauge());
+    }
+    return *series.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::string& labels, const std::vector<double>& bounds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& series = family(name, help, "histogram").series[labels];
+    if (!series.histogram) {
+        series.histogram.reset(new Histogram(bounds));
+    }
+    return *series.histogram;
+}
+
+static std::string join_labels(const std::string& labels, const std::string& extra) {
+    if (labels.empty()) {
+        return extra;
+    }
+    return extra.empty() ? labels : labels + "," + extra;
+}
+
+static std::string format_double(double value, const char* format) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), format, value);
+    return buf;
+}
+
+void MetricsRegistry::append_samples(const std::string& name, const Family& family,
+                                     std::vector<MetricSample>* samples) {
+    for (const auto& entry : family.series) {
+        const std::string& labels = entry.first;
+        const Series& series = entry.second;
+        if (series.counter) {
+            samples->push_back({name, labels, (double)series.counter->value()});
+        } else if (series.gauge) {
+            samples->push_back({name, labels, (double)series.gauge->value()});
+        } else if (series.histogram) {
+            Histogram::Snapshot snap = series.histogram->snapshot();
+            for (size_t b = 0; b < snap.counts.size(); b++) {
+                std::string le = b < snap.bounds.size() ? format_double(snap.bounds[b], "%g") : "+Inf";
+                samples->push_back({name + "_bucket", join_labels(labels, metric_label("le", le)),
+                                    (double)snap.counts[b]});
+            }
+            samples->push_back({name + "_sum", labels, snap.sum});
+            samples->push_back({name + "_count", labels, (double)snap.count});
+        }
+    }
+}
+
+std::vector<MetricSample> MetricsRegistry::collect() const {
+    std::vector<MetricSample> samples;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : families_) {
+        append_samples(entry.first, entry.second, &samples);
+    }
+    return samples;
+}
+
+std::string MetricsRegistry::render_text() const {
+    std::ostringstream out;
+    std::vector<MetricSample> samples;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : families_) {
+        out << "# HELP " << entry.first << " " << entry.second.help << "\n";
+        out << "# TYPE " << entry.first << " " << entry.second.type << "\n";
+        samples.clear();
+        append_samples(entry.first, entry.second, &samples);
+        for (const MetricSample& sample : samples) {
+            out << sample.name;
+            if (!sample.labels.empty()) {
+                out << "{" << sample.labels << "}";
+            }
+            out << " " << format_double(sample.value, "%.16g") << "\n";
+        }
+    }
+    return out.str();
+}
+
+MetricsRegistry& miner_metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
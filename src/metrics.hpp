@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Recording is lock-free: counters and histograms are split into shards and
+// each thread writes to its own shard, so hot paths (the pipeline's batch
+// boundary) never contend. Shards are only summed when metrics are read.
+static const size_t kMetricShards = 16;
+
+// Shard owned by the calling thread
+size_t metric_shard_index();
+
+// Prometheus label text, e.g. metric_label("engine", "cuda") -> engine="cuda"
+std::string metric_label(const std::string& key, const std::string& value);
+
+class Counter {
+public:
+    void add(uint64_t n = 1) {
+        shards_[metric_shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards_[kMetricShards];
+};
+
+class Gauge {
+public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Fixed-bucket histogram of durations in seconds
+class Histogram {
+public:
+    struct Snapshot {
+        std::vector<double> bounds;    // Upper bound per bucket (+Inf bucket implied)
+        std::vector<uint64_t> counts;  // Cumulative count per bucket, +Inf last
+        uint64_t count;
+        double sum;
+    };
+
+    explicit Histogram(const std::vector<double>& bounds);
+
+    void observe(double seconds);
+    Snapshot snapshot() const;
+
+    // start, start * factor, ... (count bounds)
+    static std::vector<double> exponential_bounds(double start, double factor, size_t count);
+
+private:
+    std::vector<double> bounds_;
+    size_t stride_;  // Cells per shard: buckets, count, sum; padded to a cache line
+    std::unique_ptr<std::atomic<uint64_t>[]> cells_;
+};
+
+struct MetricSample {
+    std::string name;    // Sample name (histograms add _bucket, _sum, _count)
+    std::string labels;  // Prometheus label text without braces
+    double value;
+};
+
+// Named metric families with optional labels. Lookups take a lock, so
+// callers fetch their metrics once (per job, per engine) and keep the
+// references; the returned objects live as long as the registry.
+class MetricsRegistry {
+public:
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels,
+                         const std::vector<double>& bounds);
+
+    std::vector<MetricSample> collect() const;
+
+    // Prometheus text exposition format
+    std::string render_text() const;
+
+private:
+    struct Series {
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+    struct Family {
+        std::string help;
+        std::string type;
+        std::map<std::string, Series> series;  // Keyed by label text
+    };
+
+    Family& family(const std::string& name, const std::string& help, const char* type);
+    static void append_samples(const std::string& name, const Family& family,
+                               std::vector<MetricSample>* samples);
+
+    std::map<std::string, Family> families_;
+    mutable std::mutex mutex_;
+};
+
+// Process-wide registry shared by the engines, service and RPC client
+MetricsRegistry& miner_metrics();
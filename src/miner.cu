@@ -1,6 +1,13 @@
 #include "miner.cuh"
+#include "support_ticket.hpp"
+#include "sha256_host.hpp"
+#include "cuda_engine.hpp"
+#include "mining_pipeline.hpp"
+#include "log.hpp"
+#include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
 #include <iostream>
 #include <iomanip>
 #include <stdio.h>
@@ -15,25 +22,43 @@ __device__ __host__ __inline__ uint32_t swap32(uint32_t val) {
            ((val & 0xff000000) >> 24);
 }
 
-// Parse target hash string into Target structure
-__host__ Target parse_target_hash(const char* target_str) {
+// Parse a 64-character hex target; false, target untouched, if malformed
+__host__ bool parse_target_hash(const char* target_str, Target* target) {
+    // Convert hex string to bytes, 8 words of 4 bytes each
+    uint8_t bytes[32];
+    if (!hex_to_bytes(target_str, bytes, sizeof(bytes))) {
+        return false;
+    }
+    
+    *target = target_from_bytes(bytes);
+    return true;
+}
+
+// Build a Target from 32 big-endian bytes
+__host__ Target target_from_bytes(const uint8_t* bytes) {
     Target target;
     
-    // Convert hex string to bytes, 8 words of 4 bytes each
+    // Store each word in big-endian format for comparison
     for (int i = 0; i < 8; i++) {
-        char word[9];  // 8 chars + null terminator
-        strncpy(word, target_str + (i * 8), 8);
-        word[8] = '\0';
-        
-        // Convert hex string to uint32_t and store in big-endian format
-        uint32_t value;
-        sscanf(word, "%x", &value);
-        target.words[i] = value;  // Keep in big-endian for comparison
+        target.words[i] = ((uint32_t)bytes[i*4] << 24) |
+                          ((uint32_t)bytes[i*4 + 1] << 16) |
+                          ((uint32_t)bytes[i*4 + 2] << 8) |
+                          (uint32_t)bytes[i*4 + 3];
     }
     
     return target;
 }
 
+// Write a Target as 32 big-endian bytes
+__host__ void target_to_bytes(const Target& target, uint8_t* bytes) {
+    for (int i = 0; i < 8; i++) {
+        bytes[i*4] = (uint8_t)(target.words[i] >> 24);
+        bytes[i*4 + 1] = (uint8_t)(target.words[i] >> 16);
+        bytes[i*4 + 2] = (uint8_t)(target.words[i] >> 8);
+        bytes[i*4 + 3] = (uint8_t)target.words[i];
+    }
+}
+
 // Convert compact target format to actual target
 __host__ Target decode_compact_target(uint32_t compact) {
     Target target = {0};
@@ -176,203 +201,62 @@ __device__ void sha256_transform(uint32_t* state, const uint32_t* block) {
     state[7] += h;
 }
 
-__global__ void sha256_gpu(MiningHeader* header, uint8_t* output, Target target, uint32_t* found) {
+// Per-job constants, uploaded once by CudaEngine::set_job
+struct DeviceJob {
+    uint32_t midstate[8];   // State after the nonce-independent blocks
+    uint32_t tail[16];      // Last message block, nonce word patched per thread
+    uint32_t target[8];     // Big-endian target words
+};
+
+// Per-slot result in pinned, device-mapped host memory
+struct DeviceResult {
+    uint32_t found;
+    uint32_t nonce;
+    uint32_t hash[8];       // Display word order
+};
+
+__global__ void sha256_gpu(const DeviceJob* __restrict__ job, uint32_t base_nonce, DeviceResult* result) {
     uint32_t tid = blockDim.x * blockIdx.x + threadIdx.x;
+    uint32_t nonce = base_nonce + tid;
     
-    // Create a local copy of the header and update nonce
-    MiningHeader local_header = *header;
-    local_header.nonce = header->nonce + tid;
+    // Only the last block depends on the nonce (stored little-endian in the ticket)
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++) {
+        w[i] = job->tail[i];
+    }
+    w[TicketLayout::kTailNonceWord] = swap32(nonce);
 
-    // First SHA-256 hash
+    // First SHA-256 hash, resumed from the job midstate
     uint32_t state[8];
-    uint8_t bytes[64] = {0};  // Changed to byte array
-    memcpy(state, sha256_init_state, sizeof(state));
-    
-    // if (tid == 0) {
-    //     printf("\nAttempting new batch with base nonce: %08x\n", header->nonce);
-    //     printf("Thread 0 nonce: %08x\n", local_header.nonce);
-    // }
-    
-    // Build block data in big-endian format for SHA-256
-    uint32_t pos = 0;
-    
-    // Hash (variable length) with length prefix
-    bytes[pos++] = local_header.hash_length;  // Variable length prefix
-    for (int i = 0; i < local_header.hash_length; i++) {
-        bytes[pos++] = local_header.hash[i];
-    }
-    
-    // Address1 (20 bytes) with length prefix
-    bytes[pos++] = 0x14;  // Length prefix (20)
-    for (int i = 0; i < 20; i++) {
-        bytes[pos++] = local_header.address1[i];
-    }
-    
-    // Value (block height) - 4 bytes little-endian
-    bytes[pos++] = local_header.value & 0xFF;           // Lowest byte
-    bytes[pos++] = (local_header.value >> 8) & 0xFF;    // Low byte
-    bytes[pos++] = (local_header.value >> 16) & 0xFF;   // High byte
-    bytes[pos++] = (local_header.value >> 24) & 0xFF;   // Highest byte
-    
-    // Address2 (20 bytes) with length prefix
-    bytes[pos++] = 0x14;  // Length prefix (20)
-    for (int i = 0; i < 20; i++) {
-        bytes[pos++] = local_header.address2[i];
-    }
-    
-    // Flag byte - should be 0 or 1
-    bytes[pos++] = local_header.flag;
-    
-    // Timestamp (4 bytes in little-endian)
-    bytes[pos++] = local_header.timestamp & 0xFF;
-    bytes[pos++] = (local_header.timestamp >> 8) & 0xFF;
-    bytes[pos++] = (local_header.timestamp >> 16) & 0xFF;
-    bytes[pos++] = (local_header.timestamp >> 24) & 0xFF;
-    
-    // Nonce (4 bytes in little-endian)
-    bytes[pos++] = local_header.nonce & 0xFF;
-    bytes[pos++] = (local_header.nonce >> 8) & 0xFF;
-    bytes[pos++] = (local_header.nonce >> 16) & 0xFF;
-    bytes[pos++] = (local_header.nonce >> 24) & 0xFF;
-    
-    /*if (tid == 0) {
-        printf("\nBlock data before padding:\n");
-        printf("Block length: %u bytes\n", pos);
-        printf("Raw bytes in hex:\n");
-        for (int i = 0; i < pos; i++) {
-            printf("%02x", bytes[i]);
-            if ((i + 1) % 32 == 0) printf("\n");
-        }
-        printf("\n\n");
-        
-        printf("Nonce position (bytes %d-%d): ", pos-4, pos-1);
-        for (int i = pos-4; i < pos; i++) {
-            printf("%02x", bytes[i]);
-        }
-        printf(" (nonce value: %08x)\n", local_header.nonce);
-    }*/
-    
-    // Add padding
-    uint32_t original_pos = pos;
-    bytes[pos++] = 0x80;  // Padding bit
-    
-    // Fill with zeros until we have room for the length
-    while ((pos % 64) != 56) {  // 56 = 64 - 8 (for length)
-        bytes[pos++] = 0;
-    }
-    
-    // Add message length in bits as big-endian
-    uint64_t total_bits = (uint64_t)original_pos * 8;
-    bytes[pos++] = (total_bits >> 56) & 0xFF;
-    bytes[pos++] = (total_bits >> 48) & 0xFF;
-    bytes[pos++] = (total_bits >> 40) & 0xFF;
-    bytes[pos++] = (total_bits >> 32) & 0xFF;
-    bytes[pos++] = (total_bits >> 24) & 0xFF;
-    bytes[pos++] = (total_bits >> 16) & 0xFF;
-    bytes[pos++] = (total_bits >> 8) & 0xFF;
-    bytes[pos++] = total_bits & 0xFF;
-    
-    /*if (tid == 0) {
-        printf("Block data after padding (hex):\n");
-        for (int i = 0; i < pos; i++) {
-            printf("%02x", bytes[i]);
-            if ((i + 1) % 64 == 0) printf("\n");
-        }
-        printf("\n");
-        printf("Total length: %d bytes (%d bits)\n", pos, pos * 8);
-    }*/
-    
-    // Process each 64-byte (512-bit) chunk
-    for (uint32_t chunk = 0; chunk < pos; chunk += 64) {
-        uint32_t w[64] = {0};
-        
-        // Copy chunk into first 16 words
-        for (int i = 0; i < 16; i++) {
-            w[i] = (bytes[chunk + i*4] << 24) |
-                   (bytes[chunk + i*4 + 1] << 16) |
-                   (bytes[chunk + i*4 + 2] << 8) |
-                   bytes[chunk + i*4 + 3];
-        }
-        
-        /*if (tid == 0 && chunk == 0) {
-            printf("First 16 words of first chunk:\n");
-            for (int i = 0; i < 16; i++) {
-                printf("%08x ", w[i]);
-                if ((i + 1) % 8 == 0) printf("\n");
-            }
-            printf("\n");
-        }*/
-        
-        sha256_transform(state, w);
+    for (int i = 0; i < 8; i++) {
+        state[i] = job->midstate[i];
     }
     
-    /*if (tid == 0) {
-        printf("First SHA-256 state:\n");
-        for (int i = 0; i < 8; i++) {
-            printf("%08x ", state[i]);
-        }
-        printf("\n");
-    }*/
+    sha256_transform(state, w);
     
-    // Second SHA-256 hash
+    // Second SHA-256 hash over the 32-byte digest (padding and length 256 bits are fixed)
     uint32_t final_state[8];
     memcpy(final_state, sha256_init_state, sizeof(final_state));
     
-    // Prepare block for second hash
-    uint8_t final_bytes[64] = {0};  // Changed to byte array
-    
-    // Copy first hash result
+    uint32_t final_w[16];
     for (int i = 0; i < 8; i++) {
-        final_bytes[i*4] = (state[i] >> 24) & 0xFF;
-        final_bytes[i*4 + 1] = (state[i] >> 16) & 0xFF;
-        final_bytes[i*4 + 2] = (state[i] >> 8) & 0xFF;
-        final_bytes[i*4 + 3] = state[i] & 0xFF;
+        final_w[i] = state[i];
     }
-    
-    // Add padding for second hash
-    final_bytes[32] = 0x80;  // Padding bit after 32 bytes
-    // Length is 256 bits = 0x100
-    final_bytes[62] = 0x01;  // Upper byte of 0x100
-    final_bytes[63] = 0x00;  // Lower byte of 0x100
-    
-    // Convert to words for transform
-    uint32_t final_w[16] = {0};
-    for (int i = 0; i < 16; i++) {
-        final_w[i] = (final_bytes[i*4] << 24) |
-                     (final_bytes[i*4 + 1] << 16) |
-                     (final_bytes[i*4 + 2] << 8) |
-                     final_bytes[i*4 + 3];
+    final_w[8] = 0x80000000;
+    for (int i = 9; i < 15; i++) {
+        final_w[i] = 0;
     }
+    final_w[15] = 256;
     
     sha256_transform(final_state, final_w);
     
-    /*if (tid == 0) {
-        printf("Final SHA-256 state (before endian swap):\n");
-        for (int i = 0; i < 8; i++) {
-            printf("%08x ", final_state[i]);
-        }
-        printf("\n");
-    }*/
-    
     // Compare hash with target (both in big-endian)
     bool valid = true;
-    /*if (tid == 0) {
-        printf("Comparing hash with target:\n");
-        printf("Hash:   ");
-        for (int i = 7; i >= 0; i--) {
-            printf("%08x", swap32(final_state[i]));  // Keep word in little-endian
-        }
-        printf("\nTarget: ");
-        for (int i = 0; i < 8; i++) {
-            printf("%08x", target.words[i]);
-        }
-        printf("\n");
-    }*/
 
     // Compare in Bitcoin's byte order (reversed words, each word in little-endian)
     for (int i = 7; i >= 0 && valid; i--) {
         uint32_t hash_word = swap32(final_state[i]);  // Convert word to little-endian
-        uint32_t target_word = target.words[7-i];
+        uint32_t target_word = job->target[7-i];
         if (hash_word > target_word) {
             valid = false;
         }
@@ -381,30 +265,23 @@ __global__ void sha256_gpu(MiningHeader* header, uint8_t* output, Target target,
         }
     }
 
-    if (valid) {
-        *found = tid;
-        // Copy final hash to output in Bitcoin's byte order (reversed words, each word in little-endian)
+    // First winner claims the slot result; the host polls it without a copy
+    if (valid && atomicCAS(&result->found, 0u, 1u) == 0u) {
+        result->nonce = nonce;
+        // Copy final hash in Bitcoin's byte order (reversed words, each word in little-endian)
         for (int i = 0; i < 8; i++) {
-            ((uint32_t*)output)[i] = swap32(final_state[7-i]);  // Convert word to little-endian
+            result->hash[i] = swap32(final_state[7-i]);
         }
+        __threadfence_system();
     }
 }
 
-// Hex string to bytes conversion utility
+// Hex string of exactly 2 * len characters to bytes
 __host__ bool hex_to_bytes(const char* hex_str, uint8_t* bytes, size_t len) {
-    if (!hex_str || !bytes || strlen(hex_str) < len * 2) {
+    if (!hex_str || !bytes || strlen(hex_str) != len * 2) {
         return false;
     }
-    for (size_t i = 0; i < len; i++) {
-        char hex[3] = {hex_str[i*2], hex_str[i*2+1], 0};
-        char* endptr;
-        long val = strtol(hex, &endptr, 16);
-        if (*endptr != '\0' || val < 0 || val > 255) {
-            return false;
-        }
-        bytes[i] = (uint8_t)val;
-    }
-    return true;
+    return hex_decode(hex_str, bytes, len);
 }
 
 // Save current mining state to a file
@@ -498,159 +375,250 @@ bool load_mining_state(const char* filename, MiningHeader* header, Target* targe
     return true;
 }
 
-bool mine_block(MiningHeader* header, Target target, float time_limit) {
-    MiningHeader* d_header;
-    uint8_t* d_output;
-    uint32_t* d_found;
+CudaEngine::CudaEngine(int device, int blocks)
+    : device_(device)
+    , blocks_(blocks)
+    , ok_(false)
+    , d_job_(nullptr)
+    , h_results_(nullptr)
+    , d_results_(nullptr) {
     cudaError_t cuda_status;
-    bool success = false;
-    
-    // Allocate device memory
-    if ((cuda_status = cudaMalloc(&d_header, sizeof(MiningHeader))) != cudaSuccess) {
-        printf("Error: Failed to allocate device memory for header: %s\n", cudaGetErrorString(cuda_status));
-        return false;
+    for (int i = 0; i < kSlots; i++) {
+        streams_[i] = nullptr;
+        done_[i] = nullptr;
+        base_nonce_[i] = 0;
+        busy_[i] = false;
     }
     
-    if ((cuda_status = cudaMalloc(&d_output, 32)) != cudaSuccess) {
-        printf("Error: Failed to allocate device memory for output: %s\n", cudaGetErrorString(cuda_status));
-        cudaFree(d_header);
-        return false;
+    if ((cuda_status = cudaSetDevice(device_)) != cudaSuccess) {
+        LOG_ERROR("Failed to select device {}: {}", device_, cudaGetErrorString(cuda_status));
+        return;
     }
     
-    if ((cuda_status = cudaMalloc(&d_found, sizeof(uint32_t))) != cudaSuccess) {
-        printf("Error: Failed to allocate device memory for found flag: %s\n", cudaGetErrorString(cuda_status));
-        cudaFree(d_header);
-        cudaFree(d_output);
-        return false;
+    // Allow the kernel to write results straight into pinned host memory. A
+    // device already in use keeps its flags; mapping below fails if they lack it.
+    cuda_status = cudaSetDeviceFlags(cudaDeviceMapHost);
+    if (cuda_status == cudaErrorSetOnActiveProcess) {
+        cudaGetLastError();
+    } else if (cuda_status != cudaSuccess) {
+        LOG_ERROR("Failed to enable mapped memory on device {}: {}", device_, cudaGetErrorString(cuda_status));
+        return;
     }
     
-    // Create CUDA events for timing
-    cudaEvent_t start, stop;
-    cudaEventCreate(&start);
-    cudaEventCreate(&stop);
-    cudaEventRecord(start);
+    if ((cuda_status = cudaMalloc(&d_job_, sizeof(DeviceJob))) != cudaSuccess) {
+        LOG_ERROR("Failed to allocate device memory for job: {}", cudaGetErrorString(cuda_status));
+        return;
+    }
     
-    // Calculate grid dimensions
-    int blocks = 8192;  // Adjust based on your GPU
+    if ((cuda_status = cudaHostAlloc((void**)&h_results_, sizeof(DeviceResult) * kSlots, cudaHostAllocMapped)) != cudaSuccess) {
+        LOG_ERROR("Failed to allocate pinned result memory: {}", cudaGetErrorString(cuda_status));
+        return;
+    }
+    memset(h_results_, 0, sizeof(DeviceResult) * kSlots);
     
-    // Print mining parameters
-    printf("Starting mining with parameters:\n");
-    printf("Threads per block: %d\n", 256);
-    printf("Blocks per grid: %d\n", blocks);
-    printf("Hashes per launch: %d\n", 256 * blocks);
+    if ((cuda_status = cudaHostGetDevicePointer((void**)&d_results_, h_results_, 0)) != cudaSuccess) {
+        LOG_ERROR("Failed to map result memory: {}", cudaGetErrorString(cuda_status));
+        return;
+    }
     
-    float elapsed_time = 0;
-    uint64_t total_hashes = 0;
-    bool interrupted = false;
+    for (int i = 0; i < kSlots; i++) {
+        if ((cuda_status = cudaStreamCreateWithFlags(&streams_[i], cudaStreamNonBlocking)) != cudaSuccess) {
+            LOG_ERROR("Failed to create stream: {}", cudaGetErrorString(cuda_status));
+            return;
+        }
+        // Blocking sync lets the host thread sleep instead of spinning while a slot runs
+        if ((cuda_status = cudaEventCreateWithFlags(&done_[i], cudaEventBlockingSync | cudaEventDisableTiming)) != cudaSuccess) {
+            LOG_ERROR("Failed to create event: {}", cudaGetErrorString(cuda_status));
+            return;
+        }
+    }
     
-    while (elapsed_time < time_limit && !interrupted) {
-        // Check for keyboard input (Windows)
-        if (_kbhit()) {
-            char c = _getch();
-            printf("\nKey pressed: %d\n", (int)c);  // Debug output
-            
-            // Save state on Ctrl+C (3) or 'q'
-            if (c == 3 || c == 'q' || c == 'Q') {
-                printf("\n\nMining interrupted. Saving state...\n");
-                const char* state_path = "mining_state.bin";  // Try simple path first
-                printf("Current working directory: ");
-                fflush(stdout);  // Ensure output is shown
-                system("cd");    // Print current directory
-                
-                printf("Attempting to save state to: %s\n", state_path);
-                fflush(stdout);  // Ensure output is shown
-                
-                if (save_mining_state(state_path, header, &target)) {
-                    printf("Mining state saved to %s\n", state_path);
-                } else {
-                    printf("Failed to save mining state to %s\n", state_path);
-                    
-                    // Try alternate location
-                    state_path = "C:/Users/Omer/Documents/Work/Mine/miner/mining_state.bin";
-                    printf("Trying alternate path: %s\n", state_path);
-                    if (save_mining_state(state_path, header, &target)) {
-                        printf("Mining state saved to alternate location: %s\n", state_path);
-                    } else {
-                        printf("Failed to save to alternate location\n");
-                    }
-                }
-                interrupted = true;
-                break;
-            }
+    ok_ = true;
+}
+
+CudaEngine::~CudaEngine() {
+    cudaSetDevice(device_);
+    for (int i = 0; i < kSlots; i++) {
+        if (streams_[i]) {
+            cudaStreamSynchronize(streams_[i]);
+            cudaStreamDestroy(streams_[i]);
         }
-        
-        printf("\rHashes: %llu (%.2f MH/s)", total_hashes, total_hashes / (elapsed_time * 1000000));
-        fflush(stdout);
-        
-        // Reset found flag
-        if ((cuda_status = cudaMemset(d_found, 0, sizeof(uint32_t))) != cudaSuccess) {
-            printf("Error: Failed to reset found flag: %s\n", cudaGetErrorString(cuda_status));
-            break;
+        if (done_[i]) {
+            cudaEventDestroy(done_[i]);
         }
-        
-        // Copy header to device
-        if ((cuda_status = cudaMemcpy(d_header, header, sizeof(MiningHeader), cudaMemcpyHostToDevice)) != cudaSuccess) {
-            printf("Error: Failed to copy header to device: %s\n", cudaGetErrorString(cuda_status));
-            break;
+    }
+    if (h_results_) {
+        cudaFreeHost(h_results_);
+    }
+    if (d_job_) {
+        cudaFree(d_job_);
+    }
+}
+
+bool CudaEngine::set_job(const TicketJobConstants& job, const Target& target) {
+    if (!ok_) {
+        return false;
+    }
+    for (int i = 0; i < kSlots; i++) {
+        if (busy_[i]) {
+            return false;
         }
-        
-        // Launch kernel
-        sha256_gpu<<<blocks, 256>>>(d_header, d_output, target, d_found);
-        
-        if ((cuda_status = cudaGetLastError()) != cudaSuccess) {
-            printf("Error: Failed to launch kernel: %s\n", cudaGetErrorString(cuda_status));
-            break;
+    }
+    
+    DeviceJob device_job;
+    ticket_midstate(job, device_job.midstate);
+    memcpy(device_job.tail, job.words + TicketLayout::kTailWord, sizeof(device_job.tail));
+    memcpy(device_job.target, target.words, sizeof(device_job.target));
+    
+    cudaError_t cuda_status;
+    cudaSetDevice(device_);
+    if ((cuda_status = cudaMemcpy(d_job_, &device_job, sizeof(DeviceJob), cudaMemcpyHostToDevice)) != cudaSuccess) {
+        LOG_ERROR("Failed to copy job to device: {}", cudaGetErrorString(cuda_status));
+        return false;
+    }
+    return true;
+}
+
+bool CudaEngine::launch(int slot, uint32_t base_nonce) {
+    if (!ok_ || slot < 0 || slot >= kSlots || busy_[slot]) {
+        return false;
+    }
+    
+    // The previous launch in this slot has been collected, so the host owns the entry
+    volatile DeviceResult* result = &h_results_[slot];
+    result->found = 0;
+    
+    sha256_gpu<<<blocks_, kThreadsPerBlock, 0, streams_[slot]>>>(d_job_, base_nonce, &d_results_[slot]);
+    
+    cudaError_t cuda_status;
+    if ((cuda_status = cudaGetLastError()) != cudaSuccess) {
+        LOG_ERROR("Failed to launch kernel: {}", cudaGetErrorString(cuda_status));
+        return false;
+    }
+    if ((cuda_status = cudaEventRecord(done_[slot], streams_[slot])) != cudaSuccess) {
+        LOG_ERROR("Failed to record event: {}", cudaGetErrorString(cuda_status));
+        return false;
+    }
+    
+    base_nonce_[slot] = base_nonce;
+    busy_[slot] = true;
+    return true;
+}
+
+bool CudaEngine::collect(int slot, BatchResult* result) {
+    if (slot < 0 || slot >= kSlots || !busy_[slot]) {
+        return false;
+    }
+    busy_[slot] = false;
+    
+    cudaError_t cuda_status;
+    if ((cuda_status = cudaEventSynchronize(done_[slot])) != cudaSuccess) {
+        LOG_ERROR("Failed to wait for batch: {}", cudaGetErrorString(cuda_status));
+        return false;
+    }
+    
+    const volatile DeviceResult* device_result = &h_results_[slot];
+    result->base_nonce = base_nonce_[slot];
+    result->count = batch_size();
+    result->found = device_result->found != 0;
+    if (result->found) {
+        // The device does not timestamp the win; the completed batch is the earliest host-visible point
+        result->found_at = std::chrono::steady_clock::now();
+        result->nonce = device_result->nonce;
+        for (int i = 0; i < 8; i++) {
+            result->hash[i] = device_result->hash[i];
         }
+    }
+    return true;
+}
+
+// Check for keyboard input (Windows), true on Ctrl+C (3) or 'q'
+static bool keyboard_interrupt_requested() {
+    if (_kbhit()) {
+        char c = _getch();
+        LOG_DEBUG("Key pressed: {}", (int)c);
+        return c == 3 || c == 'q' || c == 'Q';
+    }
+    return false;
+}
+
+static void save_interrupted_state(const MiningHeader* header, const Target* target) {
+    const char* state_path = "mining_state.bin";  // Try simple path first
+    LOG_INFO("Mining interrupted, saving state to {} (working directory)", state_path);
+    
+    if (save_mining_state(state_path, header, target)) {
+        LOG_INFO("Mining state saved to {}", state_path);
+    } else {
+        LOG_WARNING("Failed to save mining state to {}", state_path);
         
-        // Check if a valid nonce was found
-        uint32_t winning_thread;
-        if ((cuda_status = cudaMemcpy(&winning_thread, d_found, sizeof(uint32_t), cudaMemcpyDeviceToHost)) != cudaSuccess) {
-            printf("Error: Failed to copy found flag: %s\n", cudaGetErrorString(cuda_status));
-            break;
+        // Try alternate location
+        state_path = "C:/Users/Omer/Documents/Work/Mine/miner/mining_state.bin";
+        if (save_mining_state(state_path, header, target)) {
+            LOG_INFO("Mining state saved to alternate location {}", state_path);
+        } else {
+            LOG_ERROR("Failed to save mining state to alternate location {}", state_path);
         }
-        
-        if (winning_thread != 0) {
-            uint32_t winning_nonce = header->nonce + winning_thread;
-            uint32_t output_hash[8];
-            if ((cuda_status = cudaMemcpy(output_hash, d_output, 32, cudaMemcpyDeviceToHost)) != cudaSuccess) {
-                printf("Error: Failed to copy output hash: %s\n", cudaGetErrorString(cuda_status));
-                break;
+    }
+}
+
+// Resident engine for the CLI and UI path, created on first use and kept for
+// the life of the process. Callers take turns on it.
+static std::mutex resident_engine_mutex;
+
+static CudaEngine& resident_engine() {
+    static CudaEngine engine;
+    return engine;
+}
+
+bool mine_block(MiningHeader* header, Target target, float time_limit, uint32_t* out_hash) {
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(resident_engine_mutex);
+    CudaEngine& engine = resident_engine();
+    if (!engine.ok()) {
+        return false;
+    }
+    
+    LOG_INFO("Starting mining: {} threads per block, {} blocks per grid, {} hashes per launch, {} launches in flight",
+             (int)CudaEngine::kThreadsPerBlock, engine.batch_size() / CudaEngine::kThreadsPerBlock, engine.batch_size(),
+             engine.slots());
+    
+    bool interrupted = false;
+    bool first_batch = true;
+    float next_report = 1.0f;  // Progress once a second, not per batch
+    PipelineStats stats;
+    bool success = run_pipeline(engine, header, target, time_limit, out_hash,
+        [&](const PipelineStats& progress) {
+            if (first_batch) {
+                first_batch = false;
+                std::chrono::duration<double, std::milli> first_hash = std::chrono::steady_clock::now() - start;
+                LOG_INFO("Time to first hash: {:.2f} ms", first_hash.count());
+            }
+            if (keyboard_interrupt_requested()) {
+                interrupted = true;
+                return false;
             }
-            
-            printf("\n\n=== Valid Nonce Found! ===\n");
-            printf("Nonce (hex): %08x\n", winning_nonce);
-            printf("Nonce (decimal): %u\n", winning_nonce);
-            printf("Final Hash: ");
+            if (progress.elapsed >= next_report) {
+                next_report = progress.elapsed + 1.0f;
+                LOG_INFO("Hashes: {} ({:.2f} MH/s)", progress.hashes, progress.hashes / (progress.elapsed * 1000000));
+            }
+            return true;
+        }, &stats);
+    
+    if (interrupted && !success) {
+        save_interrupted_state(header, &target);
+    }
+    
+    if (success) {
+        LOG_INFO("Valid nonce found: {:08x} ({}) after {} hashes in {:.2f} s, {:.2f} MH/s", header->nonce,
+                 header->nonce, stats.hashes, stats.elapsed, stats.hashes / (stats.elapsed * 1000000));
+        if (out_hash) {
+            char hash_hex[65];
             for (int i = 0; i < 8; i++) {
-                printf("%08x", output_hash[i]);
+                snprintf(hash_hex + i * 8, 9, "%08x", out_hash[i]);
             }
-            printf("\nTotal hashes tried: %llu\n", total_hashes);
-            printf("Time elapsed: %.2f seconds\n", elapsed_time);
-            printf("Hash rate: %.2f MH/s\n", total_hashes / (elapsed_time * 1000000));
-            printf("========================\n\n");
-            
-            header->nonce = winning_nonce;
-            success = true;
-            break;
+            LOG_INFO("Final hash: {}", hash_hex);
         }
-        
-        // Update progress
-        total_hashes += 256 * blocks;
-        header->nonce += 256 * blocks;
-        
-        // Update elapsed time
-        cudaEventRecord(stop);
-        cudaEventSynchronize(stop);
-        cudaEventElapsedTime(&elapsed_time, start, stop);
-        elapsed_time /= 1000.0f;  // Convert to seconds
-    }
-    
-    // Cleanup
-    cudaFree(d_header);
-    cudaFree(d_output);
-    cudaFree(d_found);
-    cudaEventDestroy(start);
-    cudaEventDestroy(stop);
+    }
     
     return success;
 }
@@ -32,8 +32,14 @@ struct Target {
 // Byte swap function declaration
 __device__ __host__ __inline__ uint32_t swap32(uint32_t val);
 
-// Parse target hash string into Target structure
-__host__ Target parse_target_hash(const char* target_str);
+// Parse a 64-character hex target; false, target untouched, if malformed
+__host__ bool parse_target_hash(const char* target_str, Target* target);
+
+// Build a Target from 32 big-endian bytes
+__host__ Target target_from_bytes(const uint8_t* bytes);
+
+// And back, for the wire
+__host__ void target_to_bytes(const Target& target, uint8_t* bytes);
 
 // Convert compact target format to actual target
 __host__ Target decode_compact_target(uint32_t compact);
@@ -44,9 +50,12 @@ bool save_mining_state(const char* filename, const MiningHeader* header, const T
 // Load mining state from a file
 bool load_mining_state(const char* filename, MiningHeader* header, Target* target);
 
-// Hex string to bytes conversion utility
+// Hex string of exactly 2 * len characters to bytes
 __host__ bool hex_to_bytes(const char* hex_str, uint8_t* bytes, size_t len);
 
 // GPU mining functions
-__global__ void sha256_gpu(MiningHeader* input, uint8_t* output, Target target, uint32_t* found);
-bool mine_block(MiningHeader* header, Target target, float time_limit = 60.0f);
+struct DeviceJob;
+struct DeviceResult;
+__global__ void sha256_gpu(const DeviceJob* job, uint32_t base_nonce, DeviceResult* result);
+// out_hash (optional) receives the device-reported hash of the solution in display word order
+bool mine_block(MiningHeader* header, Target target, float time_limit = 60.0f, uint32_t* out_hash = nullptr);
@@ -17,6 +17,35 @@ struct MinerConfig {
     int flag = 0; // 0 or 1
     std::string target = "00000000ffff0000000000000000000000000000000000000000000000000000"; // Default target
     int max_time_seconds = 60; // Default 60 seconds, 0 for unlimited
+    int cuda_engines = 1; // Resident CUDA engines warmed at server start
+    int cpu_engines = 0; // Resident CPU engines (also used if no CUDA engine warms up)
+    std::string trace_file = ""; // Chrome trace JSON output, empty disables tracing
+    std::string log_level = "info"; // debug, info, warning, error or off
+    std::string log_file = ""; // Also append log lines to this file, empty for console only
+    std::string stats_segment = "kbuc_miner_stats"; // Shared-memory live stats name, empty disables
+    bool coordinator = false; // Lease jobs to --worker processes instead of mining locally
+    double lease_seconds = 5.0; // Target time for one worker lease at the worker's rate
+    double lease_expiry_seconds = 30.0; // Minimum time before an unfinished lease is reissued
+    std::string host_lease_file = ""; // Lease table shared by servers on this host, empty disables
+    int http_port = 0; // Native REST gateway port, 0 disables
+    int http_threads = 8; // REST requests handled at once
+    std::string daemon_address = "127.0.0.1:50051"; // Mining server the UI attaches to, empty always mines in-process
+    double time_budget_probability = 0.99; // A time_limit of 0 mines until a solution is this likely
+    int max_time_budget = 3600; // Cap in seconds for auto-sized time budgets
+    bool schedule_by_expected_time = false; // Give free engines to the waiting job with the most weight per expected second
+    double engine_max_hash_rate = 0; // H/s cap per engine, 0 uncapped
+    double engine_duty_cycle = 1.0; // Share of each engine's full speed to use, 1 uncapped
+    int verify_threads = 0; // VerifyTickets hashing threads, 0 uses every hardware thread
+    bool spill_paused_sessions = true; // Also write paused sessions to mining_state_<id>.bin, in the background
+    double session_retention_seconds = 3600; // Finished sessions stay queryable this long
+    double paused_session_ttl_seconds = 86400; // Paused sessions not resumed by then are retired like finished ones
+    int max_retired_sessions = 10000; // Finished sessions kept in memory at most
+    std::string session_archive = "sessions.jsonl"; // Evicted sessions are appended here, empty drops them
+    std::string duplicate_jobs = "attach"; // Resubmitted job: "attach" to its session, "split" its nonces with a second engine, or "new" session
+    int duplicate_timestamp_window = 60; // Seconds between ticket timestamps still counted as the same job
+    bool speculative_mining = false; // Pre-mine the next height of the current leader on spare capacity
+    double speculative_share = 0.25; // Share of an engine's full speed a prediction may use
+    double leader_poll_seconds = 2.0; // How often getsupportableleader is polled for speculation
 
     static MinerConfig fromFile(const std::string& path) {
         MinerConfig config;
@@ -84,6 +113,122 @@ struct MinerConfig {
                 config.max_time_seconds = j["max_time_seconds"].get<int>();
                 std::cout << "Found max_time_seconds: " << config.max_time_seconds << std::endl;
             }
+            if (j.contains("cuda_engines")) {
+                config.cuda_engines = j["cuda_engines"].get<int>();
+                std::cout << "Found cuda_engines: " << config.cuda_engines << std::endl;
+            }
+            if (j.contains("cpu_engines")) {
+                config.cpu_engines = j["cpu_engines"].get<int>();
+                std::cout << "Found cpu_engines: " << config.cpu_engines << std::endl;
+            }
+            if (j.contains("trace_file")) {
+                config.trace_file = j["trace_file"].get<std::string>();
+                std::cout << "Found trace_file: " << (config.trace_file.empty() ? "[empty, tracing off]" : config.trace_file) << std::endl;
+            }
+            if (j.contains("log_level")) {
+                config.log_level = j["log_level"].get<std::string>();
+                std::cout << "Found log_level: " << config.log_level << std::endl;
+            }
+            if (j.contains("log_file")) {
+                config.log_file = j["log_file"].get<std::string>();
+                std::cout << "Found log_file: " << (config.log_file.empty() ? "[empty, console only]" : config.log_file) << std::endl;
+            }
+            if (j.contains("coordinator")) {
+                config.coordinator = j["coordinator"].get<bool>();
+                std::cout << "Found coordinator: " << (config.coordinator ? "true" : "false") << std::endl;
+            }
+            if (j.contains("lease_seconds")) {
+                config.lease_seconds = j["lease_seconds"].get<double>();
+                std::cout << "Found lease_seconds: " << config.lease_seconds << std::endl;
+            }
+            if (j.contains("lease_expiry_seconds")) {
+                config.lease_expiry_seconds = j["lease_expiry_seconds"].get<double>();
+                std::cout << "Found lease_expiry_seconds: " << config.lease_expiry_seconds << std::endl;
+            }
+            if (j.contains("host_lease_file")) {
+                config.host_lease_file = j["host_lease_file"].get<std::string>();
+                std::cout << "Found host_lease_file: " << (config.host_lease_file.empty() ? "[empty, not shared]" : config.host_lease_file) << std::endl;
+            }
+            if (j.contains("http_port")) {
+                config.http_port = j["http_port"].get<int>();
+                std::cout << "Found http_port: " << config.http_port << std::endl;
+            }
+            if (j.contains("http_threads")) {
+                config.http_threads = j["http_threads"].get<int>();
+                std::cout << "Found http_threads: " << config.http_threads << std::endl;
+            }
+            if (j.contains("daemon_address")) {
+                config.daemon_address = j["daemon_address"].get<std::string>();
+                std::cout << "Found daemon_address: " << (config.daemon_address.empty() ? "[empty, in-process]" : config.daemon_address) << std::endl;
+            }
+            if (j.contains("time_budget_probability")) {
+                config.time_budget_probability = j["time_budget_probability"].get<double>();
+                std::cout << "Found time_budget_probability: " << config.time_budget_probability << std::endl;
+            }
+            if (j.contains("max_time_budget")) {
+                config.max_time_budget = j["max_time_budget"].get<int>();
+                std::cout << "Found max_time_budget: " << config.max_time_budget << std::endl;
+            }
+            if (j.contains("schedule_by_expected_time")) {
+                config.schedule_by_expected_time = j["schedule_by_expected_time"].get<bool>();
+                std::cout << "Found schedule_by_expected_time: " << (config.schedule_by_expected_time ? "true" : "false") << std::endl;
+            }
+            if (j.contains("engine_max_hash_rate")) {
+                config.engine_max_hash_rate = j["engine_max_hash_rate"].get<double>();
+                std::cout << "Found engine_max_hash_rate: " << config.engine_max_hash_rate << std::endl;
+            }
+            if (j.contains("engine_duty_cycle")) {
+                config.engine_duty_cycle = j["engine_duty_cycle"].get<double>();
+                std::cout << "Found engine_duty_cycle: " << config.engine_duty_cycle << std::endl;
+            }
+            if (j.contains("verify_threads")) {
+                config.verify_threads = j["verify_threads"].get<int>();
+                std::cout << "Found verify_threads: " << config.verify_threads << std::endl;
+            }
+            if (j.contains("spill_paused_sessions")) {
+                config.spill_paused_sessions = j["spill_paused_sessions"].get<bool>();
+                std::cout << "Found spill_paused_sessions: " << (config.spill_paused_sessions ? "true" : "false") << std::endl;
+            }
+            if (j.contains("session_retention_seconds")) {
+                config.session_retention_seconds = j["session_retention_seconds"].get<double>();
+                std::cout << "Found session_retention_seconds: " << config.session_retention_seconds << std::endl;
+            }
+            if (j.contains("paused_session_ttl_seconds")) {
+                config.paused_session_ttl_seconds = j["paused_session_ttl_seconds"].get<double>();
+                std::cout << "Found paused_session_ttl_seconds: " << config.paused_session_ttl_seconds << std::endl;
+            }
+            if (j.contains("max_retired_sessions")) {
+                config.max_retired_sessions = j["max_retired_sessions"].get<int>();
+                std::cout << "Found max_retired_sessions: " << config.max_retired_sessions << std::endl;
+            }
+            if (j.contains("session_archive")) {
+                config.session_archive = j["session_archive"].get<std::string>();
+                std::cout << "Found session_archive: " << (config.session_archive.empty() ? "[empty, not archived]" : config.session_archive) << std::endl;
+            }
+            if (j.contains("duplicate_jobs")) {
+                config.duplicate_jobs = j["duplicate_jobs"].get<std::string>();
+                std::cout << "Found duplicate_jobs: " << config.duplicate_jobs << std::endl;
+            }
+            if (j.contains("duplicate_timestamp_window")) {
+                config.duplicate_timestamp_window = j["duplicate_timestamp_window"].get<int>();
+                std::cout << "Found duplicate_timestamp_window: " << config.duplicate_timestamp_window << std::endl;
+            }
+            if (j.contains("speculative_mining")) {
+                config.speculative_mining = j["speculative_mining"].get<bool>();
+                std::cout << "Found speculative_mining: " << (config.speculative_mining ? "true" : "false") << std::endl;
+            }
+            if (j.contains("speculative_share")) {
+                config.speculative_share = j["speculative_share"].get<double>();
+                std::cout << "Found speculative_share: " << config.speculative_share << std::endl;
+            }
+            if (j.contains("leader_poll_seconds")) {
+                config.leader_poll_seconds = j["leader_poll_seconds"].get<double>();
+                std::cout << "Found leader_poll_seconds: " << config.leader_poll_seconds << std::endl;
+            }
+            if (j.contains("stats_segment")) {
+                config.stats_segment = j["stats_segment"].get<std::string>();
+                std::cout << "Found stats_segment: " << (config.stats_segment.empty() ? "[empty, not published]" : config.stats_segment) << std::endl;
+            }
         } catch (const nlohmann::json::exception& e) {
             std::cerr << "JSON parsing error: " << e.what() << std::endl;
             std::cerr << "Using default configuration" << std::endl;
@@ -1,19 +1,33 @@
 #include "miner_service.h"
 #include "miner.cuh"
+#include "cuda_engine.hpp"
+#include "cpu_engine.hpp"
+#include "difficulty.hpp"
+#include "trace.hpp"
+#include "log.hpp"
+#include "sha256_host.hpp"
+#include <algorithm>
 #include <chrono>
 #include <random>
 #include <sstream>
 #include <iomanip>
 #include <thread>
 #include <ctime>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+// Time budget for time_limit 0 until a session has measured the hash rate
+static const float kDefaultTimeBudget = 60.0f;
 
 MinerServiceImpl::MinerServiceImpl(const MinerConfig& config) 
-    : config_(config) {
-    std::cout << "Initializing MinerService with config:" << std::endl;
-    std::cout << "RPC Host: " << config.rpc_host << std::endl;
-    std::cout << "RPC Port: " << config.rpc_port << std::endl;
-    std::cout << "RPC User: " << config.rpc_user << std::endl;
-    std::cout << "Auto Broadcast: " << (config.auto_broadcast ? "true" : "false") << std::endl;
+    : config_(config)
+    , active_sessions_metric_(miner_metrics().gauge("miner_sessions_active", "Sessions currently mining"))
+    , tracked_sessions_metric_(miner_metrics().gauge("miner_sessions_tracked", "Sessions held in memory"))
+    , ticket_checks_(config.verify_threads) {
+    LOG_DEBUG("Initializing MinerService: RPC host {}, RPC port {}, RPC user {}, auto broadcast {}",
+              config.rpc_host, config.rpc_port, config.rpc_user, config.auto_broadcast);
     
     if (!config.rpc_user.empty() && !config.rpc_password.empty()) {
         try {
@@ -23,16 +37,111 @@ MinerServiceImpl::MinerServiceImpl(const MinerConfig& config)
                 config.rpc_user,
                 config.rpc_password
             );
-            std::cout << "Bitcoin RPC client initialized successfully" << std::endl;
+            LOG_INFO("Bitcoin RPC client initialized successfully");
         } catch (const std::exception& e) {
-            std::cerr << "Failed to initialize Bitcoin RPC client: " << e.what() << std::endl;
+            LOG_ERROR("Failed to initialize Bitcoin RPC client: {}", e.what());
         }
     } else {
-        std::cout << "Bitcoin RPC credentials not provided, auto-broadcast disabled" << std::endl;
+        LOG_WARNING("Bitcoin RPC credentials not provided, auto-broadcast disabled");
+    }
+    
+    if (config.coordinator) {
+        // Jobs are leased out to workers, this process hashes nothing itself
+        coordinator_ = std::make_unique<LeaseCoordinatorImpl>(config.lease_seconds, config.lease_expiry_seconds,
+            [this](const std::string& session_id, const MiningHeader& header, uint64_t hashes) {
+                CompleteCoordinatedSession(session_id, header, hashes);
+            });
+        LOG_INFO("Coordinator mode: {} s leases, reissued after {} s", config.lease_seconds,
+                 config.lease_expiry_seconds);
+    } else {
+        // Engines are created and warmed now so sessions start without setup cost
+        if (config.cuda_engines > 0) {
+            engine_pool_.add_engines([] { return std::unique_ptr<MiningEngine>(new CudaEngine()); },
+                                     config.cuda_engines);
+        }
+        if (config.cpu_engines > 0) {
+            engine_pool_.add_engines([] { return std::unique_ptr<MiningEngine>(new CpuEngine()); },
+                                     config.cpu_engines);
+        }
+        if (engine_pool_.size() == 0) {
+            LOG_WARNING("No engine warmed up, falling back to one CPU engine");
+            engine_pool_.add_engines([] { return std::unique_ptr<MiningEngine>(new CpuEngine()); }, 1);
+        }
+        LOG_INFO("Engine pool ready with {} engine(s)", engine_pool_.size());
+        
+        for (size_t i = 0; i < engine_pool_.size(); i++) {
+            verifiers_.push_back(std::make_unique<TicketVerifier>(engine_pool_.engine_name(i)));
+            engine_throttles_.push_back(std::make_unique<Throttle>());
+            engine_throttles_.back()->set_limits(config.engine_max_hash_rate, config.engine_duty_cycle);
+        }
+        engine_full_rates_.assign(engine_pool_.size(), 0.0);
+        if (engine_throttles_.size() && engine_throttles_[0]->limited()) {
+            LOG_INFO("Engines capped at {:.1f} MH/s, duty cycle {:.2f}", config.engine_max_hash_rate / 1e6,
+                     engine_throttles_[0]->duty_cycle());
+        }
+        
+        if (!config.host_lease_file.empty()) {
+            if (host_leases_.open(config.host_lease_file)) {
+                LOG_INFO("Sharing nonce ranges with other servers on this host through {}", config.host_lease_file);
+            } else {
+                LOG_WARNING("Failed to open host lease table {}, mining without sharing", config.host_lease_file);
+            }
+        }
+    }
+    
+    if (!config.stats_segment.empty()) {
+        if (stats_.open(config.stats_segment)) {
+            for (size_t i = 0; i < engine_pool_.size(); i++) {
+                stats_.set_engine((int)i, engine_pool_.engine_name(i));
+            }
+            LOG_INFO("Live stats published in shared memory segment {}", config.stats_segment);
+        } else {
+            LOG_WARNING("Failed to create stats segment {}, live stats disabled", config.stats_segment);
+        }
+    }
+    
+    // Finished sessions, and paused ones nobody resumed, are dropped as new
+    // ones arrive, so memory stays flat
+    sessions_.configure(config.session_retention_seconds, (size_t)std::max(config.max_retired_sessions, 1),
+        config.paused_session_ttl_seconds,
+        [this](const std::shared_ptr<MiningSession>& session) {
+            tracked_sessions_metric_.add(-1);
+            {
+                // Still paused: its state file is kept, so it can be resumed from that
+                std::lock_guard<std::mutex> lock(sessions_.mutex_for(session->id));
+                if (session->paused) {
+                    ForgetGroup(*session);
+                    stats_.close_session(session->stats_slot, kStatsSessionExhausted);
+                }
+            }
+            ArchiveSession(*session);
+        });
+    
+    if (!config.trace_file.empty()) {
+        trace_enable(true);
+        LOG_INFO("Tracing enabled, spans are written to {} after each session", config.trace_file);
+    }
+    
+    if (config.speculative_mining) {
+        if (coordinator_ || config.rpc_user.empty() || config.rpc_password.empty()) {
+            LOG_WARNING("Speculative mining needs node RPC credentials and local engines, disabled");
+        } else {
+            speculation_thread_ = std::thread(&MinerServiceImpl::RunSpeculation, this);
+            LOG_INFO("Speculative mining on, predictions use up to {:.0f}% of an engine", config.speculative_share * 100);
+        }
     }
 }
 
-MinerServiceImpl::~MinerServiceImpl() {}
+MinerServiceImpl::~MinerServiceImpl() {
+    stopping_ = true;
+    if (speculation_thread_.joinable()) {
+        speculation_thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(speculation_mutex_);
+    if (speculative_) {
+        speculative_->control->cancel = true;
+    }
+}
 
 std::string MinerServiceImpl::GenerateSessionId() {
     auto now = std::chrono::system_clock::now();
@@ -49,12 +158,8 @@ std::string MinerServiceImpl::GenerateSessionId() {
     return ss.str();
 }
 
-std::string MinerServiceImpl::SaveMiningState(const MiningSession& session) {
-    std::string state_file = "mining_state_" + session.id + ".bin";
-    if (save_mining_state(state_file.c_str(), &session.header, &session.target)) {
-        return state_file;
-    }
-    return "";
+std::string MinerServiceImpl::StateFile(const MiningSession& session) const {
+    return "mining_state_" + session.id + ".bin";
 }
 
 grpc::Status MinerServiceImpl::StartMining(
@@ -71,6 +176,7 @@ grpc::Status MinerServiceImpl::StartMining(
     session.header.value = request->value();
     session.header.timestamp = request->timestamp();
     session.header.flag = request->flag();  // Get flag from request (0 or 1)
+    session.group_id = request->group_id();
     
     // Set lengths
     session.header.hash_length = 32;
@@ -83,47 +189,969 @@ grpc::Status MinerServiceImpl::StartMining(
         !hex_to_bytes(request->addr2().c_str(), session.header.address2, sizeof(session.header.address2))) {
         return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid hex string");
     }
+    session.ticket_hex = TicketHexTemplate(session.header);
     
     // Parse target
-    session.target = parse_target_hash(request->target().c_str());
+    if (!parse_target_hash(request->target().c_str(), &session.target)) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid target");
+    }
     
     // Set time limit
-    session.time_limit = request->time_limit();
+    session.time_limit = TimeBudget(session.target, request->time_limit());
+    session.priority = SchedulePriority(session.target, 1.0);
+    
+    SubmitJob(session, response);
+    return grpc::Status::OK;
+}
+
+grpc::Status MinerServiceImpl::StartMiningV2(
+    grpc::ServerContext* context,
+    const miner::StartMiningV2Request* request,
+    miner::StartMiningResponse* response) {
+    
+    // Fixed-size binary fields are copied straight into the header
+    if (request->hash().size() != sizeof(MiningHeader::hash) ||
+        request->addr1().size() != sizeof(MiningHeader::address1) ||
+        request->addr2().size() != sizeof(MiningHeader::address2) ||
+        request->target().size() != TicketLayout::kHashSize) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid field length");
+    }
+    
+    MiningSession session;
+    session.id = GenerateSessionId();
+    session.is_mining = true;
+    
+    session.header.nonce = 0;
+    session.header.value = request->value();
+    session.header.timestamp = request->timestamp();
+    session.header.flag = request->flag();
+    session.group_id = request->group_id();
+    
+    session.header.hash_length = 32;
+    session.header.address1_length = 20;
+    session.header.address2_length = 20;
+    
+    memcpy(session.header.hash, request->hash().data(), sizeof(session.header.hash));
+    memcpy(session.header.address1, request->addr1().data(), sizeof(session.header.address1));
+    memcpy(session.header.address2, request->addr2().data(), sizeof(session.header.address2));
+    session.ticket_hex = TicketHexTemplate(session.header);
+    
+    session.target = target_from_bytes(reinterpret_cast<const uint8_t*>(request->target().data()));
+    session.time_limit = TimeBudget(session.target, request->time_limit());
+    session.priority = SchedulePriority(session.target, request->weight() > 0 ? request->weight() : 1.0);
+    if (request->max_hash_rate() < 0 || request->duty_cycle() < 0 || request->duty_cycle() > 1) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid throttle");
+    }
+    session.throttle = std::make_shared<Throttle>();
+    session.throttle->set_limits(request->max_hash_rate(), request->duty_cycle());
+    
+    SubmitJob(session, response);
+    return grpc::Status::OK;
+}
+
+// Requested budget, or when 0 the time needed to find a solution with
+// time_budget_probability at the per-engine rate measured so far
+float MinerServiceImpl::TimeBudget(const Target& target, uint32_t requested) {
+    if (requested > 0) {
+        return (float)requested;
+    }
+    double hash_rate;
+    {
+        std::lock_guard<std::mutex> lock(engine_rate_mutex_);
+        hash_rate = engine_hash_rate_;
+    }
+    if (hash_rate <= 0) {
+        LOG_INFO("No hash rate measured yet, using a {} s time budget", kDefaultTimeBudget);
+        return kDefaultTimeBudget;
+    }
+    double budget = seconds_for_probability(target, hash_rate, config_.time_budget_probability);
+    budget = std::min(std::max(budget, 1.0), (double)config_.max_time_budget);
+    LOG_INFO("Time budget {:.0f} s for a {:.0f}% chance at {:.1f} MH/s (difficulty {:.4g})", budget,
+             config_.time_budget_probability * 100, hash_rate / 1e6, target_difficulty(target));
+    return (float)budget;
+}
+
+// Weight per expected second of work; the engine rate is common to every job,
+// so weight per expected hash ranks them the same. 0 keeps arrival order.
+double MinerServiceImpl::SchedulePriority(const Target& target, double weight) const {
+    return config_.schedule_by_expected_time ? weight / expected_hashes(target) : 0.0;
+}
+
+bool MinerServiceImpl::MineSession(MiningSession* session, float time_limit, SubmitTimeline* timeline) {
+    TraceSpan session_span("session");
+    
+    // Waiting for a busy pool counts against the session's time budget; a
+    // pause or a group cancel wakes the wait (wake_waiters)
+    SessionControl& control = *session->control;
+    EngineLease engine;
+    {
+        TraceSpan span("engine_acquire");
+        engine = engine_pool_.acquire(time_limit, session->priority,
+                                      [&control] { return control.stopped(); });
+    }
+    if (control.stopped()) {
+        return false;  // Paused or cancelled while waiting for the engine
+    }
+    if (!engine) {
+        LOG_WARNING("No engine available for session {}", session->id);
+        return false;
+    }
+    
+    int engine_index = engine_pool_.index_of(engine.get());
+    TicketVerifier& verifier = *verifiers_[engine_index];
+    active_sessions_metric_.add(1);
+    stats_.engine_busy(engine_index, true);
+    stats_.session_engine(session->stats_slot, engine_index);
+    struct ActiveSession {
+        Gauge& gauge;
+        StatsSegment& stats;
+        int engine_index;
+        ~ActiveSession() {
+            gauge.add(-1);
+            stats.engine_busy(engine_index, false);
+        }
+    } active{active_sessions_metric_, stats_, engine_index};
+    
+    float remaining = time_limit - std::chrono::duration<float>(
+        std::chrono::steady_clock::now() - session->start_time).count();
+    
+    // Live stats: the observer keeps totals across pipeline restarts (a
+    // rejected solution starts a new run with fresh PipelineStats) and the
+    // hash rate; they are published to the session about every 0.5 s
+    ProgressObserver progress;
+    VerifyCounts checked;  // Solutions this run checked, added to the session's earlier ones
+    uint64_t base_verified, base_rejected;
+    uint64_t published_hashes;  // Already added to the stats segment's engine total
+    auto published_at = std::chrono::steady_clock::now();
+    std::mutex& session_mutex = sessions_.mutex_for(session->id);
+    {
+        // A resumed session carries on from its earlier runs' totals
+        std::lock_guard<std::mutex> lock(session_mutex);
+        progress.reset(session->total_hashes, session->total_batches);
+        base_verified = session->verified_solutions;
+        base_rejected = session->rejected_solutions;
+        published_hashes = session->total_hashes;
+    }
+    
+    // Caps are applied between collect and refill, so they only delay launches
+    BatchPacer pacer(engine_throttles_[engine_index].get(), session->throttle.get(),
+                     &engine_full_rates_[engine_index]);
+    
+    // A prediction gives its engine up as soon as real work waits for one, and
+    // ends its run when promoted so the next run starts on the real budget
+    bool speculative_run = control.speculative.load();
+    bool first_batch = session->first_hash_ms == 0 && !speculative_run;  // Only the first real run is timed
+    BatchCallback on_batch =
+        [this, session, engine_index, speculative_run, base_verified, base_rejected, &checked, &first_batch,
+         &progress, &published_hashes, &published_at, &pacer, &control,
+         &session_mutex](const PipelineStats& stats) {
+            if (first_batch) {
+                first_batch = false;
+                std::chrono::duration<double, std::milli> first_hash =
+                    std::chrono::steady_clock::now() - session->start_time;
+                engine_pool_.record_first_hash(first_hash.count());
+                std::lock_guard<std::mutex> lock(session_mutex);
+                session->first_hash_ms = first_hash.count();
+            }
+            
+            const MiningProgress& totals = progress.observe(stats);
+            auto now = std::chrono::steady_clock::now();
+            if (std::chrono::duration<double>(now - published_at).count() >= 0.5) {
+                published_at = now;
+                // Status readers see totals at the window rate, not per batch
+                {
+                    std::lock_guard<std::mutex> lock(session_mutex);
+                    session->total_hashes = totals.hashes;
+                    session->hash_rate = totals.hash_rate;
+                    session->verified_solutions = base_verified + checked.accepted;
+                    session->rejected_solutions = base_rejected + checked.rejected;
+                }
+                if (totals.hash_rate > 0) {
+                    std::lock_guard<std::mutex> lock(engine_rate_mutex_);
+                    engine_hash_rate_ = engine_hash_rate_ > 0
+                        ? engine_hash_rate_ + 0.2 * (totals.hash_rate - engine_hash_rate_)
+                        : totals.hash_rate;
+                }
+            }
+            
+            if (stats_.is_open()) {
+                stats_.session_progress(session->stats_slot, stats.next_nonce, totals.hashes, totals.batches,
+                                        totals.hash_rate);
+                stats_.engine_progress(engine_index, totals.hashes - published_hashes, totals.hash_rate);
+                published_hashes = totals.hashes;
+            }
+            pacer.pace(progress);
+            if (speculative_run && (!control.speculative.load(std::memory_order_relaxed) || engine_pool_.waiting() > 0)) {
+                return false;
+            }
+            return !control.stopped();
+        };
+    
+    bool found;
+    if (host_leases_.is_open()) {
+        found = MineHostLeases(session, *engine, verifier, remaining, on_batch, timeline, &checked);
+    } else {
+        found = mine_block_verified(*engine, &session->header, session->target, remaining, verifier,
+                                    on_batch, timeline, &checked);
+    }
+    
+    std::lock_guard<std::mutex> lock(session_mutex);
+    session->total_hashes = progress.latest().hashes;
+    session->total_batches = progress.latest().batches;
+    session->verified_solutions = base_verified + checked.accepted;
+    session->rejected_solutions = base_rejected + checked.rejected;
+    return found;
+}
+
+// Same-host partitioning: the job is mined in ranges claimed from the host
+// lease table, so other servers on this host mining the same ticket never
+// hash the same nonces
+bool MinerServiceImpl::MineHostLeases(MiningSession* session, MiningEngine& engine, TicketVerifier& verifier,
+                                      float time_limit, const BatchCallback& on_batch, SubmitTimeline* timeline,
+                                      VerifyCounts* counts) {
+    const MiningHeader start = session->job_header;
+    int job = host_leases_.open_job(HostLeaseTable::fingerprint(start, session->target));
+    if (job < 0) {
+        LOG_WARNING("Host lease table is full, session {} mines without sharing", session->id);
+        return mine_block_verified(engine, &session->header, session->target, time_limit, verifier,
+                                   on_batch, timeline, counts);
+    }
+    
+    const uint32_t batch = engine.batch_size();
+    const int slots = engine.slots();
+    // Whole launch cycles, so a range ends on a launch boundary
+    const uint64_t granularity = (uint64_t)batch * slots;
+    const double expiry = config_.lease_expiry_seconds;
+    auto started = std::chrono::steady_clock::now();
+    double hash_rate = 0;
+    
+    for (;;) {
+        float remaining = time_limit - std::chrono::duration<float>(std::chrono::steady_clock::now() - started).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        uint64_t want = hash_rate > 0 ? (uint64_t)(hash_rate * config_.lease_seconds) : granularity;
+        want = std::max(granularity, (want + granularity - 1) / granularity * granularity);
+        want = std::min<uint64_t>(want, std::max<uint64_t>(kMaxLeaseNonces / granularity * granularity, granularity));
+        
+        HostLease lease;
+        if (!host_leases_.claim(job, start.nonce, want, expiry, &lease)) {
+            if (host_leases_.solved(job)) {
+                LOG_INFO("Session {}: ticket solved by another server on this host", session->id);
+                return false;
+            }
+            // Every lease slot of the job is held; one frees up as its range ends
+            if (session->control->stopped()) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        host_lease_header(start, lease.begin, &session->header);
+        if (lease.resumed) {
+            LOG_INFO("Session {}: resuming abandoned range at timestamp {}, nonces {:08x}+{}", session->id,
+                     session->header.timestamp, session->header.nonce, lease.count);
+        }
+        
+        const uint32_t first = session->header.nonce;
+        uint64_t done = 0;
+        bool held = true;
+        auto lease_start = std::chrono::steady_clock::now();
+        bool found = mine_block_verified(engine, &session->header, session->target, remaining, verifier,
+            [&](const PipelineStats& stats) {
+                bool keep = on_batch(stats);
+                done = (uint32_t)(stats.next_nonce - first);
+                if (!host_leases_.renew(lease, done, expiry)) {
+                    // Taken over after stalling past expiry, or solved elsewhere
+                    held = false;
+                    return false;
+                }
+                uint64_t launched = done + (uint64_t)(slots - 1) * batch;
+                return keep && launched < lease.count;
+            }, timeline, counts);
+        
+        if (found) {
+            host_leases_.mark_solved(job);
+            host_leases_.release(lease, lease.count);
+            return true;
+        }
+        host_leases_.release(lease, done);
+        if (session->control->stopped()) {
+            return false;  // The unfinished range goes back to the table
+        }
+        
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - lease_start;
+        if (elapsed.count() > 0 && done > 0) {
+            double rate = done / elapsed.count();
+            hash_rate = hash_rate > 0 ? 0.5 * hash_rate + 0.5 * rate : rate;
+        }
+        if (!held && host_leases_.solved(job)) {
+            LOG_INFO("Session {}: ticket solved by another server on this host", session->id);
+            return false;
+        }
+    }
+}
+
+void MinerServiceImpl::RecordSubmitLatency(MiningSession& session, const SubmitTimeline& timeline) {
+    global_submit_latency().record(timeline);
+    if (!session.submit_latency) {
+        session.submit_latency = std::make_shared<SubmitLatency>();
+    }
+    session.submit_latency->record(timeline);
+}
+
+// Host-side hash of a solved ticket, for the stats segment
+static void SolutionHash(const MiningHeader& header, uint32_t hash[8]) {
+    TicketJobConstants job;
+    uint32_t midstate[8];
+    build_job_constants(header, &job);
+    ticket_midstate(job, midstate);
+    ticket_hash_from_midstate(midstate, job.words + TicketLayout::kTailWord, header.nonce, hash);
+}
+
+void MinerServiceImpl::CompleteCoordinatedSession(const std::string& session_id, const MiningHeader& header,
+                                                  uint64_t hashes) {
+    std::string group_id;
+    {
+        auto locked = sessions_.lock(session_id);
+        if (!locked) {
+            return;
+        }
+        group_id = locked->group_id;
+    }
+    if (!group_id.empty()) {
+        CancelGroup(group_id, session_id);
+    }
+    
+    std::shared_ptr<MiningSession> solved;
+    {
+        auto locked = sessions_.lock(session_id);
+        if (!locked) {
+            return;
+        }
+        MiningSession& session = *locked;
+        // The solving lease may be at a later timestamp than the job started with
+        session.header = header;
+        session.total_hashes = hashes;
+        session.hash_rate = 0;
+        session.is_mining = false;
+        session.solution_found = true;
+        session.verified_solutions = 1;  // The coordinator re-verified it before this callback
+        stats_.close_session(session.stats_slot, kStatsSessionFound);
+        RetireSession(session);
+        solved = locked.share();
+    }
+    
+    SubmitTimeline timeline;
+    timeline.found = std::chrono::steady_clock::now();
+    timeline.notified = timeline.found;
+    timeline.verified = timeline.found;
+    ReportSolution(*solved, &timeline);
+}
+
+void MinerServiceImpl::SyncCoordinatedSession(MiningSession& session) {
+    if (!coordinator_ || !session.is_mining) {
+        return;
+    }
+    // Workers report to the lease book; the cursor is its completed frontier
+    LeaseJobProgress progress;
+    progress.frontier = session.header;
+    progress.hashes = session.total_hashes;
+    progress.hash_rate = 0;
+    bool active = coordinator_->book().job_progress(session.id, &progress);
+    session.header = progress.frontier;
+    session.total_hashes = progress.hashes;
+    session.hash_rate = progress.hash_rate;
+    // Coordinated jobs that ran out of time end without a callback
+    if (!active) {
+        session.is_mining = false;
+        stats_.close_session(session.stats_slot, kStatsSessionExhausted);
+        RetireSession(session);
+    }
+}
+
+// Everything that identifies the work except where the search stands: the
+// timestamp and nonce move as a session mines, and the time budget and caps
+// don't change what a solution is
+static std::string JobKey(const MiningHeader& header, const Target& target) {
+    std::string key;
+    key.append(reinterpret_cast<const char*>(header.hash), sizeof(header.hash));
+    key.append(reinterpret_cast<const char*>(header.address1), sizeof(header.address1));
+    key.append(reinterpret_cast<const char*>(&header.value), sizeof(header.value));
+    key.append(reinterpret_cast<const char*>(header.address2), sizeof(header.address2));
+    key.append(reinterpret_cast<const char*>(&header.flag), sizeof(header.flag));
+    key.append(reinterpret_cast<const char*>(target.words), sizeof(target.words));
+    return key;
+}
+
+// Caller holds the session's lock
+void MinerServiceImpl::RememberJob(const MiningSession& session) {
+    if (config_.duplicate_jobs == "new") {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    jobs_.emplace(JobKey(session.job_header, session.target), session.id);
+}
+
+// Caller holds the session's lock. Duplicates no longer attach to it
+void MinerServiceImpl::ForgetJob(const MiningSession& session) {
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    auto range = jobs_.equal_range(JobKey(session.job_header, session.target));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == session.id) {
+            jobs_.erase(it);
+            break;
+        }
+    }
+}
+
+// Caller holds the session's lock. The session is over: it leaves its job and
+// group, its state file goes, and it may be evicted once retention runs out.
+// Paused sessions are parked instead, resumable by id until
+// paused_session_ttl_seconds runs out.
+void MinerServiceImpl::RetireSession(MiningSession& session) {
+    ForgetJob(session);
+    ForgetGroup(session);
+    if (session.spilled) {
+        spiller_.remove(StateFile(session));
+        session.spilled = false;
+    }
+    sessions_.retire_locked(session.id);
+}
+
+void MinerServiceImpl::ForgetGroup(const MiningSession& session) {
+    if (session.group_id.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(groups_mutex_);
+    auto range = groups_.equal_range(session.group_id);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == session.id) {
+            groups_.erase(it);
+            break;
+        }
+    }
+}
+
+// First verified solution of a group: every sibling stops at its next batch
+// and gives its engine back. Called without any session lock held.
+void MinerServiceImpl::CancelGroup(const std::string& group_id, const std::string& winner_id) {
+    std::vector<std::string> siblings;
+    {
+        std::lock_guard<std::mutex> lock(groups_mutex_);
+        auto range = groups_.equal_range(group_id);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second != winner_id) {
+                siblings.push_back(it->second);
+            }
+        }
+        groups_.erase(group_id);
+    }
     
+    size_t cancelled = 0;
+    for (const std::string& id : siblings) {
+        auto locked = sessions_.lock(id);
+        if (!locked || locked->solution_found || locked->control->cancel) {
+            continue;
+        }
+        locked->cancelled_by = winner_id;
+        CancelSession(*locked);
+        cancelled++;
+    }
+    if (cancelled > 0) {
+        // Siblings still queued for an engine leave the queue now
+        engine_pool_.wake_waiters();
+        LOG_INFO("Group {}: session {} found a solution, {} sibling session(s) cancelled", group_id, winner_id,
+                 cancelled);
+    }
+}
+
+// Caller holds the session's lock. Stops the session for good: its mining
+// thread ends it at the next batch, or it ends here if it has none
+void MinerServiceImpl::CancelSession(MiningSession& session) {
+    session.is_mining = false;
+    session.control->cancel = true;
+    if (coordinator_) {
+        LeaseJobProgress progress;
+        if (coordinator_->book().finish_job(session.id, &progress)) {
+            session.header = progress.frontier;
+            session.total_hashes = progress.hashes;
+        }
+        session.hash_rate = 0;
+    }
+    if (coordinator_ || !session.worker_running) {
+        // No mining thread to wind it down: coordinated, or parked by a pause
+        session.paused = false;
+        stats_.close_session(session.stats_slot, kStatsSessionCancelled);
+        RetireSession(session);
+    }
+}
+
+// A session already mining the same job, with a timestamp within
+// duplicate_timestamp_window of the submission's
+std::shared_ptr<MiningSession> MinerServiceImpl::FindDuplicate(const MiningSession& session) {
+    std::vector<std::string> candidates;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        auto range = jobs_.equal_range(JobKey(session.header, session.target));
+        for (auto it = range.first; it != range.second; ++it) {
+            candidates.push_back(it->second);
+        }
+    }
+    for (const std::string& id : candidates) {
+        auto locked = sessions_.lock(id);
+        if (!locked) {
+            continue;
+        }
+        SyncCoordinatedSession(*locked);
+        int64_t skew = (int64_t)locked->job_header.timestamp - (int64_t)session.header.timestamp;
+        if (locked->is_mining && std::abs(skew) <= config_.duplicate_timestamp_window) {
+            return locked.share();
+        }
+    }
+    return nullptr;
+}
+
+// New jobs go through here, so a client retrying a submission gets the
+// session already mining it instead of a second one starting from nonce 0
+void MinerServiceImpl::SubmitJob(const MiningSession& session, miner::StartMiningResponse* response) {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    std::shared_ptr<MiningSession> existing =
+        config_.duplicate_jobs == "new" ? nullptr : FindDuplicate(session);
+    if (!existing) {
+        {
+            std::lock_guard<std::mutex> speculation_lock(speculation_mutex_);
+            has_last_job_ = true;
+            last_job_header_ = session.header;
+            last_job_target_ = session.target;
+        }
+        if (PromoteSpeculative(session, response)) {
+            return;
+        }
+        response->set_success(true);
+        response->set_session_id(LaunchSession(session));
+        return;
+    }
+    
+    // Splitting needs a second engine and a lease table for the two to share
+    bool split = config_.duplicate_jobs == "split" && host_leases_.is_open() && engine_pool_.size() > 1;
+    if (split) {
+        LaunchCompanion(existing);
+    }
+    LOG_INFO("Duplicate submission of session {}'s job, {}", existing->id,
+             split ? "mining it on a second engine" : "attached");
+    response->set_success(true);
+    response->set_session_id(existing->id);
+    response->set_attached(true);
+    response->set_message(split ? "Attached to an existing session, search space split"
+                                : "Attached to an existing session");
+}
+
+// One JSON line per evicted session, so results outlive their place in memory
+void MinerServiceImpl::ArchiveSession(const MiningSession& session) {
+    if (config_.session_archive.empty()) {
+        return;
+    }
+    nlohmann::json j;
+    {
+        // A mining thread may still be winding down on it
+        std::lock_guard<std::mutex> lock(sessions_.mutex_for(session.id));
+        j["session_id"] = session.id;
+        j["solution_found"] = session.solution_found;
+        if (!session.group_id.empty()) {
+            j["group_id"] = session.group_id;
+            j["cancelled_by"] = session.cancelled_by;
+        }
+        j["paused"] = session.paused;
+        j["nonce"] = session.header.nonce;
+        j["timestamp"] = session.header.timestamp;
+        j["total_hashes"] = session.total_hashes + session.companion_hashes;
+        j["time_limit"] = session.time_limit;
+        j["time_to_first_hash_ms"] = session.first_hash_ms;
+        j["difficulty"] = target_difficulty(session.target);
+    }
+    
+    std::lock_guard<std::mutex> lock(archive_mutex_);
+    std::ofstream file(config_.session_archive, std::ios::app);
+    if (!file) {
+        LOG_WARNING("Failed to append session {} to archive {}", session.id, config_.session_archive);
+        return;
+    }
+    file << j.dump() << "\n";
+}
+
+std::string MinerServiceImpl::LaunchSession(const MiningSession& new_session) {
     // Store session
+    std::shared_ptr<MiningSession> stored = sessions_.insert(new_session.id, new_session);
+    tracked_sessions_metric_.add(1);
     {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        sessions_[session.id] = session;
+        std::lock_guard<std::mutex> lock(sessions_.mutex_for(new_session.id));
+        MiningSession& session = *stored;
+        session.job_header = session.header;
+        session.start_time = std::chrono::steady_clock::now();
+        session.stats_slot = stats_.open_session(session.id);
+        session.control = std::make_shared<SessionControl>();
+        if (!session.throttle) {
+            session.throttle = std::make_shared<Throttle>();  // Uncapped until SetThrottle
+        }
+        RememberJob(session);
+        if (!session.group_id.empty()) {
+            std::lock_guard<std::mutex> groups_lock(groups_mutex_);
+            groups_.emplace(session.group_id, session.id);
+        }
+        if (coordinator_) {
+            // Workers mine it; CompleteCoordinatedSession closes it when one solves it
+            coordinator_->book().add_job(session.id, session.header, session.target, session.time_limit);
+            return session.id;
+        }
+        session.worker_running = true;
     }
     
     // Start mining in a new thread
-    std::thread mining_thread([this, session_id = session.id]() {
-        MiningSession* session = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(sessions_mutex_);
-            auto it = sessions_.find(session_id);
-            if (it != sessions_.end()) {
-                session = &it->second;
+    std::thread mining_thread(&MinerServiceImpl::RunSession, this, stored);
+    mining_thread.detach();
+    
+    return new_session.id;
+}
+
+// Mining thread of a session. A pause parks the session in memory and ends
+// the thread; ResumeMining starts a new one, or, if the pause had not taken
+// effect yet, this thread carries on.
+//
+// The thread holds its own reference, so the session stays valid even if it
+// is evicted from the registry while parked or winding down.
+void MinerServiceImpl::RunSession(std::shared_ptr<MiningSession> session) {
+    bool cancel_group = false;
+    bool report = false;  // The solution goes out once the session lock is released
+    SubmitTimeline timeline;
+    for (;;) {
+        // Only tickets that pass CPU re-verification reach the node
+        uint64_t pauses = session->control->pauses.load();
+        bool speculative = session->control->speculative.load();
+        timeline = SubmitTimeline();
+        bool success = MineSession(session.get(), session->time_limit, &timeline);
+        if (success && !speculative && !session->group_id.empty()) {
+            CancelGroup(session->group_id, session->id);  // Before the broadcast, so siblings stop now
+        }
+        std::unique_lock<std::mutex> lock(sessions_.mutex_for(session->id));
+        if (speculative && session->control->speculative.load()) {
+            // Still a prediction: a solution is held until the job is submitted
+            std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - session->start_time;
+            if (success || session->control->cancel.load() || elapsed.count() >= session->time_limit) {
+                session->solution_found = success;
+                session->worker_running = false;
+                break;
             }
+            continue;  // Gave its engine to real work; queue again behind it
         }
-        if (session) {
-            bool success = mine_block(&session->header, session->target, session->time_limit);
-            std::lock_guard<std::mutex> lock(sessions_mutex_);
-            if (success) {
-                session->is_mining = false;
-                if (config_.auto_broadcast) {
-                    std::cout << "\nValid nonce found! Broadcasting solution..." << std::endl;
-                    bool broadcast_success = BroadcastSolution(session->header);
-                    std::cout << "Solution broadcast " << (broadcast_success ? "succeeded" : "failed") << std::endl;
-                }
+        if (speculative && !success) {
+            continue;  // Promoted mid-run: mine on under the real budget
+        }
+        cancel_group = speculative && success && !session->group_id.empty();
+        if (!success && session->control->pauses.load() != pauses && !session->control->cancel.load()) {
+            if (!session->paused) {
+                continue;  // Resumed before this run wound down
+            }
+            // Parked: the cursor and totals stay here; the file is only for durability
+            session->worker_running = false;
+            session->hash_rate = 0;
+            if (config_.spill_paused_sessions) {
+                spiller_.spill(StateFile(*session), session->header, session->target);
+                session->spilled = true;
             }
+            break;
+        }
+        
+        if (!success) {
+            // The lease table stops this thread as soon as a companion solves the
+            // ticket; the companion hands its ticket over before it ends
+            session->control->companions_done.wait(lock, [&session] { return session->companions == 0; });
+        }
+        if (success || session->companion_found) {
+            if (!success) {
+                session->header = session->companion_header;
+                timeline = session->companion_timeline;
+            }
+            session->solution_found = true;
+            report = true;
+        }
+        // Time limit reached: the session is over either way
+        session->is_mining = false;
+        session->paused = false;
+        session->worker_running = false;
+        StatsSessionState state = session->solution_found         ? kStatsSessionFound
+                                : session->control->cancel.load() ? kStatsSessionCancelled
+                                                                  : kStatsSessionExhausted;
+        stats_.close_session(session->stats_slot, state);
+        RetireSession(*session);
+        break;
+    }
+    if (cancel_group) {
+        CancelGroup(session->group_id, session->id);
+    }
+    if (report) {
+        ReportSolution(*session, &timeline);
+    }
+    if (trace_enabled()) {
+        trace_dump(config_.trace_file);
+    }
+}
+
+// Broadcasts, times and publishes a verified solution. Called without the
+// session's lock: the ticket is encoded under it, the node is called outside it.
+void MinerServiceImpl::ReportSolution(MiningSession& session, SubmitTimeline* timeline) {
+    std::mutex& session_mutex = sessions_.mutex_for(session.id);
+    MiningHeader header;
+    std::string hex;
+    {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        session.solution_found = true;
+        header = session.header;
+        if (config_.auto_broadcast) {
+            hex = HeaderToHex(session);
+        }
+    }
+    if (config_.auto_broadcast) {
+        timeline->serialized = std::chrono::steady_clock::now();
+        bool broadcast_success = BroadcastSolution(session.id, hex, timeline);
+        LOG_INFO("Session {}: valid nonce {:08x} found, solution broadcast {}", session.id, header.nonce,
+                 broadcast_success ? "succeeded" : "failed");
+    }
+    {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        RecordSubmitLatency(session, *timeline);
+    }
+    
+    // Off the submission path: monitors get the winning hash after the node does
+    uint32_t hash[8];
+    SolutionHash(header, hash);
+    stats_.publish_solution(session.id, header.nonce, hash);
+}
+
+// Split mode: a second thread mines the primary's job on another engine.
+// Both claim nonce ranges of the job from the host lease table, so they
+// never hash the same nonces, and the first to solve it marks it solved
+// there, which stops the other. The companion is a private copy sharing the
+// primary's id, budget, caps (one throttle bucket for both) and pause
+// control; it is never registered. A solution it finds is handed to the
+// primary, which reports it.
+void MinerServiceImpl::LaunchCompanion(const std::shared_ptr<MiningSession>& primary) {
+    auto companion = std::make_shared<MiningSession>();
+    {
+        std::lock_guard<std::mutex> lock(sessions_.mutex_for(primary->id));
+        if (!primary->is_mining || !primary->worker_running) {
+            return;  // Ended or paused since it was found
+        }
+        *companion = *primary;
+        primary->companions++;
+    }
+    companion->header = companion->job_header;
+    companion->stats_slot = -1;
+    companion->total_hashes = 0;
+    companion->total_batches = 0;
+    companion->verified_solutions = 0;
+    companion->rejected_solutions = 0;
+    companion->submit_latency = nullptr;
+    companion->companions = 0;
+    companion->companion_hashes = 0;
+    companion->companion_found = false;
+    companion->primary = primary;
+    
+    std::thread mining_thread(&MinerServiceImpl::RunCompanion, this, companion);
+    mining_thread.detach();
+}
+
+void MinerServiceImpl::RunCompanion(std::shared_ptr<MiningSession> companion) {
+    SubmitTimeline timeline;
+    bool success = MineSession(companion.get(), companion->time_limit, &timeline);
+    if (success && !companion->group_id.empty()) {
+        CancelGroup(companion->group_id, companion->id);  // Before the broadcast, so siblings stop now
+    }
+    
+    std::shared_ptr<MiningSession> primary = companion->primary;
+    bool report = false;
+    {
+        std::lock_guard<std::mutex> lock(sessions_.mutex_for(primary->id));
+        primary->companion_hashes += companion->total_hashes;
+        primary->verified_solutions += companion->verified_solutions;
+        primary->rejected_solutions += companion->rejected_solutions;
+        if (success && !primary->solution_found && !primary->companion_found) {
+            primary->companion_found = true;
+            primary->companion_header = companion->header;
+            primary->companion_timeline = timeline;
+            if (!primary->worker_running) {
+                // Parked by a pause while this thread finished its batch: nobody
+                // else is left to close the session
+                primary->header = companion->header;
+                primary->solution_found = true;
+                primary->is_mining = false;
+                primary->paused = false;
+                stats_.close_session(primary->stats_slot, kStatsSessionFound);
+                RetireSession(*primary);
+                report = true;
+            }
+        }
+        primary->companions--;
+        primary->control->companions_done.notify_all();
+    }
+    if (report) {
+        ReportSolution(*primary, &timeline);
+    }
+}
+
+// Speculation: polls the node's supportable leader and keeps the next job
+// it expects (the latest submitted job, one height on, same leader) mining
+// on spare capacity. When that job is submitted, the prediction becomes its
+// session in place, so the switch costs no setup and nothing mined is lost.
+void MinerServiceImpl::RunSpeculation() {
+    std::unique_ptr<BitcoinRPC> rpc;
+    try {
+        // Its own connection: the broadcast path's client is not shared across threads
+        rpc = std::make_unique<BitcoinRPC>(config_.rpc_host, config_.rpc_port, config_.rpc_user, config_.rpc_password);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Speculative mining disabled, RPC client failed: {}", e.what());
+        return;
+    }
+    auto interval = std::chrono::duration<double>(std::max(config_.leader_poll_seconds, 0.1));
+    while (!stopping_) {
+        std::pair<std::string, uint32_t> leader = rpc->getSupportableLeader();
+        if (!leader.first.empty()) {
+            UpdateSpeculation(leader.first, leader.second);
+        }
+        auto next_poll = std::chrono::steady_clock::now() + interval;
+        while (!stopping_ && std::chrono::steady_clock::now() < next_poll) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
+
+void MinerServiceImpl::UpdateSpeculation(const std::string& leader_hex, uint32_t height) {
+    static Counter& discarded = miner_metrics().counter("miner_speculative_jobs_total", "Predicted jobs by outcome",
+                                                        metric_label("result", "discarded"));
+    uint8_t leader[sizeof(MiningHeader::address1)];
+    if (!hex_to_bytes(leader_hex.c_str(), leader, sizeof(leader))) {
+        return;
+    }
+    uint32_t now = (uint32_t)time(nullptr);
+    std::lock_guard<std::mutex> lock(speculation_mutex_);
+    
+    if (speculative_) {
+        // The job header of a prediction never changes, so it is read without the session lock
+        const MiningHeader& predicted = speculative_->job_header;
+        bool passed = height > predicted.value;
+        bool other_leader = height == predicted.value && memcmp(leader, predicted.address1, sizeof(leader)) != 0;
+        bool aged = now > predicted.timestamp + (uint32_t)config_.duplicate_timestamp_window;
+        if (!passed && !other_leader && !aged) {
+            return;  // Still ahead of the chain, or confirmed and waiting for its submission
         }
-    });
+        LOG_INFO("Speculative job for height {} discarded: {}", predicted.value,
+                 passed ? "the chain moved past it" : other_leader ? "another leader" : "its timestamp aged out");
+        speculative_->control->cancel = true;
+        speculative_.reset();
+        discarded.add();
+    }
+    
+    // Predict only from a job for the current tip and leader
+    if (!has_last_job_ || last_job_header_.value != height ||
+        memcmp(last_job_header_.address1, leader, sizeof(leader)) != 0) {
+        return;
+    }
+    auto session = std::make_shared<MiningSession>();
+    session->id = GenerateSessionId();
+    session->is_mining = true;
+    session->header = last_job_header_;
+    session->header.value = height + 1;
+    session->header.timestamp = now;
+    session->header.nonce = 0;
+    session->job_header = session->header;
+    session->ticket_hex = TicketHexTemplate(session->header);
+    session->target = last_job_target_;
+    session->time_limit = (float)config_.max_time_budget;  // Normally settled by the next poll long before
+    session->priority = -1;  // Behind every real job
+    session->start_time = std::chrono::steady_clock::now();
+    session->throttle = std::make_shared<Throttle>();
+    session->throttle->set_limits(0, config_.speculative_share);
+    session->control = std::make_shared<SessionControl>();
+    session->control->speculative = true;
+    session->worker_running = true;
+    speculative_ = session;
+    LOG_INFO("Speculating on height {} with leader {}", height + 1, leader_hex);
+    
+    std::thread mining_thread(&MinerServiceImpl::RunSession, this, session);
     mining_thread.detach();
+}
+
+// Caller holds submit_mutex_. The submitted job is the one predicted: the
+// prediction is registered as its session, with the real budget and caps
+// from now on, keeping its cursor, hashes and any solution it holds.
+bool MinerServiceImpl::PromoteSpeculative(const MiningSession& session, miner::StartMiningResponse* response) {
+    static Counter& promoted = miner_metrics().counter("miner_speculative_jobs_total", "Predicted jobs by outcome",
+                                                       metric_label("result", "promoted"));
+    std::shared_ptr<MiningSession> predicted;
+    {
+        std::lock_guard<std::mutex> lock(speculation_mutex_);
+        if (!speculative_ ||
+            JobKey(speculative_->job_header, speculative_->target) != JobKey(session.header, session.target)) {
+            return false;
+        }
+        int64_t skew = (int64_t)speculative_->job_header.timestamp - (int64_t)session.header.timestamp;
+        if (std::abs(skew) > config_.duplicate_timestamp_window) {
+            return false;
+        }
+        predicted.swap(speculative_);
+    }
+    promoted.add();
+    
+    sessions_.insert(predicted->id, predicted);
+    tracked_sessions_metric_.add(1);
+    bool solved;
+    {
+        std::lock_guard<std::mutex> lock(sessions_.mutex_for(predicted->id));
+        MiningSession& promoted_session = *predicted;
+        promoted_session.group_id = session.group_id;
+        promoted_session.time_limit = session.time_limit;
+        promoted_session.priority = session.priority;
+        promoted_session.start_time = std::chrono::steady_clock::now();
+        promoted_session.stats_slot = stats_.open_session(promoted_session.id);
+        promoted_session.throttle->set_limits(session.throttle ? session.throttle->max_hash_rate() : 0,
+                                              session.throttle ? session.throttle->duty_cycle() : 1);
+        promoted_session.control->speculative = false;
+        RememberJob(promoted_session);
+        if (!promoted_session.group_id.empty()) {
+            std::lock_guard<std::mutex> groups_lock(groups_mutex_);
+            groups_.emplace(promoted_session.group_id, promoted_session.id);
+        }
+        
+        solved = promoted_session.solution_found;
+        if (solved) {
+            // Found while it was a prediction; it goes out below now that the job is real
+            promoted_session.is_mining = false;
+            stats_.close_session(promoted_session.stats_slot, kStatsSessionFound);
+            RetireSession(promoted_session);
+        } else if (!promoted_session.worker_running) {
+            promoted_session.is_mining = true;
+            promoted_session.worker_running = true;
+            std::thread mining_thread(&MinerServiceImpl::RunSession, this, predicted);
+            mining_thread.detach();
+        }
+    }
+    if (solved && !session.group_id.empty()) {
+        CancelGroup(session.group_id, predicted->id);
+    }
+    if (solved) {
+        SubmitTimeline timeline;
+        timeline.found = std::chrono::steady_clock::now();
+        timeline.notified = timeline.found;
+        timeline.verified = timeline.found;
+        ReportSolution(*predicted, &timeline);
+    }
+    LOG_INFO("Session {} takes over the speculative job for height {}{}", predicted->id, session.header.value,
+             solved ? ", already solved" : "");
     
     response->set_success(true);
-    response->set_session_id(session.id);
-    return grpc::Status::OK;
+    response->set_session_id(predicted->id);
+    response->set_message(solved ? "Solved while speculative" : "Started from a speculative session");
+    return true;
 }
 
 grpc::Status MinerServiceImpl::PauseMining(
@@ -131,32 +1159,110 @@ grpc::Status MinerServiceImpl::PauseMining(
     const miner::PauseMiningRequest* request,
     miner::PauseMiningResponse* response) {
     
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
-    auto it = sessions_.find(request->session_id());
-    if (it == sessions_.end()) {
-        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Session not found");
-    }
-    
-    auto& session = it->second;
-    if (!session.is_mining) {
-        return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Session is not mining");
-    }
-    
-    session.is_mining = false;
-    std::string state_file = SaveMiningState(session);
-    if (state_file.empty()) {
-        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to save mining state");
+    std::string state_file;
+    {
+        auto locked = sessions_.lock(request->session_id());
+        if (!locked) {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "Session not found");
+        }
+        
+        auto& session = *locked;
+        SyncCoordinatedSession(session);
+        if (!session.is_mining && !(request->cancel() && session.paused)) {
+            return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Session is not mining");
+        }
+        
+        if (request->cancel()) {
+            // Stopped for good, mining or paused: nothing to resume, so nothing is spilled
+            CancelSession(session);
+        } else {
+            PauseSession(session, &state_file);
+        }
     }
     
+    // A session still queued for an engine stops waiting
+    engine_pool_.wake_waiters();
+    response->set_success(true);
+    response->set_message(request->cancel() ? "Session cancelled" : "Session paused");
+    // Still being written; GetStatusV2 names it once it is on disk
     response->set_state_file(state_file);
     return grpc::Status::OK;
 }
 
+// Caller holds the session's lock
+void MinerServiceImpl::PauseSession(MiningSession& session, std::string* state_file) {
+    // The mining thread stops at its next batch and parks the session. It
+    // stays in memory until it is resumed, its group ends or its TTL runs out.
+    session.is_mining = false;
+    session.paused = true;
+    session.paused_elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - session.start_time).count();
+    session.control->pause = true;
+    session.control->pauses++;
+    ForgetJob(session);
+    sessions_.park_locked(session.id);
+    if (coordinator_) {
+        // Resumed from the lowest range workers have not completed
+        LeaseJobProgress progress;
+        if (coordinator_->book().finish_job(session.id, &progress)) {
+            session.header = progress.frontier;
+            session.total_hashes = progress.hashes;
+        }
+        session.hash_rate = 0;
+    }
+    if (config_.spill_paused_sessions) {
+        // The cursor so far, written in the background; the mining thread
+        // rewrites it with the final one as it parks
+        *state_file = StateFile(session);
+        spiller_.spill(*state_file, session.header, session.target);
+        session.spilled = true;
+    }
+}
+
 grpc::Status MinerServiceImpl::ResumeMining(
     grpc::ServerContext* context,
     const miner::ResumeMiningRequest* request,
     miner::ResumeMiningResponse* response) {
     
+    if (!request->session_id().empty()) {
+        auto locked = sessions_.lock(request->session_id());
+        if (locked) {
+            MiningSession& session = *locked;
+            if (!session.paused) {
+                return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Session is not paused");
+            }
+            
+            // time_limit 0 keeps what was left of the budget, otherwise it is the budget from now
+            float budget = request->time_limit() > 0 ? (float)request->time_limit()
+                                                     : session.time_limit - session.paused_elapsed;
+            session.time_limit = session.paused_elapsed + budget;
+            session.start_time = std::chrono::steady_clock::now() -
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<float>(session.paused_elapsed));
+            session.paused = false;
+            session.is_mining = true;
+            session.control->pause = false;
+            sessions_.unpark_locked(session.id);
+            RememberJob(session);
+            
+            if (coordinator_) {
+                coordinator_->book().add_job(session.id, session.header, session.target, budget,
+                                             session.total_hashes);
+            } else if (!session.worker_running) {
+                session.worker_running = true;
+                std::thread mining_thread(&MinerServiceImpl::RunSession, this, locked.share());
+                mining_thread.detach();
+            }
+            response->set_success(true);
+            response->set_session_id(session.id);
+            return grpc::Status::OK;
+        }
+        if (request->state_file().empty()) {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "Session not found");
+        }
+        // Not in memory, e.g. after a restart: carry on from the cursor it spilled
+    }
+    
+    // From a state file, e.g. after a restart: a new session at the saved cursor
     MiningSession session;
     session.id = GenerateSessionId();
     session.is_mining = true;
@@ -164,32 +1270,12 @@ grpc::Status MinerServiceImpl::ResumeMining(
     if (!load_mining_state(request->state_file().c_str(), &session.header, &session.target)) {
         return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to load mining state");
     }
+    session.ticket_hex = TicketHexTemplate(session.header);
+    session.time_limit = TimeBudget(session.target, request->time_limit());
+    session.priority = SchedulePriority(session.target, 1.0);
     
-    // Store session
-    {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        sessions_[session.id] = session;
-    }
-    
-    // Start mining in a new thread
-    std::thread mining_thread([this, session_id = session.id]() {
-        MiningSession* session = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(sessions_mutex_);
-            auto it = sessions_.find(session_id);
-            if (it != sessions_.end()) {
-                session = &it->second;
-            }
-        }
-        if (session) {
-            bool success = mine_block(&session->header, session->target);
-            std::lock_guard<std::mutex> lock(sessions_mutex_);
-            session->is_mining = !success; // Set is_mining to false when mining succeeds
-        }
-    });
-    mining_thread.detach();
-    
-    response->set_session_id(session.id);
+    response->set_success(true);
+    response->set_session_id(LaunchSession(session));
     return grpc::Status::OK;
 }
 
@@ -198,112 +1284,302 @@ grpc::Status MinerServiceImpl::GetStatus(
     const miner::GetStatusRequest* request,
     miner::GetStatusResponse* response) {
     
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
-    auto it = sessions_.find(request->session_id());
-    if (it == sessions_.end()) {
+    auto locked = sessions_.lock(request->session_id());
+    if (!locked) {
         return grpc::Status(grpc::StatusCode::NOT_FOUND, "Session not found");
     }
     
-    const auto& session = it->second;
+    auto& session = *locked;
+    SyncCoordinatedSession(session);
     response->set_is_mining(session.is_mining);
     response->set_current_nonce(std::to_string(session.header.nonce));
+    response->set_total_hashes(session.total_hashes + session.companion_hashes);
+    response->set_hash_rate(session.hash_rate / 1e6);
+    
+    response->set_verified_solutions(session.verified_solutions);
+    response->set_rejected_solutions(session.rejected_solutions);
     
     // If mining is complete, include the solution
-    if (!session.is_mining) {
+    if (session.solution_found) {
         std::stringstream ss;
         ss << "Mining complete. Found nonce: 0x" << std::hex << session.header.nonce;
         response->set_message(ss.str());
+    } else if (!session.cancelled_by.empty()) {
+        response->set_message("Cancelled: session " + session.cancelled_by + " of the group found a solution");
+    } else if (session.control->cancel) {
+        response->set_message("Mining cancelled");
+    } else if (session.paused) {
+        response->set_message("Mining paused");
+    } else if (!session.is_mining) {
+        response->set_message("Mining finished without a solution");
     }
     
     return grpc::Status::OK;
 }
 
-std::string MinerServiceImpl::HeaderToHex(const MiningHeader& header) {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    
-    // Version prefix
-    ss << "20";
+static void FillLatencySummaries(const SubmitLatency& latency,
+                                 google::protobuf::RepeatedPtrField<miner::LatencySummary>* out) {
+    for (int h = 0; h < kSubmitHops; h++) {
+        const HdrHistogram& histogram = latency.hop((SubmitHop)h);
+        miner::LatencySummary* summary = out->Add();
+        summary->set_hop(SubmitLatency::hop_name((SubmitHop)h));
+        summary->set_count(histogram.count());
+        summary->set_p50_ms(histogram.percentile(50) / 1e6);
+        summary->set_p99_ms(histogram.percentile(99) / 1e6);
+        summary->set_p999_ms(histogram.percentile(99.9) / 1e6);
+        summary->set_max_ms(histogram.max() / 1e6);
+    }
+}
+
+grpc::Status MinerServiceImpl::GetStatusV2(
+    grpc::ServerContext* context,
+    const miner::GetStatusRequest* request,
+    miner::GetStatusV2Response* response) {
     
-    // Hash (32 bytes)
-    for (int i = 0; i < header.hash_length; i++) {
-        ss << std::setw(2) << (int)header.hash[i];
+    auto locked = sessions_.lock(request->session_id());
+    if (!locked) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Session not found");
+    }
+    FillStatusV2(*locked, response);
+    return grpc::Status::OK;
+}
+
+void MinerServiceImpl::FillStatusV2(MiningSession& session, miner::GetStatusV2Response* response) {
+    SyncCoordinatedSession(session);
+    response->set_is_mining(session.is_mining);
+    response->set_total_hashes(session.total_hashes + session.companion_hashes);
+    response->set_hash_rate(session.hash_rate / 1e6);
+    response->set_current_nonce(session.header.nonce);
+    response->set_solution_found(session.solution_found);
+    response->set_time_to_first_hash_ms(session.first_hash_ms);
+    if (session.submit_latency) {
+        FillLatencySummaries(*session.submit_latency, response->mutable_submit_latency());
     }
     
-    // Address1 (20 bytes) with length prefix
-    ss << "14";  // Length prefix (20)
-    for (int i = 0; i < header.address1_length; i++) {
-        ss << std::setw(2) << (int)header.address1[i];
+    response->set_verified_solutions(session.verified_solutions);
+    response->set_rejected_solutions(session.rejected_solutions);
+    
+    // Solutions are memoryless, so the ETA is the full expected time at the
+    // current rate however long the session has run
+    response->set_difficulty(target_difficulty(session.target));
+    response->set_expected_hashes(expected_hashes(session.target));
+    response->set_success_probability(
+        success_probability((double)(session.total_hashes + session.companion_hashes), session.target));
+    response->set_eta_seconds(session.solution_found ? 0.0 : expected_seconds(session.target, session.hash_rate));
+    response->set_time_limit(session.time_limit);
+    response->set_paused(session.paused);
+    response->set_cancelled_by(session.cancelled_by);
+    if (session.paused && config_.spill_paused_sessions && spiller_.written(StateFile(session))) {
+        response->set_state_file(StateFile(session));
     }
+}
+
+grpc::Status MinerServiceImpl::WatchStatus(
+    grpc::ServerContext* context,
+    const miner::WatchStatusRequest* request,
+    grpc::ServerWriter<miner::GetStatusV2Response>* writer) {
     
-    // Value (block height) - 4 bytes little-endian
-    ss << std::setw(2) << (header.value & 0xFF)           // Lowest byte
-       << std::setw(2) << ((header.value >> 8) & 0xFF)    // Low byte
-       << std::setw(2) << ((header.value >> 16) & 0xFF)   // High byte
-       << std::setw(2) << ((header.value >> 24) & 0xFF);  // Highest byte
+    auto interval = std::chrono::milliseconds(std::max<uint32_t>(request->interval_ms(), 50));
+    if (request->interval_ms() == 0) {
+        interval = std::chrono::milliseconds(250);
+    }
     
-    // Address2 (20 bytes) with length prefix
-    ss << "14";  // Length prefix (20)
-    for (int i = 0; i < header.address2_length; i++) {
-        ss << std::setw(2) << (int)header.address2[i];
+    // One update per interval until the session ends (the last one says so) or the client goes away
+    for (;;) {
+        miner::GetStatusV2Response response;
+        {
+            auto locked = sessions_.lock(request->session_id());
+            if (!locked) {
+                return grpc::Status(grpc::StatusCode::NOT_FOUND, "Session not found");
+            }
+            FillStatusV2(*locked, &response);
+        }
+        if (!writer->Write(response) || !response.is_mining()) {
+            return grpc::Status::OK;
+        }
+        if (context->IsCancelled()) {
+            return grpc::Status::CANCELLED;
+        }
+        std::this_thread::sleep_for(interval);
     }
+}
+
+grpc::Status MinerServiceImpl::GetMetrics(
+    grpc::ServerContext* context,
+    const miner::GetMetricsRequest* request,
+    miner::GetMetricsResponse* response) {
     
-    // Flag (1 byte) - should be 0 or 1
-    ss << std::setw(2) << (int)header.flag;
+    MetricsRegistry& metrics = miner_metrics();
+    for (const MetricSample& sample : metrics.collect()) {
+        miner::MetricSample* out = response->add_samples();
+        out->set_name(sample.name);
+        out->set_labels(sample.labels);
+        out->set_value(sample.value);
+    }
+    response->set_text(metrics.render_text() +
+                       global_submit_latency().render_text("miner_submit_latency_seconds"));
+    FillLatencySummaries(global_submit_latency(), response->mutable_submit_latency());
+    return grpc::Status::OK;
+}
+
+grpc::Status MinerServiceImpl::SetThrottle(
+    grpc::ServerContext* context,
+    const miner::SetThrottleRequest* request,
+    miner::SetThrottleResponse* response) {
     
-    // Timestamp (4 bytes)
-    ss << std::setw(2) << (header.timestamp & 0xFF)
-       << std::setw(2) << ((header.timestamp >> 8) & 0xFF)
-       << std::setw(2) << ((header.timestamp >> 16) & 0xFF)
-       << std::setw(2) << ((header.timestamp >> 24) & 0xFF);
+    if (request->max_hash_rate() < 0 || request->duty_cycle() < 0 || request->duty_cycle() > 1) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid throttle");
+    }
     
-    // Nonce (4 bytes)
-    ss << std::setw(2) << (header.nonce & 0xFF)
-       << std::setw(2) << ((header.nonce >> 8) & 0xFF)
-       << std::setw(2) << ((header.nonce >> 16) & 0xFF)
-       << std::setw(2) << ((header.nonce >> 24) & 0xFF);
+    // Miners re-read the limits before every launch, so no restart is needed
+    if (request->session_id().empty()) {
+        if (coordinator_) {
+            return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Coordinator has no engines to throttle");
+        }
+        for (auto& throttle : engine_throttles_) {
+            throttle->set_limits(request->max_hash_rate(), request->duty_cycle());
+        }
+        LOG_INFO("Engines capped at {:.1f} MH/s, duty cycle {:.2f}", request->max_hash_rate() / 1e6,
+                 engine_throttles_.empty() ? 1.0 : engine_throttles_[0]->duty_cycle());
+    } else {
+        auto locked = sessions_.lock(request->session_id());
+        if (!locked) {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "Session not found");
+        }
+        locked->throttle->set_limits(request->max_hash_rate(), request->duty_cycle());
+        LOG_INFO("Session {} capped at {:.1f} MH/s, duty cycle {:.2f}", locked->id, request->max_hash_rate() / 1e6,
+                 locked->throttle->duty_cycle());
+    }
     
-    return ss.str();
+    response->set_success(true);
+    response->set_message("Throttle updated");
+    return grpc::Status::OK;
 }
 
-bool MinerServiceImpl::BroadcastSolution(const MiningHeader& header) {
-    if (!bitcoin_rpc_) {
-        std::cout << "Bitcoin RPC client not initialized, skipping broadcast" << std::endl;
-        return false;
+// Fills a check from one request entry, or returns why it can't be checked
+static const char* TicketFromRequest(const miner::TicketToVerify& ticket, const Target* default_target,
+                                     TicketCheck* check) {
+    if (ticket.target().size() == TicketLayout::kHashSize) {
+        check->target = target_from_bytes(reinterpret_cast<const uint8_t*>(ticket.target().data()));
+    } else if (ticket.target().empty() && default_target) {
+        check->target = *default_target;
+    } else {
+        return "Invalid or missing target";
     }
     
-    try {
-        std::string hex = HeaderToHex(header);
-        std::cout << "\nPreparing to broadcast solution:" << std::endl;
-        std::cout << "Hash length: " << (int)header.hash_length << std::endl;
-        std::cout << "Hash: ";
-        for (int i = 0; i < header.hash_length; i++) {
-            std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)header.hash[i];
-        }
-        std::cout << std::endl;
-        
-        std::cout << "Address1 length: " << (int)header.address1_length << std::endl;
-        std::cout << "Address1: ";
-        for (int i = 0; i < header.address1_length; i++) {
-            std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)header.address1[i];
+    MiningHeader& header = check->header;
+    if (!ticket.ticket().empty()) {
+        if (ticket.ticket().size() != TicketLayout::kSize ||
+            !parse_ticket(reinterpret_cast<const uint8_t*>(ticket.ticket().data()), &header)) {
+            return "Malformed ticket";
         }
-        std::cout << std::endl;
-        
-        std::cout << "Value: " << std::hex << header.value << std::endl;
-        
-        std::cout << "Address2 length: " << (int)header.address2_length << std::endl;
-        std::cout << "Address2: ";
-        for (int i = 0; i < header.address2_length; i++) {
-            std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)header.address2[i];
+        return nullptr;
+    }
+    if (ticket.hash().size() != sizeof(MiningHeader::hash) ||
+        ticket.addr1().size() != sizeof(MiningHeader::address1) ||
+        ticket.addr2().size() != sizeof(MiningHeader::address2)) {
+        return "Invalid field length";
+    }
+    header.hash_length = 32;
+    header.address1_length = 20;
+    header.address2_length = 20;
+    memcpy(header.hash, ticket.hash().data(), sizeof(header.hash));
+    memcpy(header.address1, ticket.addr1().data(), sizeof(header.address1));
+    memcpy(header.address2, ticket.addr2().data(), sizeof(header.address2));
+    header.value = ticket.value();
+    header.timestamp = ticket.timestamp();
+    header.flag = (uint8_t)ticket.flag();
+    header.nonce = ticket.nonce();
+    return nullptr;
+}
+
+grpc::Status MinerServiceImpl::VerifyTickets(
+    grpc::ServerContext* context,
+    grpc::ServerReaderWriter<miner::VerifyTicketsResponse, miner::VerifyTicketsRequest>* stream) {
+    
+    static const int kMaxTicketsPerMessage = 65536;
+    miner::VerifyTicketsRequest request;
+    std::vector<TicketCheck> checks;
+    std::vector<const char*> errors;
+    std::vector<size_t> positions;  // Request index of each check
+    
+    // Buffers are reused across messages; a message is answered before the next is read
+    while (stream->Read(&request)) {
+        const int count = request.tickets_size();
+        if (count > kMaxTicketsPerMessage) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Too many tickets in one message");
+        }
+        Target default_target;
+        bool has_default = request.target().size() == TicketLayout::kHashSize;
+        if (has_default) {
+            default_target = target_from_bytes(reinterpret_cast<const uint8_t*>(request.target().data()));
+        } else if (!request.target().empty()) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid target length");
         }
-        std::cout << std::endl;
         
-        std::cout << "Nonce: " << std::hex << header.nonce << std::endl;
-        std::cout << "Full hex: " << hex << std::endl;
+        checks.resize(count);
+        errors.assign(count, nullptr);
+        positions.clear();
+        size_t ready = 0;
+        for (int i = 0; i < count; i++) {
+            errors[i] = TicketFromRequest(request.tickets(i), has_default ? &default_target : nullptr,
+                                          &checks[ready]);
+            if (!errors[i]) {
+                positions.push_back(i);
+                ready++;
+            }
+        }
+        ticket_checks_.check(checks.data(), ready);
         
-        return bitcoin_rpc_->broadcastSupportTicket(hex);
+        miner::VerifyTicketsResponse response;
+        for (int i = 0; i < count; i++) {
+            miner::TicketVerdict* verdict = response.add_verdicts();
+            if (errors[i]) {
+                verdict->set_error(errors[i]);
+            }
+        }
+        for (size_t i = 0; i < ready; i++) {
+            const TicketCheck& check = checks[i];
+            uint8_t hash[TicketLayout::kHashSize];
+            for (int w = 0; w < 8; w++) {
+                hash[w * 4] = (uint8_t)(check.hash[w] >> 24);
+                hash[w * 4 + 1] = (uint8_t)(check.hash[w] >> 16);
+                hash[w * 4 + 2] = (uint8_t)(check.hash[w] >> 8);
+                hash[w * 4 + 3] = (uint8_t)check.hash[w];
+            }
+            miner::TicketVerdict* verdict = response.mutable_verdicts((int)positions[i]);
+            verdict->set_valid(check.valid);
+            verdict->set_hash(hash, sizeof(hash));
+        }
+        if (!stream->Write(response)) {
+            break;  // Client went away
+        }
+    }
+    return grpc::Status::OK;
+}
+
+std::string MinerServiceImpl::HeaderToHex(MiningSession& session) {
+    TraceSpan span("HeaderToHex");
+    // Everything but the per-nonce fields was encoded when the job started
+    session.ticket_hex.set_timestamp(session.header.timestamp);
+    session.ticket_hex.set_nonce(session.header.nonce);
+    return session.ticket_hex.str();
+}
+
+// Called without any session lock: the node round trip must not hold up
+// status calls or submissions
+bool MinerServiceImpl::BroadcastSolution(const std::string& session_id, const std::string& hex,
+                                         SubmitTimeline* timeline) {
+    if (!bitcoin_rpc_) {
+        LOG_WARNING("Bitcoin RPC client not initialized, skipping broadcast");
+        return false;
+    }
+    
+    try {
+        // The ticket goes straight out; the hex (logged by the RPC client) carries every field
+        return bitcoin_rpc_->broadcastSupportTicket(hex, timeline);
     } catch (const std::exception& e) {
-        std::cerr << "Failed to broadcast solution: " << e.what() << std::endl;
+        LOG_ERROR("Failed to broadcast solution for session {}: {}", session_id, e.what());
         return false;
     }
 }
@@ -5,17 +5,72 @@
 #include "miner.cuh"
 #include "bitcoin_rpc.hpp"
 #include "miner_config.hpp"
+#include "ticket_verifier.hpp"
+#include "support_ticket.hpp"
+#include "engine_pool.hpp"
+#include "submit_latency.hpp"
+#include "stats_segment.hpp"
+#include "lease_coordinator.hpp"
+#include "host_lease_table.hpp"
+#include "throttle.hpp"
+#include "ticket_check_pool.hpp"
+#include "state_spill.hpp"
+#include "session_registry.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <string>
+#include <thread>
 #include <map>
+#include <unordered_map>
 #include <mutex>
 #include <memory>
+#include <vector>
+
+// Read by the mining thread at every batch, without the session lock
+struct SessionControl {
+    std::atomic<bool> pause{false};
+    std::atomic<uint64_t> pauses{0};  // Bumped by every pause, so a run knows it was interrupted
+    std::atomic<bool> cancel{false};  // A session of its group found a solution; never cleared
+    std::atomic<bool> speculative{false};  // Mining a predicted job: runs behind real work and yields to it
+    std::condition_variable companions_done;  // Notified under the session lock as a companion ends
+    
+    bool stopped() const { return pause.load(std::memory_order_relaxed) || cancel.load(std::memory_order_relaxed); }
+};
 
 struct MiningSession {
     std::string id;
+    std::string group_id;          // Sessions of a group stop as soon as one of them solves
+    std::string cancelled_by;      // The sibling whose solution ended this session
     bool is_mining;
-    MiningHeader header;
+    bool solution_found = false;
+    MiningHeader header;           // Cursor: the mining thread advances the nonce
+    MiningHeader job_header;       // Header as submitted, identifies the job
     Target target;
     float time_limit;
+    TicketHexTemplate ticket_hex;  // Built once per job, nonce patched at broadcast
+    std::chrono::steady_clock::time_point start_time;
+    double first_hash_ms = 0;      // Start to first completed batch, 0 until then
+    std::shared_ptr<SubmitLatency> submit_latency;  // Created with the first solution
+    int stats_slot = -1;           // Live stats segment entry, -1 if not published
+    uint64_t total_hashes = 0;     // Refreshed about every 0.5 s while mining, exact once a run ends
+    uint64_t total_batches = 0;    // Batches of finished runs
+    double hash_rate = 0;          // Hashes per second over the last window
+    uint64_t verified_solutions = 0;  // This session's solutions that passed CPU re-verification
+    uint64_t rejected_solutions = 0;  // and that failed it, refreshed with total_hashes
+    double priority = 0;           // Engine pool rank, see schedule_by_expected_time
+    std::shared_ptr<Throttle> throttle;  // Session cap, changed live by SetThrottle
+    std::shared_ptr<SessionControl> control;
+    bool paused = false;           // Parked in memory with its cursor, resumable by id
+    bool spilled = false;          // Has a state file, deleted when the session ends
+    bool worker_running = false;   // A mining thread owns the session
+    float paused_elapsed = 0;      // Seconds of the budget used when paused
+    std::shared_ptr<MiningSession> primary;  // Split-mode companions only: the session they mine for
+    int companions = 0;            // Companion threads still mining for this session
+    uint64_t companion_hashes = 0; // Hashed for this session by companions that have finished
+    bool companion_found = false;  // A companion solved the ticket while this session's thread ran
+    MiningHeader companion_header; // Its winning ticket, reported by this session's thread
+    SubmitTimeline companion_timeline;
 };
 
 class MinerServiceImpl final : public miner::MinerService::Service {
@@ -39,14 +94,96 @@ public:
                           const miner::GetStatusRequest* request,
                           miner::GetStatusResponse* response) override;
 
+    grpc::Status StartMiningV2(grpc::ServerContext* context,
+                              const miner::StartMiningV2Request* request,
+                              miner::StartMiningResponse* response) override;
+
+    grpc::Status GetStatusV2(grpc::ServerContext* context,
+                            const miner::GetStatusRequest* request,
+                            miner::GetStatusV2Response* response) override;
+
+    // Streams GetStatusV2 snapshots at the requested interval until the session ends
+    grpc::Status WatchStatus(grpc::ServerContext* context,
+                            const miner::WatchStatusRequest* request,
+                            grpc::ServerWriter<miner::GetStatusV2Response>* writer) override;
+
+    grpc::Status GetMetrics(grpc::ServerContext* context,
+                           const miner::GetMetricsRequest* request,
+                           miner::GetMetricsResponse* response) override;
+
+    grpc::Status SetThrottle(grpc::ServerContext* context,
+                            const miner::SetThrottleRequest* request,
+                            miner::SetThrottleResponse* response) override;
+
+    // Hashes each message's tickets on the check pool and answers with one verdict per ticket
+    grpc::Status VerifyTickets(grpc::ServerContext* context,
+                              grpc::ServerReaderWriter<miner::VerifyTicketsResponse,
+                                                       miner::VerifyTicketsRequest>* stream) override;
+
+    // Lease service to register alongside this one, null unless in coordinator mode
+    grpc::Service* coordinator_service() { return coordinator_.get(); }
+
 private:
     std::string GenerateSessionId();
-    std::string SaveMiningState(const MiningSession& session);
-    bool BroadcastSolution(const MiningHeader& header);
-    std::string HeaderToHex(const MiningHeader& header);
+    void SubmitJob(const MiningSession& session, miner::StartMiningResponse* response);
+    std::shared_ptr<MiningSession> FindDuplicate(const MiningSession& session);
+    void RememberJob(const MiningSession& session);
+    void ForgetJob(const MiningSession& session);
+    void RetireSession(MiningSession& session);
+    void ForgetGroup(const MiningSession& session);
+    std::string LaunchSession(const MiningSession& session);
+    void RunSession(std::shared_ptr<MiningSession> session);
+    void LaunchCompanion(const std::shared_ptr<MiningSession>& primary);
+    void RunCompanion(std::shared_ptr<MiningSession> companion);
+    void ReportSolution(MiningSession& session, SubmitTimeline* timeline);
+    void CancelGroup(const std::string& group_id, const std::string& winner_id);
+    void CancelSession(MiningSession& session);
+    void PauseSession(MiningSession& session, std::string* state_file);
+    void RunSpeculation();
+    void UpdateSpeculation(const std::string& leader, uint32_t height);
+    bool PromoteSpeculative(const MiningSession& session, miner::StartMiningResponse* response);
+    std::string StateFile(const MiningSession& session) const;
+    float TimeBudget(const Target& target, uint32_t requested);
+    double SchedulePriority(const Target& target, double weight) const;
+    bool MineSession(MiningSession* session, float time_limit, SubmitTimeline* timeline);
+    bool MineHostLeases(MiningSession* session, MiningEngine& engine, TicketVerifier& verifier, float time_limit,
+                        const BatchCallback& on_batch, SubmitTimeline* timeline, VerifyCounts* counts);
+    void RecordSubmitLatency(MiningSession& session, const SubmitTimeline& timeline);
+    bool BroadcastSolution(const std::string& session_id, const std::string& hex, SubmitTimeline* timeline);
+    std::string HeaderToHex(MiningSession& session);
+    void FillStatusV2(MiningSession& session, miner::GetStatusV2Response* response);
+    void CompleteCoordinatedSession(const std::string& session_id, const MiningHeader& header, uint64_t hashes);
+    void SyncCoordinatedSession(MiningSession& session);
+    void ArchiveSession(const MiningSession& session);
 
-    std::map<std::string, MiningSession> sessions_;
-    std::mutex sessions_mutex_;
+    SessionRegistry<MiningSession> sessions_;  // A session's fields are under its shard's lock
+    std::mutex archive_mutex_;
+    std::mutex submit_mutex_;  // Makes the duplicate check and the launch of a new job one step
+    std::mutex jobs_mutex_;
+    std::unordered_multimap<std::string, std::string> jobs_;  // Job key to ids of sessions mining it, under jobs_mutex_
+    std::mutex groups_mutex_;
+    std::unordered_multimap<std::string, std::string> groups_;  // Group id to its unfinished sessions, under groups_mutex_
+    std::mutex engine_rate_mutex_;
+    double engine_hash_rate_ = 0;  // Smoothed per-engine rate of recent sessions, under engine_rate_mutex_
     MinerConfig config_;
+    EnginePool engine_pool_;
+    std::vector<std::unique_ptr<TicketVerifier>> verifiers_;  // One per pool engine
+    std::vector<std::unique_ptr<Throttle>> engine_throttles_;  // One per pool engine
+    std::vector<double> engine_full_rates_;  // Unthrottled rate per engine, used by its lease holder
+    Gauge& active_sessions_metric_;
+    Gauge& tracked_sessions_metric_;
+    StatsSegment stats_;
+    std::unique_ptr<LeaseCoordinatorImpl> coordinator_;
+    HostLeaseTable host_leases_;
     std::unique_ptr<BitcoinRPC> bitcoin_rpc_;
+    TicketCheckPool ticket_checks_;
+    StateSpiller spiller_;
+    
+    std::mutex speculation_mutex_;
+    std::shared_ptr<MiningSession> speculative_;  // Predicted next job, not registered until submitted
+    bool has_last_job_ = false;  // Latest submitted job, the template for predictions
+    MiningHeader last_job_header_;
+    Target last_job_target_;
+    std::atomic<bool> stopping_{false};
+    std::thread speculation_thread_;  // Last member: started once everything it uses exists
 };
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "stats_segment.hpp"
+
+// Prints the live stats segment published by a running server. Reads the
+// shared memory directly, so polling it never reaches the service threads.
+
+void PrintUsage() {
+    printf("Miner live stats reader\n");
+    printf("Usage: miner_stats [options]\n\n");
+    printf("Options:\n");
+    printf("  -h, --help            Show this help message\n");
+    printf("  --name <segment>      Stats segment name (default: %s)\n", kStatsDefaultName);
+    printf("  --watch <seconds>     Print again every interval until interrupted\n");
+}
+
+static const char* state_name(uint32_t state) {
+    switch (state) {
+        case kStatsSessionWaiting: return "waiting";
+        case kStatsSessionMining: return "mining";
+        case kStatsSessionFound: return "found";
+        case kStatsSessionExhausted: return "exhausted";
+        case kStatsSessionCancelled: return "cancelled";
+        default: return "free";
+    }
+}
+
+static double age_seconds(uint64_t now_ns, uint64_t then_ns) {
+    return then_ns && now_ns > then_ns ? (now_ns - then_ns) / 1e9 : 0.0;
+}
+
+static void PrintStats(const StatsSegmentReader& reader) {
+    const StatsSegmentHeader& header = reader.layout()->header;
+    uint64_t now = stats_now_ns();
+    printf("Server pid %u, up %.1f s\n\n", header.pid, age_seconds(now, header.started_ns));
+
+    printf("%-3s %-8s %-6s %16s %14s\n", "#", "engine", "state", "hashes", "MH/s");
+    for (int i = 0; i < kStatsMaxEngines; i++) {
+        StatsEngine engine;
+        if (!reader.read_engine(i, &engine) || !engine.present) {
+            continue;
+        }
+        printf("%-3d %-8.16s %-6s %16llu %14.2f\n", i, engine.name, engine.busy ? "busy" : "idle",
+               (unsigned long long)engine.hashes, engine.hash_rate / 1e6);
+    }
+
+    printf("\n%-36s %-9s %6s %10s %14s %10s %10s %8s\n",
+           "session", "state", "engine", "cursor", "hashes", "batches", "MH/s", "age s");
+    for (int i = 0; i < kStatsMaxSessions; i++) {
+        StatsSession session;
+        if (!reader.read_session(i, &session) || session.state == kStatsSessionFree) {
+            continue;
+        }
+        printf("%-36.40s %-9s %6d %10u %14llu %10llu %10.2f %8.1f\n", session.id, state_name(session.state),
+               session.engine, session.cursor, (unsigned long long)session.hashes,
+               (unsigned long long)session.batches, session.hash_rate / 1e6,
+               age_seconds(now, session.started_ns));
+    }
+
+    StatsSolution solution;
+    if (reader.read_solution(&solution) && solution.count > 0) {
+        printf("\nLast solution (%llu total): session %.40s, nonce %08x, %.1f s ago\n  hash ",
+               (unsigned long long)solution.count, solution.session_id, solution.nonce,
+               age_seconds(now, solution.found_ns));
+        for (int w = 0; w < 8; w++) {
+            printf("%08x", solution.hash[w]);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string name = kStatsDefaultName;
+    double watch_seconds = 0;
+
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "-h" || args[i] == "--help") {
+            PrintUsage();
+            return 0;
+        }
+        else if (args[i] == "--name" && i + 1 < args.size()) {
+            name = args[++i];
+        }
+        else if (args[i] == "--watch" && i + 1 < args.size()) {
+            watch_seconds = std::stod(args[++i]);
+        }
+    }
+
+    StatsSegmentReader reader;
+    if (!reader.open(name)) {
+        fprintf(stderr, "No stats segment '%s' (server not running, or a different version)\n", name.c_str());
+        return 1;
+    }
+
+    for (;;) {
+        PrintStats(reader);
+        if (watch_seconds <= 0) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(watch_seconds));
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include "miner.cuh"
+#include "support_ticket.hpp"
+
+// Outcome of one batch of nonces
+struct BatchResult {
+    uint32_t base_nonce;  // First nonce of the batch
+    uint32_t count;       // Nonces covered by the batch
+    bool found;           // A nonce in the batch meets the target
+    uint32_t nonce;       // Winning nonce when found
+    uint32_t hash[8];     // Engine-reported hash of the winner (display word order)
+    std::chrono::steady_clock::time_point found_at;  // When the host-side engine saw the winner
+};
+
+// A hashing backend driven by the launch pipeline (mining_pipeline.hpp).
+// Buffers stay resident for the engine's lifetime; set_job uploads the job
+// constants once, then batches are launched into slots asynchronously and
+// collected in the order they were launched.
+class MiningEngine {
+public:
+    virtual ~MiningEngine() {}
+
+    // Engine name used for verifier counters and logs ("cuda", "cpu", ...)
+    virtual const char* name() const = 0;
+
+    // Nonces covered by one launch
+    virtual uint32_t batch_size() const = 0;
+
+    // Number of launches that can be in flight at once
+    virtual int slots() const = 0;
+
+    // Upload the constants for a new job; no launches may be in flight
+    virtual bool set_job(const TicketJobConstants& job, const Target& target) = 0;
+
+    // Start hashing [base_nonce, base_nonce + batch_size()) into a free slot
+    virtual bool launch(int slot, uint32_t base_nonce) = 0;
+
+    // Wait for the batch in a slot to finish and fetch its result
+    virtual bool collect(int slot, BatchResult* result) = 0;
+};
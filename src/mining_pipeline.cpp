@@ -0,0 +1,136 @@
+#include "mining_pipeline.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+bool run_pipeline(MiningEngine& engine, MiningHeader* header, const Target& target,
+                  float time_limit, uint32_t* out_hash,
+                  const BatchCallback& on_batch, PipelineStats* stats) {
+    PipelineStats local_stats;
+    PipelineStats& st = stats ? *stats : local_stats;
+    st.hashes = 0;
+    st.batches = 0;
+    st.elapsed = 0;
+    st.next_nonce = header->nonce;
+
+    // Job constants are uploaded once, launches only carry the base nonce
+    {
+        TraceSpan span("job_setup");
+        TicketJobConstants job;
+        build_job_constants(*header, &job);
+        if (!engine.set_job(job, target)) {
+            return false;
+        }
+    }
+
+    // Looked up once per job; recording at the batch boundary is lock-free
+    MetricsRegistry& metrics = miner_metrics();
+    const std::string engine_label = metric_label("engine", engine.name());
+    Counter& hashes_metric = metrics.counter("miner_hashes_total", "Nonces hashed", engine_label);
+    Counter& stale_metric = metrics.counter("miner_stale_hashes_total",
+        "Nonces hashed by batches still in flight after the job was solved", engine_label);
+    Gauge& in_flight_metric = metrics.gauge("miner_batches_in_flight",
+        "Batches launched and not yet collected", engine_label);
+    Histogram& batch_metric = metrics.histogram("miner_batch_seconds",
+        "Time from batch launch to collect", engine_label,
+        Histogram::exponential_bounds(0.0005, 2, 14));
+
+    const int slots = engine.slots();
+    const uint32_t batch = engine.batch_size();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::chrono::steady_clock::time_point> launched_at(slots);
+
+    // Fill every slot before waiting on the first one
+    uint32_t launch_nonce = header->nonce;
+    int in_flight = 0;
+    bool launching = time_limit > 0;
+    for (int slot = 0; slot < slots && launching; slot++) {
+        TraceSpan span("launch");
+        launched_at[slot] = std::chrono::steady_clock::now();
+        if (!engine.launch(slot, launch_nonce)) {
+            launching = false;
+            break;
+        }
+        launch_nonce += batch;
+        in_flight++;
+        in_flight_metric.add(1);
+    }
+
+    bool found = false;
+    bool advancing = true;  // Resume point only moves over contiguous, collected batches
+    BatchResult winner;
+    int head = 0;
+    while (in_flight > 0) {
+        BatchResult result;
+        bool collected;
+        {
+            TraceSpan span("collect_wait");
+            collected = engine.collect(head, &result);
+        }
+        in_flight--;
+        in_flight_metric.add(-1);
+        if (!collected) {
+            launching = false;
+            advancing = false;
+        } else {
+            auto collected_at = std::chrono::steady_clock::now();
+            std::chrono::duration<double> batch_time = collected_at - launched_at[head];
+            batch_metric.observe(batch_time.count());
+            if (trace_enabled()) {
+                trace_record("batch", "engine", launched_at[head], collected_at);
+            }
+            hashes_metric.add(result.count);
+            if (found) {
+                stale_metric.add(result.count);
+            }
+            st.hashes += result.count;
+            st.batches++;
+            if (advancing) {
+                st.next_nonce = result.base_nonce + result.count;
+                if (result.found) {
+                    found = true;
+                    winner = result;
+                    launching = false;
+                    advancing = false;
+                }
+            }
+        }
+
+        std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+        st.elapsed = elapsed.count();
+        if (launching && st.elapsed >= time_limit) {
+            launching = false;
+        }
+        if (collected && on_batch && !on_batch(st)) {
+            launching = false;
+        }
+
+        // Refill the slot we just drained so the engine stays busy
+        if (launching) {
+            TraceSpan span("launch");
+            launched_at[head] = std::chrono::steady_clock::now();
+            if (engine.launch(head, launch_nonce)) {
+                launch_nonce += batch;
+                in_flight++;
+                in_flight_metric.add(1);
+            } else {
+                launching = false;
+            }
+        }
+        head = (head + 1) % slots;
+    }
+
+    if (found) {
+        st.found_at = winner.found_at;
+        header->nonce = winner.nonce;
+        if (out_hash) {
+            memcpy(out_hash, winner.hash, sizeof(winner.hash));
+        }
+        return true;
+    }
+
+    header->nonce = st.next_nonce;
+    return false;
+}
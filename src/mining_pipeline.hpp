@@ -0,0 +1,26 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include "mining_engine.hpp"
+
+struct PipelineStats {
+    uint64_t hashes;      // Nonces hashed by collected batches
+    uint64_t batches;     // Batches collected
+    float elapsed;        // Seconds since the pipeline started
+    uint32_t next_nonce;  // First nonce not yet covered by a collected batch
+    std::chrono::steady_clock::time_point found_at;  // Winner timestamp from the engine
+};
+
+// Called on the pipeline thread after every collected batch (including the
+// one holding the winner); return false to stop launching
+typedef std::function<bool(const PipelineStats&)> BatchCallback;
+
+// Mine a job on an engine, keeping every engine slot busy so the device never
+// waits on the host between launches. header->nonce is the starting nonce; on
+// return it holds the winning nonce, or the resume point if nothing was found.
+// out_hash (optional) receives the engine-reported hash of the winner.
+bool run_pipeline(MiningEngine& engine, MiningHeader* header, const Target& target,
+                  float time_limit, uint32_t* out_hash = nullptr,
+                  const BatchCallback& on_batch = BatchCallback(),
+                  PipelineStats* stats = nullptr);
@@ -0,0 +1,75 @@
+#include "mining_progress.hpp"
+
+// Rate is recomputed at most this often, so short batches don't make it jitter
+static const double kRateWindowSeconds = 0.5;
+
+ProgressObserver::ProgressObserver() {
+    snapshot_.sequence.store(0, std::memory_order_relaxed);
+    reset();
+}
+
+void ProgressObserver::reset(uint64_t hashes, uint64_t batches) {
+    started_ = std::chrono::steady_clock::now();
+    window_start_ = started_;
+    window_hashes_ = hashes;
+    hash_rate_ = 0;
+    base_hashes_ = hashes;
+    base_batches_ = batches;
+    run_hashes_ = 0;
+    run_batches_ = 0;
+    batch_hashes_ = 0;
+    restarted_ = false;
+    MiningProgress empty;
+    memset(&empty, 0, sizeof(empty));
+    snapshot_.write(empty);
+    latest_ = empty;
+    latest_.hashes = hashes;
+    latest_.batches = batches;
+}
+
+const MiningProgress& ProgressObserver::observe(const PipelineStats& stats) {
+    // Batch counts restart at 1 in every pipeline run; the rate window
+    // restarts with the run so time spent paused doesn't dilute it
+    auto now = std::chrono::steady_clock::now();
+    restarted_ = stats.batches <= run_batches_;
+    if (restarted_) {
+        base_hashes_ += run_hashes_;
+        base_batches_ += run_batches_;
+        window_start_ = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float>(stats.elapsed));
+        window_hashes_ = base_hashes_;
+        run_hashes_ = 0;
+    }
+    batch_hashes_ = stats.hashes - run_hashes_;
+    run_hashes_ = stats.hashes;
+    run_batches_ = stats.batches;
+
+    MiningProgress& progress = latest_;
+    progress.hashes = base_hashes_ + stats.hashes;
+    progress.batches = base_batches_ + stats.batches;
+    progress.next_nonce = stats.next_nonce;
+
+    std::chrono::duration<double> window = now - window_start_;
+    if (window.count() >= kRateWindowSeconds) {
+        hash_rate_ = (progress.hashes - window_hashes_) / window.count();
+        window_start_ = now;
+        window_hashes_ = progress.hashes;
+    }
+    progress.hash_rate = hash_rate_;
+    std::chrono::duration<float> elapsed = now - started_;
+    progress.elapsed = elapsed.count();
+
+    snapshot_.write(progress);
+    return progress;
+}
+
+bool ProgressObserver::sample(MiningProgress* out) const {
+    return snapshot_.read(out) && out->batches > 0;
+}
+
+BatchCallback ProgressObserver::callback(std::function<bool()> keep_going) {
+    return [this, keep_going](const PipelineStats& stats) {
+        observe(stats);
+        return !keep_going || keep_going();
+    };
+}
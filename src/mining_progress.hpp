@@ -0,0 +1,64 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include "mining_pipeline.hpp"
+#include "stats_segment.hpp"
+
+// Progress of one mining job, as last published at a batch boundary
+struct MiningProgress {
+    uint64_t hashes;      // Nonces hashed since reset(), across pipeline runs
+    uint64_t batches;
+    float elapsed;        // Seconds since reset()
+    uint32_t next_nonce;  // Resume point of the current run
+    double hash_rate;     // Hashes per second over the last sample window
+};
+
+// Batch-boundary progress observer. observe() runs on the pipeline thread and
+// publishes into a seqlock, so the hashing loop takes no lock and any number
+// of samplers (a UI frame timer, say) can read without ever blocking it.
+// A job may span several pipeline runs (pause/resume, rejected solutions);
+// counts keep accumulating until the next reset(). This is the one place
+// that folds a restarted run into the totals: the service, lease loops and
+// pacers read it rather than tracking PipelineStats themselves.
+class ProgressObserver {
+public:
+    ProgressObserver();
+
+    // Start a new job; call with no pipeline running. A resumed job starts
+    // from the totals of its earlier runs.
+    void reset(uint64_t hashes = 0, uint64_t batches = 0);
+
+    // Single writer: the pipeline thread. Returns the totals including this batch.
+    const MiningProgress& observe(const PipelineStats& stats);
+
+    // Writer side, after observe(): the totals so far (the reset() base
+    // before any batch), the hashes of the batch last observed, and whether
+    // that batch began a new pipeline run
+    const MiningProgress& latest() const { return latest_; }
+    uint64_t batch_hashes() const { return batch_hashes_; }
+    bool restarted() const { return restarted_; }
+
+    // Latest snapshot, false until the first batch or if a write kept it busy
+    bool sample(MiningProgress* out) const;
+
+    // Callback for run_pipeline/mine_block_verified: observes every batch,
+    // then keeps launching while keep_going returns true
+    BatchCallback callback(std::function<bool()> keep_going = std::function<bool()>());
+
+private:
+    SeqlockSlot<MiningProgress> snapshot_;
+
+    // Writer side only
+    std::chrono::steady_clock::time_point started_;
+    std::chrono::steady_clock::time_point window_start_;
+    uint64_t window_hashes_;
+    double hash_rate_;
+    uint64_t base_hashes_;   // Totals of finished pipeline runs
+    uint64_t base_batches_;
+    uint64_t run_hashes_;    // Last stats seen from the current run
+    uint64_t run_batches_;
+    uint64_t batch_hashes_;
+    bool restarted_;
+    MiningProgress latest_;
+};
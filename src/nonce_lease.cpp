@@ -0,0 +1,238 @@
+#include "nonce_lease.hpp"
+#include <algorithm>
+
+NonceLeaseBook::NonceLeaseBook(double lease_seconds, double expiry_seconds)
+    : lease_seconds_(lease_seconds)
+    , expiry_seconds_(expiry_seconds)
+    , next_lease_id_(1)
+    , leases_issued_(0)
+    , leases_expired_(0)
+    , hashes_reported_(0) {}
+
+void NonceLeaseBook::add_job(const std::string& id, const MiningHeader& header, const Target& target,
+                             float time_limit, uint64_t hashes) {
+    Job job;
+    job.header = header;
+    job.header.nonce = 0;
+    job.target = target;
+    job.has_deadline = time_limit > 0;
+    job.deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(time_limit));
+    job.timestamp = header.timestamp;
+    job.next_nonce = header.nonce;
+    job.hashes = hashes;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_[id] = job;
+    job_order_.push_back(id);
+}
+
+NonceLeaseBook::Range NonceLeaseBook::next_range(Job& job, uint64_t want) {
+    Range range;
+    if (!job.reclaimed.empty()) {
+        Range& front = job.reclaimed.front();
+        if (front.count <= want) {
+            range = front;
+            job.reclaimed.pop_front();
+        } else {
+            range = {front.timestamp, front.begin, want};
+            front.begin += (uint32_t)want;
+            front.count -= want;
+        }
+        return range;
+    }
+    if (job.next_nonce >= kNonceSpace) {
+        job.timestamp++;
+        job.next_nonce = 0;
+    }
+    range.timestamp = job.timestamp;
+    range.begin = (uint32_t)job.next_nonce;
+    range.count = std::min<uint64_t>(want, kNonceSpace - job.next_nonce);
+    job.next_nonce += range.count;
+    return range;
+}
+
+bool NonceLeaseBook::acquire(const std::string& worker_id, double hash_rate, uint32_t granularity,
+                             NonceLease* lease) {
+    if (granularity == 0) {
+        granularity = 1;
+    }
+    // Enough work for lease_seconds_ at the worker's rate, in whole granules
+    uint64_t want = hash_rate > 0 ? (uint64_t)(hash_rate * lease_seconds_) : granularity;
+    want = (want + granularity - 1) / granularity * granularity;
+    want = std::max<uint64_t>(want, granularity);
+    want = std::min<uint64_t>(want, std::max<uint64_t>(kMaxLeaseNonces / granularity * granularity, granularity));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    expire_locked(now);
+
+    // Oldest job with work left; finishing one moves the next into its place
+    size_t i = 0;
+    while (i < job_order_.size()) {
+        std::string job_id = job_order_[i];
+        Job& job = jobs_[job_id];
+        if (job.has_deadline && now >= job.deadline) {
+            finish_locked(job_id);
+            continue;
+        }
+
+        Range range = next_range(job, want);
+        lease->id = next_lease_id_++;
+        lease->job_id = job_id;
+        lease->worker_id = worker_id;
+        lease->header = job.header;
+        lease->header.timestamp = range.timestamp;
+        lease->header.nonce = range.begin;
+        lease->target = job.target;
+        lease->nonce_count = (uint32_t)range.count;
+        lease->hash_rate = hash_rate;
+        lease->expired = false;
+
+        // Held for the expiry floor, or three times the expected duration for big leases
+        double expected = hash_rate > 0 ? range.count / hash_rate : 0;
+        double hold = std::max(expiry_seconds_, expected * 3);
+        lease->expires = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(hold));
+
+        leases_[lease->id] = *lease;
+        leases_issued_++;
+        return true;
+    }
+    return false;
+}
+
+void NonceLeaseBook::expire_locked(std::chrono::steady_clock::time_point now) {
+    for (auto it = leases_.begin(); it != leases_.end();) {
+        NonceLease& lease = it->second;
+        if (now < lease.expires) {
+            ++it;
+            continue;
+        }
+        auto job = jobs_.find(lease.job_id);
+        if (job == jobs_.end()) {
+            // Its job finished while it was out and the worker never came back
+            it = leases_.erase(it);
+            continue;
+        }
+        if (!lease.expired) {
+            lease.expired = true;
+            leases_expired_++;
+            job->second.reclaimed.push_back({lease.header.timestamp, lease.header.nonce, lease.nonce_count});
+        }
+        ++it;
+    }
+}
+
+bool NonceLeaseBook::complete(uint64_t lease_id, uint64_t hashes, NonceLease* lease) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = leases_.find(lease_id);
+    if (it == leases_.end()) {
+        return false;
+    }
+    *lease = it->second;
+    hashes_reported_ += hashes;
+    auto job = jobs_.find(lease->job_id);
+    if (job != jobs_.end()) {
+        job->second.hashes += hashes;
+    }
+    leases_.erase(it);
+    return true;
+}
+
+void NonceLeaseBook::finish_locked(const std::string& job_id) {
+    jobs_.erase(job_id);
+    job_order_.erase(std::remove(job_order_.begin(), job_order_.end(), job_id), job_order_.end());
+    // Expired leases were only kept so a late solution could still count
+    for (auto it = leases_.begin(); it != leases_.end();) {
+        if (it->second.job_id == job_id && it->second.expired) {
+            it = leases_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool NonceLeaseBook::finish_job(const std::string& job_id, LeaseJobProgress* progress) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(job_id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    if (progress) {
+        // Ranges that expired meanwhile go back to the job before it is measured
+        expire_locked(std::chrono::steady_clock::now());
+        progress_locked(job_id, it->second, progress);
+    }
+    finish_locked(job_id);
+    return true;
+}
+
+// The frontier is the lowest range not completed: the job's own frontier,
+// a reclaimed range or a lease still out. Ranges completed past an open
+// lease are mined again on resume, at most a few leases' worth.
+void NonceLeaseBook::progress_locked(const std::string& job_id, const Job& job, LeaseJobProgress* progress) {
+    uint64_t lowest = job.next_nonce >= kNonceSpace ? ((uint64_t)job.timestamp + 1) << 32
+                                                    : ((uint64_t)job.timestamp << 32) | job.next_nonce;
+    for (const Range& range : job.reclaimed) {
+        lowest = std::min(lowest, ((uint64_t)range.timestamp << 32) | range.begin);
+    }
+    progress->hash_rate = 0;
+    for (const auto& entry : leases_) {
+        const NonceLease& lease = entry.second;
+        if (lease.job_id != job_id || lease.expired) {
+            continue;
+        }
+        lowest = std::min(lowest, ((uint64_t)lease.header.timestamp << 32) | lease.header.nonce);
+        progress->hash_rate += lease.hash_rate;
+    }
+    progress->frontier = job.header;
+    progress->frontier.timestamp = (uint32_t)(lowest >> 32);
+    progress->frontier.nonce = (uint32_t)lowest;
+    progress->hashes = job.hashes;
+}
+
+bool NonceLeaseBook::job_active(const std::string& job_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(job_id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    if (it->second.has_deadline && std::chrono::steady_clock::now() >= it->second.deadline) {
+        finish_locked(job_id);
+        return false;
+    }
+    return true;
+}
+
+bool NonceLeaseBook::job_progress(const std::string& job_id, LeaseJobProgress* progress) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(job_id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    expire_locked(now);
+    progress_locked(job_id, it->second, progress);
+    if (it->second.has_deadline && now >= it->second.deadline) {
+        finish_locked(job_id);
+        return false;
+    }
+    return true;
+}
+
+LeaseBookStats NonceLeaseBook::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LeaseBookStats out;
+    out.jobs_active = job_order_.size();
+    out.leases_outstanding = 0;
+    for (const auto& entry : leases_) {
+        if (!entry.second.expired) {
+            out.leases_outstanding++;
+        }
+    }
+    out.leases_issued = leases_issued_;
+    out.leases_expired = leases_expired_;
+    out.hashes_reported = hashes_reported_;
+    return out;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "miner.cuh"
+
+// Nonce space bookkeeping for the scale-out coordinator. A job's search
+// space is walked in (timestamp, nonce) order: all 2^32 nonces at the job's
+// timestamp, then the next second, and so on. Workers lease contiguous
+// ranges sized to their reported hash rate; a lease that is not completed
+// before it expires goes back to the job and is handed out again.
+
+static const uint64_t kNonceSpace = 1ull << 32;
+static const uint32_t kMaxLeaseNonces = 1u << 31;
+
+struct NonceLease {
+    uint64_t id;
+    std::string job_id;
+    std::string worker_id;
+    MiningHeader header;    // Timestamp of the range, nonce = first nonce
+    Target target;
+    uint32_t nonce_count;
+    std::chrono::steady_clock::time_point expires;
+    double hash_rate;       // Worker's rate when it took the lease
+    bool expired;           // Range was already reclaimed for reissue
+};
+
+// Where a job stands, as far as workers have reported back
+struct LeaseJobProgress {
+    MiningHeader frontier;  // Every range before this (timestamp, nonce) is completed
+    uint64_t hashes;        // Completed by workers, including what the job was added with
+    double hash_rate;       // Sum of the rates of workers holding its leases
+};
+
+struct LeaseBookStats {
+    size_t jobs_active;
+    size_t leases_outstanding;
+    uint64_t leases_issued;
+    uint64_t leases_expired;
+    uint64_t hashes_reported;
+};
+
+class NonceLeaseBook {
+public:
+    // lease_seconds: how long a lease should take at the worker's rate;
+    // expiry_seconds: floor for how long a worker may hold one
+    NonceLeaseBook(double lease_seconds, double expiry_seconds);
+
+    // time_limit 0 means the job runs until solved or finished. header's
+    // timestamp and nonce are where the search starts; hashes carries the
+    // count of a job that is resumed.
+    void add_job(const std::string& id, const MiningHeader& header, const Target& target, float time_limit,
+                 uint64_t hashes = 0);
+
+    // Next range for a worker. hash_rate is the worker's measured H/s (0 if
+    // unknown, which gets a probe lease of one granule); counts are whole
+    // multiples of granularity (the worker's launch size) except where a
+    // timestamp's nonce space runs out. False when no job has work left.
+    bool acquire(const std::string& worker_id, double hash_rate, uint32_t granularity, NonceLease* lease);
+
+    // Worker is done with a lease; *lease gets its details. A lease that
+    // expired is still known (its solution counts) until its job finishes;
+    // one still out when its job finishes is dropped once it expires.
+    // False for a lease id that was never issued or is already completed.
+    bool complete(uint64_t lease_id, uint64_t hashes, NonceLease* lease);
+
+    // Stop handing out ranges for a job (solved, cancelled, paused); true
+    // only for the call that finished it, so a job is closed once. *progress
+    // (optional) gets where it stood, to resume it from.
+    bool finish_job(const std::string& job_id, LeaseJobProgress* progress = nullptr);
+    bool job_active(const std::string& job_id);
+
+    // Fills *progress while the job is known; false once it is finished,
+    // including by this call when its time is up
+    bool job_progress(const std::string& job_id, LeaseJobProgress* progress);
+
+    LeaseBookStats stats();
+
+private:
+    struct Range {
+        uint32_t timestamp;
+        uint32_t begin;
+        uint64_t count;
+    };
+
+    struct Job {
+        MiningHeader header;
+        Target target;
+        std::chrono::steady_clock::time_point deadline;
+        bool has_deadline;
+        uint32_t timestamp;     // Timestamp of the frontier
+        uint64_t next_nonce;    // Frontier within that timestamp, up to kNonceSpace
+        std::deque<Range> reclaimed;  // Expired ranges, reissued first
+        uint64_t hashes;
+    };
+
+    void expire_locked(std::chrono::steady_clock::time_point now);
+    void progress_locked(const std::string& job_id, const Job& job, LeaseJobProgress* progress);
+    void finish_locked(const std::string& job_id);
+    static Range next_range(Job& job, uint64_t want);
+
+    double lease_seconds_;
+    double expiry_seconds_;
+    std::mutex mutex_;
+    std::map<std::string, Job> jobs_;
+    std::vector<std::string> job_order_;  // Oldest first
+    std::map<uint64_t, NonceLease> leases_;
+    uint64_t next_lease_id_;
+    uint64_t leases_issued_;
+    uint64_t leases_expired_;
+    uint64_t hashes_reported_;
+};
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include "miner.cuh"
+#include "cpu_engine.hpp"
+#include "mining_pipeline.hpp"
+#include "ticket_verifier.hpp"
+
+// Behavior of the launch pipeline (run_pipeline) on the CPU engine: the
+// resume point, the per-batch callbacks and the drain of batches still in
+// flight when it stops. No GPU needed; exits non-zero on any failure.
+
+static int failures = 0;
+
+static void Expect(bool ok, const std::string& check, const std::string& what) {
+    if (!ok) {
+        failures++;
+        std::cout << "FAIL [" << check << "] " << what << std::endl;
+    }
+}
+
+static MiningHeader TestHeader(uint32_t nonce) {
+    MiningHeader header;
+    memset(&header, 0, sizeof(header));
+    header.hash_length = 32;
+    header.address1_length = 20;
+    header.address2_length = 20;
+    for (size_t i = 0; i < sizeof(header.hash); i++) header.hash[i] = (uint8_t)(i * 7 + 1);
+    for (size_t i = 0; i < sizeof(header.address1); i++) header.address1[i] = (uint8_t)(i + 3);
+    for (size_t i = 0; i < sizeof(header.address2); i++) header.address2[i] = (uint8_t)(i * 5);
+    header.value = 3768;
+    header.timestamp = 1737835291u;
+    header.nonce = nonce;
+    return header;
+}
+
+// What a BatchCallback saw; stops launching after stop_after batches (0 = never)
+struct CallbackLog {
+    uint64_t stop_after = 0;
+    std::vector<PipelineStats> seen;
+
+    BatchCallback callback() {
+        return [this](const PipelineStats& stats) {
+            seen.push_back(stats);
+            return stop_after == 0 || stats.batches < stop_after;
+        };
+    }
+};
+
+// Every collected batch is reported once, in order, with running totals and
+// a resume point that moves over contiguous batches only
+static void CheckCallbacks(const CallbackLog& log, uint32_t start, uint32_t batch, const std::string& check) {
+    for (size_t i = 0; i < log.seen.size(); i++) {
+        const PipelineStats& stats = log.seen[i];
+        const std::string at = "callback " + std::to_string(i + 1);
+        Expect(stats.batches == i + 1, check, at + ": batches " + std::to_string(stats.batches));
+        Expect(stats.hashes == (i + 1) * (uint64_t)batch, check, at + ": hashes " + std::to_string(stats.hashes));
+        Expect(stats.next_nonce == (uint32_t)(start + (i + 1) * batch), check,
+               at + ": next_nonce " + std::to_string(stats.next_nonce));
+    }
+}
+
+// A callback that stops launching: the batches already in flight are still
+// collected and reported, the resume point covers all of them and the
+// engine is left with no slot busy
+static void CheckStop(uint32_t start) {
+    const std::string check = "stop @" + std::to_string(start);
+    CpuEngine engine(2, 1024, 3);
+    Target none_pass;
+    memset(none_pass.words, 0, sizeof(none_pass.words));
+    MiningHeader header = TestHeader(start);
+    CallbackLog log;
+    log.stop_after = 4;
+    PipelineStats stats;
+
+    bool found = run_pipeline(engine, &header, none_pass, 60.0f, nullptr, log.callback(), &stats);
+    const uint64_t drained = log.stop_after + engine.slots() - 1;
+    Expect(!found, check, "winner reported with an all-zero target");
+    Expect(log.seen.size() == drained, check, std::to_string(log.seen.size()) + " callbacks, expected " +
+           std::to_string(drained) + " (stop plus the batches in flight)");
+    Expect(stats.batches == drained, check, "stats.batches " + std::to_string(stats.batches));
+    Expect(stats.hashes == drained * engine.batch_size(), check, "stats.hashes " + std::to_string(stats.hashes));
+    Expect(stats.next_nonce == (uint32_t)(start + drained * engine.batch_size()), check,
+           "stats.next_nonce " + std::to_string(stats.next_nonce));
+    Expect(header.nonce == stats.next_nonce, check, "header resumes at " + std::to_string(header.nonce) +
+           ", stats say " + std::to_string(stats.next_nonce));
+    CheckCallbacks(log, start, engine.batch_size(), check);
+
+    // set_job refuses while any slot is still busy
+    TicketJobConstants job;
+    build_job_constants(header, &job);
+    Expect(engine.set_job(job, none_pass), check, "engine still has batches in flight");
+}
+
+// A winner in the first batch: later batches in flight are drained but do
+// not move the resume point, and the winner's hash matches the reference
+static void CheckFound() {
+    const std::string check = "found";
+    const uint32_t start = 1000;
+    CpuEngine engine(2, 512, 3);
+    Target all_pass;
+    memset(all_pass.words, 0xFF, sizeof(all_pass.words));
+    MiningHeader header = TestHeader(start);
+    CallbackLog log;
+    PipelineStats stats;
+    uint32_t hash[8];
+
+    bool found = run_pipeline(engine, &header, all_pass, 60.0f, hash, log.callback(), &stats);
+    Expect(found, check, "nothing found with an all-pass target");
+    Expect(header.nonce == start, check, "winner " + std::to_string(header.nonce) + ", expected the first nonce");
+    Expect(stats.batches == (uint64_t)engine.slots(), check, "stats.batches " + std::to_string(stats.batches) +
+           ", expected every launched batch collected");
+    Expect(log.seen.size() == (size_t)engine.slots(), check, std::to_string(log.seen.size()) + " callbacks");
+    Expect(stats.next_nonce == start + engine.batch_size(), check,
+           "stats.next_nonce " + std::to_string(stats.next_nonce) + " moved past the winning batch");
+    uint32_t reference[8];
+    TicketVerifier::ticket_hash(header, reference);
+    Expect(memcmp(reference, hash, sizeof(hash)) == 0, check, "winner hash differs from the reference");
+}
+
+// No time budget: nothing is launched or reported and the header is untouched
+static void CheckNoBudget() {
+    const std::string check = "no budget";
+    CpuEngine engine(1, 256, 2);
+    Target none_pass;
+    memset(none_pass.words, 0, sizeof(none_pass.words));
+    MiningHeader header = TestHeader(42);
+    CallbackLog log;
+    PipelineStats stats;
+
+    bool found = run_pipeline(engine, &header, none_pass, 0.0f, nullptr, log.callback(), &stats);
+    Expect(!found && log.seen.empty() && stats.batches == 0, check, "batches ran without a budget");
+    Expect(header.nonce == 42 && stats.next_nonce == 42, check, "resume point moved");
+}
+
+int main() {
+    CheckStop(0);
+    CheckStop(0xFFFFF000u);  // Resume point wraps past 2^32
+    CheckFound();
+    CheckNoBudget();
+
+    if (failures) {
+        std::cout << failures << " pipeline check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Pipeline checks passed" << std::endl;
+    return 0;
+}
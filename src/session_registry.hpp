@@ -0,0 +1,258 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Sessions by id, split over shards so requests for different sessions don't
+// wait on each other. A session's fields are guarded by its shard's mutex
+// (lock() or mutex_for()); threads that outlive a lookup, like the mining
+// thread, hold a shared_ptr so eviction never frees a session in use.
+//
+// Sessions that are done (finished or cancelled) are retired. Retired
+// sessions stay visible for retention_seconds, and at most max_retired of
+// them are kept; older ones are evicted, oldest first, and handed to the
+// evict callback. Eviction runs in the shard being inserted into, so memory
+// stays bounded without a sweeper thread.
+//
+// Parked sessions (paused, say) are neither retired nor evicted, and don't
+// count against max_retired, until they have been parked for park_seconds;
+// then they are retired like a finished session.
+template <typename T>
+class SessionRegistry {
+public:
+    static const size_t kShards = 16;
+
+    typedef std::function<void(const std::shared_ptr<T>& session)> EvictFn;
+
+    // A session with its shard locked; empty if the id is unknown
+    class Locked {
+    public:
+        explicit operator bool() const { return session_ != nullptr; }
+        T& operator*() const { return *session_; }
+        T* operator->() const { return session_.get(); }
+        const std::shared_ptr<T>& share() const { return session_; }
+
+    private:
+        friend class SessionRegistry;
+        Locked(std::mutex& mutex, std::shared_ptr<T> session) : lock_(mutex), session_(std::move(session)) {}
+
+        std::unique_lock<std::mutex> lock_;
+        std::shared_ptr<T> session_;
+    };
+
+    SessionRegistry()
+        : retention_(std::chrono::hours(1)), park_ttl_(std::chrono::hours(24)), max_retired_per_shard_(1024) {}
+
+    // Not thread-safe; call before the first insert
+    void configure(double retention_seconds, size_t max_retired, double park_seconds, EvictFn on_evict) {
+        retention_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(retention_seconds));
+        park_ttl_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(park_seconds));
+        max_retired_per_shard_ = max_retired / kShards > 0 ? max_retired / kShards : 1;
+        on_evict_ = std::move(on_evict);
+    }
+
+    // Adds a session (replacing one with the same id) and evicts what its
+    // shard no longer has to keep
+    std::shared_ptr<T> insert(const std::string& id, const T& value) {
+        return insert(id, std::make_shared<T>(value));
+    }
+
+    // Registers a session that already exists, e.g. one a thread is mining
+    std::shared_ptr<T> insert(const std::string& id, std::shared_ptr<T> session) {
+        std::vector<std::shared_ptr<T>> evicted;
+        {
+            Shard& shard = shard_for(id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            Entry& entry = shard.entries[id];
+            if (entry.retired) {
+                shard.live_retired--;
+            }
+            if (entry.parked) {
+                shard.live_parked--;
+            }
+            entry = Entry();
+            entry.session = session;
+            evict_locked(shard, std::chrono::steady_clock::now(), &evicted);
+        }
+        for (const std::shared_ptr<T>& old : evicted) {
+            if (on_evict_) {
+                on_evict_(old);
+            }
+        }
+        return session;
+    }
+
+    Locked lock(const std::string& id) {
+        Shard& shard = shard_for(id);
+        Locked locked(shard.mutex, nullptr);
+        auto it = shard.entries.find(id);
+        if (it != shard.entries.end()) {
+            locked.session_ = it->second.session;
+        }
+        return locked;
+    }
+
+    // Guards the fields of the session with this id
+    std::mutex& mutex_for(const std::string& id) { return shard_for(id).mutex; }
+
+    // Caller holds mutex_for(id). Starts the retention clock of a session
+    // that is done; only retired sessions are ever evicted.
+    void retire_locked(const std::string& id) {
+        Shard& shard = shard_for(id);
+        auto it = shard.entries.find(id);
+        if (it == shard.entries.end() || it->second.retired) {
+            return;
+        }
+        unpark(shard, it->second);
+        retire(shard, it->second, id, std::chrono::steady_clock::now());
+    }
+
+    // Caller holds mutex_for(id). Sets aside a session that is not done,
+    // e.g. a paused one; it is retired if still parked after park_seconds.
+    void park_locked(const std::string& id) {
+        Shard& shard = shard_for(id);
+        auto it = shard.entries.find(id);
+        if (it == shard.entries.end() || it->second.retired || it->second.parked) {
+            return;
+        }
+        it->second.parked = true;
+        it->second.parked_at = std::chrono::steady_clock::now();
+        shard.parked.emplace_back(it->second.parked_at, id);
+        shard.live_parked++;
+    }
+
+    // Caller holds mutex_for(id). The session is in use again: no longer
+    // parked, and no longer retired if its park ran out but it was not
+    // evicted yet
+    void unpark_locked(const std::string& id) {
+        Shard& shard = shard_for(id);
+        auto it = shard.entries.find(id);
+        if (it == shard.entries.end()) {
+            return;
+        }
+        unpark(shard, it->second);
+        if (it->second.retired) {
+            it->second.retired = false;
+            shard.live_retired--;
+        }
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<T> session;
+        bool retired = false;
+        std::chrono::steady_clock::time_point retired_at;
+        bool parked = false;
+        std::chrono::steady_clock::time_point parked_at;
+    };
+
+    typedef std::deque<std::pair<std::chrono::steady_clock::time_point, std::string>> Queue;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+        // Retirements in order; stale ones (replaced by an insert) are skipped
+        Queue retired;
+        size_t live_retired = 0;  // Entries currently retired; the cap counts these, not the queue
+        Queue parked;             // Parkings in order, stale ones skipped the same way
+        size_t live_parked = 0;
+    };
+
+    Shard& shard_for(const std::string& id) { return shards_[std::hash<std::string>()(id) % kShards]; }
+
+    static void retire(Shard& shard, Entry& entry, const std::string& id, std::chrono::steady_clock::time_point now) {
+        entry.retired = true;
+        entry.retired_at = now;
+        shard.retired.emplace_back(now, id);
+        shard.live_retired++;
+    }
+
+    static void unpark(Shard& shard, Entry& entry) {
+        if (entry.parked) {
+            entry.parked = false;
+            shard.live_parked--;
+        }
+    }
+
+    void evict_locked(Shard& shard, std::chrono::steady_clock::time_point now,
+                      std::vector<std::shared_ptr<T>>* evicted) {
+        // Sessions parked for too long are retired first, so they age out below
+        auto stale_park = [&shard](const typename Queue::value_type& queued) {
+            auto it = shard.entries.find(queued.second);
+            return it == shard.entries.end() || !it->second.parked || it->second.parked_at != queued.first;
+        };
+        if (shard.parked.size() > 2 * shard.live_parked + 64) {
+            shard.parked.erase(std::remove_if(shard.parked.begin(), shard.parked.end(), stale_park),
+                               shard.parked.end());
+        }
+        while (!shard.parked.empty()) {
+            if (stale_park(shard.parked.front())) {
+                shard.parked.pop_front();
+                continue;
+            }
+            if (now - shard.parked.front().first < park_ttl_) {
+                break;
+            }
+            const std::string& id = shard.parked.front().second;
+            Entry& entry = shard.entries.find(id)->second;
+            unpark(shard, entry);
+            retire(shard, entry, id, now);
+            shard.parked.pop_front();
+        }
+        
+        // Drop stale queue entries at the front, so the front is the oldest retiree
+        auto stale = [&shard](const typename Queue::value_type& queued) {
+            auto it = shard.entries.find(queued.second);
+            return it == shard.entries.end() || !it->second.retired || it->second.retired_at != queued.first;
+        };
+        // Ids inserted again after retiring leave stale entries behind the
+        // front; drop them once they outnumber the live ones
+        if (shard.retired.size() > 2 * shard.live_retired + 64) {
+            shard.retired.erase(std::remove_if(shard.retired.begin(), shard.retired.end(), stale),
+                                shard.retired.end());
+        }
+        for (;;) {
+            while (!shard.retired.empty() && stale(shard.retired.front())) {
+                shard.retired.pop_front();
+            }
+            if (shard.retired.empty()) {
+                break;
+            }
+            bool expired = now - shard.retired.front().first >= retention_;
+            bool over_cap = shard.live_retired > max_retired_per_shard_;
+            if (!expired && !over_cap) {
+                break;
+            }
+            auto it = shard.entries.find(shard.retired.front().second);
+            evicted->push_back(it->second.session);
+            shard.entries.erase(it);
+            shard.retired.pop_front();
+            shard.live_retired--;
+        }
+    }
+
+    Shard shards_[kShards];
+    std::chrono::steady_clock::duration retention_;
+    std::chrono::steady_clock::duration park_ttl_;
+    size_t max_retired_per_shard_;
+    EvictFn on_evict_;
+};
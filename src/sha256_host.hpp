@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include "support_ticket.hpp"
+
+// Portable SHA-256 compression for host-side engines and job setup
+void sha256_compress(uint32_t state[8], const uint32_t block[16]);
+
+// State after the nonce-independent blocks of the padded ticket
+void ticket_midstate(const TicketJobConstants& job, uint32_t midstate[8]);
+
+// Double SHA-256 of the ticket for one nonce, starting from the job midstate.
+// tail is the last message block (TicketJobConstants::words + kTailWord);
+// the hash is returned in display word order, like the kernel output.
+void ticket_hash_from_midstate(const uint32_t midstate[8], const uint32_t* tail,
+                               uint32_t nonce, uint32_t hash[8]);
+
+// Compare a display-order hash with big-endian target words
+inline bool hash_meets_target(const uint32_t hash[8], const uint32_t target[8]) {
+    for (int i = 0; i < 8; i++) {
+        if (hash[i] != target[i]) {
+            return hash[i] < target[i];
+        }
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+#include "state_spill.hpp"
+#include "log.hpp"
+#include <filesystem>
+
+StateSpiller::StateSpiller()
+    : shutdown_(false)
+    , writer_(&StateSpiller::writer_loop, this) {
+}
+
+StateSpiller::~StateSpiller() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    cv_.notify_all();
+    writer_.join();
+}
+
+void StateSpiller::spill(const std::string& path, const MiningHeader& header, const Target& target) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_[path] = Snapshot{header, target, false};
+    }
+    cv_.notify_one();
+}
+
+void StateSpiller::remove(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_[path].remove = true;
+    }
+    cv_.notify_one();
+}
+
+bool StateSpiller::written(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.count(path) != 0 || writing_ == path) {
+            return false;
+        }
+    }
+    std::error_code error;
+    return std::filesystem::exists(path, error);
+}
+
+void StateSpiller::writer_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this]() { return shutdown_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return;  // Shut down with nothing left to write
+        }
+        auto it = pending_.begin();
+        std::string path = it->first;
+        Snapshot snapshot = it->second;
+        pending_.erase(it);
+        writing_ = path;
+
+        lock.unlock();
+        std::string temp_path = path + ".tmp";
+        std::error_code error;
+        if (snapshot.remove) {
+            std::filesystem::remove(path, error);
+        } else if (!save_mining_state(temp_path.c_str(), &snapshot.header, &snapshot.target)) {
+            LOG_WARNING("Failed to write mining state {}", path);
+        } else {
+            std::filesystem::rename(temp_path, path, error);
+            if (error) {
+                LOG_WARNING("Failed to replace mining state {}: {}", path, error.message());
+            }
+        }
+        lock.lock();
+        writing_.clear();
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "miner.cuh"
+
+// Writes paused session state (save_mining_state files) on a background
+// thread, so the mining thread never waits on the disk. The files are only
+// for durability across restarts; resuming a paused session uses the copy
+// kept in memory. Only the latest snapshot per file is written, to a
+// temporary file renamed into place, so a file is never seen half written.
+class StateSpiller {
+public:
+    StateSpiller();
+    // Writes whatever is still queued, then stops
+    ~StateSpiller();
+
+    void spill(const std::string& path, const MiningHeader& header, const Target& target);
+
+    // Deletes the file once anything queued before has been written, e.g.
+    // when its session ends
+    void remove(const std::string& path);
+
+    // True once the latest snapshot queued for path is on disk; never waits
+    // on the writer
+    bool written(const std::string& path);
+
+private:
+    struct Snapshot {
+        MiningHeader header;
+        Target target;
+        bool remove;  // Delete the file instead
+    };
+
+    void writer_loop();
+
+    std::map<std::string, Snapshot> pending_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string writing_;  // Path being written, empty between writes
+    bool shutdown_;
+    std::thread writer_;
+};
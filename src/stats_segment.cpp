@@ -0,0 +1,325 @@
+#include "stats_segment.hpp"
+#include <chrono>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static void copy_name(char* dest, size_t size, const std::string& value) {
+    size_t length = value.size() < size - 1 ? value.size() : size - 1;
+    memcpy(dest, value.data(), length);
+    memset(dest + length, 0, size - length);
+}
+
+#ifdef _WIN32
+static std::string mapping_name(const std::string& name) {
+    return "Local\\" + name;
+}
+#else
+static std::string mapping_name(const std::string& name) {
+    return "/" + name;
+}
+#endif
+
+uint64_t stats_now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+StatsMapping::~StatsMapping() {
+    close();
+}
+
+bool StatsMapping::create(const std::string& name) {
+    close();
+    std::string path = mapping_name(name);
+    size_t size = sizeof(StatsSegmentLayout);
+    void* view = nullptr;
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, (DWORD)size, path.c_str());
+    if (!mapping) {
+        return false;
+    }
+    view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    handle_ = mapping;
+#else
+    int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        ::close(fd);
+        return false;
+    }
+    view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+#endif
+    layout_ = static_cast<StatsSegmentLayout*>(view);
+    writable_ = true;
+    name_ = path;
+    return true;
+}
+
+bool StatsMapping::open_read_only(const std::string& name) {
+    close();
+    std::string path = mapping_name(name);
+    size_t size = sizeof(StatsSegmentLayout);
+    void* view = nullptr;
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, path.c_str());
+    if (!mapping) {
+        return false;
+    }
+    view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    handle_ = mapping;
+#else
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < size) {
+        ::close(fd);
+        return false;
+    }
+    view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+#endif
+    layout_ = static_cast<StatsSegmentLayout*>(view);
+    writable_ = false;
+    name_ = path;
+    return true;
+}
+
+void StatsMapping::close() {
+    if (!layout_) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(layout_);
+    CloseHandle((HANDLE)handle_);
+    handle_ = nullptr;
+#else
+    munmap(layout_, sizeof(StatsSegmentLayout));
+    if (writable_) {
+        // Readers that still have it mapped keep their view
+        shm_unlink(name_.c_str());
+    }
+#endif
+    layout_ = nullptr;
+}
+
+StatsSegment::StatsSegment()
+    : next_session_(0)
+    , solutions_(0) {
+    memset(session_active_, 0, sizeof(session_active_));
+}
+
+bool StatsSegment::open(const std::string& name) {
+    if (!mapping_.create(name)) {
+        return false;
+    }
+    // A segment left by a crashed server is reinitialized; readers see it
+    // invalid (magic 0) until the header is complete
+    StatsSegmentLayout* layout = mapping_.layout();
+    layout->header.magic.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memset(reinterpret_cast<char*>(layout) + sizeof(StatsSegmentHeader), 0,
+           sizeof(StatsSegmentLayout) - sizeof(StatsSegmentHeader));
+    for (int i = 0; i < kStatsMaxSessions; i++) {
+        StatsSession empty = {};
+        empty.engine = -1;
+        layout->sessions[i].write(empty);
+    }
+    layout->header.version = kStatsVersion;
+    layout->header.size = sizeof(StatsSegmentLayout);
+    layout->header.max_engines = kStatsMaxEngines;
+    layout->header.max_sessions = kStatsMaxSessions;
+#ifdef _WIN32
+    layout->header.pid = (uint32_t)GetCurrentProcessId();
+#else
+    layout->header.pid = (uint32_t)getpid();
+#endif
+    layout->header.started_ns = stats_now_ns();
+    layout->header.magic.store(kStatsMagic, std::memory_order_release);
+    return true;
+}
+
+void StatsSegment::set_engine(int index, const char* name) {
+    if (!is_open() || index < 0 || index >= kStatsMaxEngines) {
+        return;
+    }
+    StatsEngine engine = {};
+    copy_name(engine.name, sizeof(engine.name), name);
+    engine.present = 1;
+    engine.updated_ns = stats_now_ns();
+    mapping_.layout()->engines[index].write(engine);
+}
+
+void StatsSegment::engine_busy(int index, bool busy) {
+    if (!is_open() || index < 0 || index >= kStatsMaxEngines) {
+        return;
+    }
+    SeqlockSlot<StatsEngine>& slot = mapping_.layout()->engines[index];
+    StatsEngine engine = slot.data;  // The lease holder is the only writer
+    engine.busy = busy ? 1 : 0;
+    if (!busy) {
+        engine.hash_rate = 0;
+    }
+    engine.updated_ns = stats_now_ns();
+    slot.write(engine);
+}
+
+void StatsSegment::engine_progress(int index, uint64_t new_hashes, double hash_rate) {
+    if (!is_open() || index < 0 || index >= kStatsMaxEngines) {
+        return;
+    }
+    SeqlockSlot<StatsEngine>& slot = mapping_.layout()->engines[index];
+    StatsEngine engine = slot.data;
+    engine.hashes += new_hashes;
+    engine.hash_rate = hash_rate;
+    engine.updated_ns = stats_now_ns();
+    slot.write(engine);
+}
+
+int StatsSegment::open_session(const std::string& id) {
+    if (!is_open()) {
+        return -1;
+    }
+    int slot = -1;
+    {
+        // Round robin so a finished session stays readable for a while
+        std::lock_guard<std::mutex> lock(slots_mutex_);
+        for (int i = 0; i < kStatsMaxSessions; i++) {
+            int candidate = (next_session_ + i) % kStatsMaxSessions;
+            if (!session_active_[candidate]) {
+                slot = candidate;
+                session_active_[candidate] = true;
+                next_session_ = (candidate + 1) % kStatsMaxSessions;
+                break;
+            }
+        }
+    }
+    if (slot < 0) {
+        return -1;
+    }
+    StatsSession session = {};
+    copy_name(session.id, sizeof(session.id), id);
+    session.state = kStatsSessionWaiting;
+    session.engine = -1;
+    session.started_ns = stats_now_ns();
+    session.updated_ns = session.started_ns;
+    mapping_.layout()->sessions[slot].write(session);
+    return slot;
+}
+
+void StatsSegment::session_engine(int slot, int engine) {
+    if (!is_open() || slot < 0) {
+        return;
+    }
+    SeqlockSlot<StatsSession>& entry = mapping_.layout()->sessions[slot];
+    StatsSession session = entry.data;
+    session.state = kStatsSessionMining;
+    session.engine = engine;
+    session.updated_ns = stats_now_ns();
+    entry.write(session);
+}
+
+void StatsSegment::session_progress(int slot, uint32_t cursor, uint64_t hashes, uint64_t batches,
+                                    double hash_rate) {
+    if (!is_open() || slot < 0) {
+        return;
+    }
+    SeqlockSlot<StatsSession>& entry = mapping_.layout()->sessions[slot];
+    StatsSession session = entry.data;
+    session.cursor = cursor;
+    session.hashes = hashes;
+    session.batches = batches;
+    session.hash_rate = hash_rate;
+    session.updated_ns = stats_now_ns();
+    entry.write(session);
+}
+
+void StatsSegment::close_session(int slot, StatsSessionState state) {
+    if (!is_open() || slot < 0) {
+        return;
+    }
+    SeqlockSlot<StatsSession>& entry = mapping_.layout()->sessions[slot];
+    StatsSession session = entry.data;
+    session.state = state;
+    session.hash_rate = 0;
+    session.updated_ns = stats_now_ns();
+    entry.write(session);
+
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    session_active_[slot] = false;
+}
+
+void StatsSegment::publish_solution(const std::string& session_id, uint32_t nonce, const uint32_t hash[8]) {
+    if (!is_open()) {
+        return;
+    }
+    // Sessions finish on their own threads; the counter lock also serializes writers
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    StatsSolution solution = {};
+    copy_name(solution.session_id, sizeof(solution.session_id), session_id);
+    solution.nonce = nonce;
+    memcpy(solution.hash, hash, sizeof(solution.hash));
+    solution.found_ns = stats_now_ns();
+    solution.count = ++solutions_;
+    mapping_.layout()->last_solution.write(solution);
+}
+
+bool StatsSegmentReader::open(const std::string& name) {
+    if (!mapping_.open_read_only(name)) {
+        return false;
+    }
+    const StatsSegmentHeader& header = mapping_.layout()->header;
+    if (header.magic.load(std::memory_order_acquire) != kStatsMagic ||
+        header.version != kStatsVersion || header.size != sizeof(StatsSegmentLayout)) {
+        mapping_.close();
+        return false;
+    }
+    return true;
+}
+
+bool StatsSegmentReader::read_engine(int index, StatsEngine* out) const {
+    if (!layout() || index < 0 || index >= kStatsMaxEngines) {
+        return false;
+    }
+    return layout()->engines[index].read(out);
+}
+
+bool StatsSegmentReader::read_session(int slot, StatsSession* out) const {
+    if (!layout() || slot < 0 || slot >= kStatsMaxSessions) {
+        return false;
+    }
+    return layout()->sessions[slot].read(out);
+}
+
+bool StatsSegmentReader::read_solution(StatsSolution* out) const {
+    if (!layout()) {
+        return false;
+    }
+    return layout()->last_solution.read(out);
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+// Live stats published in a named shared-memory segment so monitors can map
+// it read-only and poll without calling into the service. Every entry is
+// guarded by its own seqlock and has a single writer at a time (the session
+// thread holding it), so publishing is a few plain stores and readers never
+// block or slow the miner, however many of them there are.
+//
+// Readers must check magic, version and size before using the layout.
+
+static const uint32_t kStatsMagic = 0x5453424b;  // "KBST"
+static const uint32_t kStatsVersion = 1;
+static const int kStatsMaxEngines = 16;
+static const int kStatsMaxSessions = 64;
+static const char* const kStatsDefaultName = "kbuc_miner_stats";
+
+// Value guarded by a sequence counter: odd while a write is in progress
+template <typename T>
+struct SeqlockSlot {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock data must be trivially copyable");
+
+    std::atomic<uint32_t> sequence;
+    uint32_t reserved;
+    T data;
+
+    // Single writer only
+    void write(const T& value) {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&data, &value, sizeof(T));
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Consistent copy, false if a writer kept it busy for every attempt
+    bool read(T* out) const {
+        for (int attempt = 0; attempt < 1000; attempt++) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            memcpy(out, &data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+enum StatsSessionState : uint32_t {
+    kStatsSessionFree = 0,
+    kStatsSessionWaiting = 1,   // Waiting for an engine
+    kStatsSessionMining = 2,
+    kStatsSessionFound = 3,
+    kStatsSessionExhausted = 4,  // Time limit reached or no engine
+    kStatsSessionCancelled = 5   // Another session of its group found a solution
+};
+
+struct StatsEngine {
+    char name[16];
+    uint32_t present;     // Engine exists in the pool
+    uint32_t busy;        // Leased to a session
+    uint64_t hashes;      // Total over the engine's lifetime
+    double hash_rate;     // Hashes per second over the last sample window
+    uint64_t updated_ns;  // Unix time of the last update
+};
+
+struct StatsSession {
+    char id[40];
+    uint32_t state;       // StatsSessionState
+    int32_t engine;       // Engine slot, -1 before one is leased
+    uint32_t cursor;      // Next nonce to be launched
+    uint32_t reserved;
+    uint64_t hashes;
+    uint64_t batches;
+    double hash_rate;     // Hashes per second over the last sample window
+    uint64_t started_ns;
+    uint64_t updated_ns;
+};
+
+struct StatsSolution {
+    char session_id[40];
+    uint32_t nonce;
+    uint32_t hash[8];     // Display word order
+    uint64_t found_ns;
+    uint64_t count;       // Solutions published since the server started
+};
+
+struct StatsSegmentHeader {
+    std::atomic<uint32_t> magic;  // Stored last when the segment is initialized
+    uint32_t version;
+    uint32_t size;                // sizeof(StatsSegmentLayout)
+    uint32_t max_engines;
+    uint32_t max_sessions;
+    uint32_t pid;
+    uint64_t started_ns;
+};
+
+struct StatsSegmentLayout {
+    StatsSegmentHeader header;
+    SeqlockSlot<StatsEngine> engines[kStatsMaxEngines];
+    SeqlockSlot<StatsSession> sessions[kStatsMaxSessions];
+    SeqlockSlot<StatsSolution> last_solution;
+};
+
+// Platform shared-memory mapping of one segment
+class StatsMapping {
+public:
+    StatsMapping() : layout_(nullptr), handle_(nullptr), writable_(false) {}
+    ~StatsMapping();
+    StatsMapping(const StatsMapping&) = delete;
+    StatsMapping& operator=(const StatsMapping&) = delete;
+
+    bool create(const std::string& name);
+    bool open_read_only(const std::string& name);
+    void close();
+
+    StatsSegmentLayout* layout() const { return layout_; }
+
+private:
+    StatsSegmentLayout* layout_;
+    void* handle_;  // File mapping handle on Windows
+    bool writable_;
+    std::string name_;
+};
+
+// Writer side, owned by the service. Every call is a no-op when the segment
+// could not be created or a slot index is -1, so callers don't check.
+class StatsSegment {
+public:
+    StatsSegment();
+
+    bool open(const std::string& name);
+    bool is_open() const { return mapping_.layout() != nullptr; }
+
+    // Engine slots follow the engine pool's indices
+    void set_engine(int index, const char* name);
+    void engine_busy(int index, bool busy);
+    void engine_progress(int index, uint64_t new_hashes, double hash_rate);
+
+    // Session slots are recycled; finished sessions stay visible until reused.
+    // Returns -1 when every slot belongs to a running session.
+    int open_session(const std::string& id);
+    void session_engine(int slot, int engine);
+    void session_progress(int slot, uint32_t cursor, uint64_t hashes, uint64_t batches, double hash_rate);
+    void close_session(int slot, StatsSessionState state);
+
+    void publish_solution(const std::string& session_id, uint32_t nonce, const uint32_t hash[8]);
+
+private:
+    StatsMapping mapping_;
+    std::mutex slots_mutex_;          // Session slot allocation only
+    bool session_active_[kStatsMaxSessions];
+    int next_session_;
+    uint64_t solutions_;
+};
+
+// Reader side: maps an existing segment read-only and validates its header
+class StatsSegmentReader {
+public:
+    bool open(const std::string& name);
+    const StatsSegmentLayout* layout() const { return mapping_.layout(); }
+
+    bool read_engine(int index, StatsEngine* out) const;
+    bool read_session(int slot, StatsSession* out) const;
+    bool read_solution(StatsSolution* out) const;
+
+private:
+    StatsMapping mapping_;
+};
+
+uint64_t stats_now_ns();
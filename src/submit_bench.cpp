@@ -0,0 +1,125 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstring>
+#include "miner.cuh"
+#include "bitcoin_rpc.hpp"
+#include "cpu_engine.hpp"
+#include "submit_latency.hpp"
+#include "support_ticket.hpp"
+#include "ticket_verifier.hpp"
+
+// Submission load test: mines easy tickets on the CPU engine and pushes each
+// one through the same found -> verified -> serialized -> broadcast path as
+// the service, against a node or bench/standin_node.py.
+
+void PrintUsage() {
+    std::cout << "Solution submission load test\n";
+    std::cout << "Usage: submit_bench [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help            Show this help message\n";
+    std::cout << "  --rpc-host <host>     Node RPC host (default: 127.0.0.1)\n";
+    std::cout << "  --rpc-port <port>     Node RPC port (default: 18443)\n";
+    std::cout << "  --rpc-user <user>     Node RPC username\n";
+    std::cout << "  --rpc-pass <pass>     Node RPC password\n";
+    std::cout << "  --count <n>           Tickets to submit (default: 1000)\n";
+    std::cout << "  --target <hex>        Mining target (default: 00ffff00...)\n";
+}
+
+static void PrintHop(const SubmitLatency& latency, SubmitHop hop) {
+    const HdrHistogram& histogram = latency.hop(hop);
+    std::cout << std::left << std::setw(10) << SubmitLatency::hop_name(hop) << std::right
+              << std::setw(8) << histogram.count()
+              << std::setw(12) << histogram.percentile(50) / 1e6
+              << std::setw(12) << histogram.percentile(99) / 1e6
+              << std::setw(12) << histogram.percentile(99.9) / 1e6
+              << std::setw(12) << histogram.max() / 1e6 << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string rpc_host = "127.0.0.1";
+    int rpc_port = 18443;
+    std::string rpc_user = "bench";
+    std::string rpc_pass = "bench";
+    int count = 1000;
+    std::string target_hex = "00ffff0000000000000000000000000000000000000000000000000000000000";
+
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "-h" || args[i] == "--help") {
+            PrintUsage();
+            return 0;
+        }
+        else if (args[i] == "--rpc-host" && i + 1 < args.size()) {
+            rpc_host = args[++i];
+        }
+        else if (args[i] == "--rpc-port" && i + 1 < args.size()) {
+            rpc_port = std::stoi(args[++i]);
+        }
+        else if (args[i] == "--rpc-user" && i + 1 < args.size()) {
+            rpc_user = args[++i];
+        }
+        else if (args[i] == "--rpc-pass" && i + 1 < args.size()) {
+            rpc_pass = args[++i];
+        }
+        else if (args[i] == "--count" && i + 1 < args.size()) {
+            count = std::stoi(args[++i]);
+        }
+        else if (args[i] == "--target" && i + 1 < args.size()) {
+            target_hex = args[++i];
+        }
+    }
+
+    Target target;
+    if (!parse_target_hash(target_hex.c_str(), &target)) {
+        std::cerr << "--target must be 64 hex characters" << std::endl;
+        return 1;
+    }
+    CpuEngine engine(0, 1u << 12);
+    TicketVerifier verifier(engine.name());
+    SubmitLatency latency;
+    int accepted = 0;
+
+    try {
+        BitcoinRPC rpc(rpc_host, rpc_port, rpc_user, rpc_pass);
+
+        for (int i = 0; i < count; i++) {
+            MiningHeader header;
+            memset(&header, 0, sizeof(header));
+            header.hash_length = 32;
+            header.address1_length = 20;
+            header.address2_length = 20;
+            header.value = 1;
+            header.timestamp = (uint32_t)i;  // New job per ticket
+
+            SubmitTimeline timeline;
+            if (!mine_block_verified(engine, &header, target, 60.0f, verifier, BatchCallback(), &timeline)) {
+                std::cerr << "No solution for ticket " << i << std::endl;
+                continue;
+            }
+
+            TicketHexTemplate ticket(header);
+            std::string hex = ticket.str();
+            timeline.serialized = std::chrono::steady_clock::now();
+
+            if (rpc.broadcastSupportTicket(hex, &timeline)) {
+                accepted++;
+            }
+            latency.record(timeline);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "\nSubmitted " << count << " tickets, " << accepted << " accepted\n\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::left << std::setw(10) << "hop" << std::right << std::setw(8) << "count"
+              << std::setw(12) << "p50 ms" << std::setw(12) << "p99 ms"
+              << std::setw(12) << "p999 ms" << std::setw(12) << "max ms" << std::endl;
+    for (int h = 0; h < kSubmitHops; h++) {
+        PrintHop(latency, (SubmitHop)h);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "submit_latency.hpp"
+#include <cstdio>
+#include <sstream>
+
+static bool is_set(std::chrono::steady_clock::time_point t) {
+    return t != std::chrono::steady_clock::time_point();
+}
+
+static void record_hop(HdrHistogram& histogram, std::chrono::steady_clock::time_point from,
+                       std::chrono::steady_clock::time_point to) {
+    if (is_set(from) && is_set(to) && to >= from) {
+        histogram.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+    }
+}
+
+void SubmitLatency::record(const SubmitTimeline& timeline) {
+    record_hop(hops_[kHopNotify], timeline.found, timeline.notified);
+    record_hop(hops_[kHopVerify], timeline.notified, timeline.verified);
+    record_hop(hops_[kHopSerialize], timeline.verified, timeline.serialized);
+    record_hop(hops_[kHopSend], timeline.serialized, timeline.sent);
+    record_hop(hops_[kHopRespond], timeline.sent, timeline.responded);
+    record_hop(hops_[kHopTotal], timeline.found, timeline.responded);
+}
+
+const char* SubmitLatency::hop_name(SubmitHop hop) {
+    switch (hop) {
+        case kHopNotify: return "notify";
+        case kHopVerify: return "verify";
+        case kHopSerialize: return "serialize";
+        case kHopSend: return "send";
+        case kHopRespond: return "respond";
+        case kHopTotal: return "total";
+        default: return "unknown";
+    }
+}
+
+std::string SubmitLatency::render_text(const std::string& metric) const {
+    static const double quantiles[] = {0.5, 0.99, 0.999};
+    std::ostringstream out;
+    char buf[64];
+    out << "# HELP " << metric << " Solution found-to-accepted latency per hop\n";
+    out << "# TYPE " << metric << " summary\n";
+    for (int h = 0; h < kSubmitHops; h++) {
+        const HdrHistogram& histogram = hops_[h];
+        const char* name = hop_name((SubmitHop)h);
+        for (double q : quantiles) {
+            snprintf(buf, sizeof(buf), "%g", histogram.percentile(q * 100) / 1e9);
+            out << metric << "{hop=\"" << name << "\",quantile=\"" << q << "\"} " << buf << "\n";
+        }
+        snprintf(buf, sizeof(buf), "%g", histogram.mean() * histogram.count() / 1e9);
+        out << metric << "_sum{hop=\"" << name << "\"} " << buf << "\n";
+        out << metric << "_count{hop=\"" << name << "\"} " << histogram.count() << "\n";
+    }
+    return out.str();
+}
+
+SubmitLatency& global_submit_latency() {
+    static SubmitLatency latency;
+    return latency;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include "hdr_histogram.hpp"
+
+// Timestamps of one solution on its way from the engine to the node.
+// Unset points stay at the clock epoch and the hops touching them are skipped.
+struct SubmitTimeline {
+    std::chrono::steady_clock::time_point found;       // Engine saw the winner
+    std::chrono::steady_clock::time_point notified;    // Pipeline handed it to the host
+    std::chrono::steady_clock::time_point verified;    // CPU re-verification passed
+    std::chrono::steady_clock::time_point serialized;  // Ticket hex ready
+    std::chrono::steady_clock::time_point sent;        // Request on the wire
+    std::chrono::steady_clock::time_point responded;   // Node response received
+};
+
+enum SubmitHop {
+    kHopNotify,     // found -> notified
+    kHopVerify,     // notified -> verified
+    kHopSerialize,  // verified -> serialized
+    kHopSend,       // serialized -> sent
+    kHopRespond,    // sent -> responded
+    kHopTotal,      // found -> responded
+    kSubmitHops
+};
+
+// Found-to-accepted latency, one HDR histogram (nanoseconds) per hop
+class SubmitLatency {
+public:
+    void record(const SubmitTimeline& timeline);
+
+    const HdrHistogram& hop(SubmitHop hop) const { return hops_[hop]; }
+    static const char* hop_name(SubmitHop hop);
+
+    // Prometheus summary lines (quantiles 0.5, 0.99, 0.999 in seconds)
+    std::string render_text(const std::string& metric) const;
+
+private:
+    HdrHistogram hops_[kSubmitHops];
+};
+
+// Latency across every session in the process
+SubmitLatency& global_submit_latency();
@@ -0,0 +1,137 @@
+#include "support_ticket.hpp"
+#include <cstring>
+
+// "000102...ff": two characters per byte value
+struct HexEncodeTable {
+    char pairs[512];
+    HexEncodeTable() {
+        const char digits[] = "0123456789abcdef";
+        for (int i = 0; i < 256; i++) {
+            pairs[i * 2] = digits[i >> 4];
+            pairs[i * 2 + 1] = digits[i & 0x0F];
+        }
+    }
+};
+
+// Nibble value per character, 0xFF for anything that is not a hex digit
+struct HexDecodeTable {
+    uint8_t nibbles[256];
+    HexDecodeTable() {
+        memset(nibbles, 0xFF, sizeof(nibbles));
+        for (int i = 0; i < 10; i++) {
+            nibbles['0' + i] = (uint8_t)i;
+        }
+        for (int i = 0; i < 6; i++) {
+            nibbles['a' + i] = (uint8_t)(10 + i);
+            nibbles['A' + i] = (uint8_t)(10 + i);
+        }
+    }
+};
+
+static const HexEncodeTable kHexEncode;
+static const HexDecodeTable kHexDecode;
+
+void serialize_ticket(const MiningHeader& header, uint8_t* out) {
+    out[TicketLayout::kHashLengthOffset] = (uint8_t)TicketLayout::kHashSize;
+    memcpy(out + TicketLayout::kHashOffset, header.hash, TicketLayout::kHashSize);
+
+    out[TicketLayout::kAddress1LengthOffset] = (uint8_t)TicketLayout::kAddressSize;
+    memcpy(out + TicketLayout::kAddress1Offset, header.address1, TicketLayout::kAddressSize);
+
+    patch_ticket_u32(out, TicketLayout::kValueOffset, header.value);
+
+    out[TicketLayout::kAddress2LengthOffset] = (uint8_t)TicketLayout::kAddressSize;
+    memcpy(out + TicketLayout::kAddress2Offset, header.address2, TicketLayout::kAddressSize);
+
+    out[TicketLayout::kFlagOffset] = header.flag;
+    patch_ticket_u32(out, TicketLayout::kTimestampOffset, header.timestamp);
+    patch_ticket_u32(out, TicketLayout::kNonceOffset, header.nonce);
+}
+
+bool parse_ticket(const uint8_t* ticket, MiningHeader* header) {
+    if (ticket[TicketLayout::kHashLengthOffset] != TicketLayout::kHashSize ||
+        ticket[TicketLayout::kAddress1LengthOffset] != TicketLayout::kAddressSize ||
+        ticket[TicketLayout::kAddress2LengthOffset] != TicketLayout::kAddressSize) {
+        return false;
+    }
+    header->hash_length = (uint8_t)TicketLayout::kHashSize;
+    memcpy(header->hash, ticket + TicketLayout::kHashOffset, TicketLayout::kHashSize);
+    header->address1_length = (uint8_t)TicketLayout::kAddressSize;
+    memcpy(header->address1, ticket + TicketLayout::kAddress1Offset, TicketLayout::kAddressSize);
+    header->value = read_ticket_u32(ticket, TicketLayout::kValueOffset);
+    header->address2_length = (uint8_t)TicketLayout::kAddressSize;
+    memcpy(header->address2, ticket + TicketLayout::kAddress2Offset, TicketLayout::kAddressSize);
+    header->flag = ticket[TicketLayout::kFlagOffset];
+    header->timestamp = read_ticket_u32(ticket, TicketLayout::kTimestampOffset);
+    header->nonce = read_ticket_u32(ticket, TicketLayout::kNonceOffset);
+    return true;
+}
+
+void build_job_constants(const MiningHeader& header, TicketJobConstants* job) {
+    uint8_t padded[TicketLayout::kPaddedSize] = {0};
+    serialize_ticket(header, padded);
+
+    // SHA-256 padding: terminator bit, then the message length in bits (big-endian)
+    padded[TicketLayout::kSize] = 0x80;
+    uint64_t total_bits = (uint64_t)TicketLayout::kSize * 8;
+    for (int i = 0; i < 8; i++) {
+        padded[TicketLayout::kPaddedSize - 1 - i] = (total_bits >> (i * 8)) & 0xFF;
+    }
+
+    for (size_t i = 0; i < TicketLayout::kPaddedWords; i++) {
+        job->words[i] = ((uint32_t)padded[i*4] << 24) |
+                        ((uint32_t)padded[i*4 + 1] << 16) |
+                        ((uint32_t)padded[i*4 + 2] << 8) |
+                        (uint32_t)padded[i*4 + 3];
+    }
+}
+
+void bytes_to_hex(const uint8_t* bytes, size_t len, char* out) {
+    for (size_t i = 0; i < len; i++) {
+        const char* pair = kHexEncode.pairs + bytes[i] * 2;
+        out[i * 2] = pair[0];
+        out[i * 2 + 1] = pair[1];
+    }
+}
+
+bool hex_decode(const char* hex, uint8_t* bytes, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        // Check each nibble before reading the next char so a short string stops at its terminator
+        uint8_t hi = kHexDecode.nibbles[(uint8_t)hex[i * 2]];
+        if (hi > 0x0F) {
+            return false;
+        }
+        uint8_t lo = kHexDecode.nibbles[(uint8_t)hex[i * 2 + 1]];
+        if (lo > 0x0F) {
+            return false;
+        }
+        bytes[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+TicketHexTemplate::TicketHexTemplate() {
+    memset(hex_, '0', TicketLayout::kHexSize);
+    hex_[TicketLayout::kHexSize] = '\0';
+}
+
+TicketHexTemplate::TicketHexTemplate(const MiningHeader& header) {
+    uint8_t ticket[TicketLayout::kSize];
+    serialize_ticket(header, ticket);
+    bytes_to_hex(ticket, sizeof(ticket), hex_);
+    hex_[TicketLayout::kHexSize] = '\0';
+}
+
+void TicketHexTemplate::set_timestamp(uint32_t timestamp) {
+    patch_u32(TicketLayout::kTimestampOffset, timestamp);
+}
+
+void TicketHexTemplate::set_nonce(uint32_t nonce) {
+    patch_u32(TicketLayout::kNonceOffset, nonce);
+}
+
+void TicketHexTemplate::patch_u32(size_t offset, uint32_t value) {
+    uint8_t bytes[4];
+    patch_ticket_u32(bytes, 0, value);
+    bytes_to_hex(bytes, sizeof(bytes), hex_ + offset * 2);
+}
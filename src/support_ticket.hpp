@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "miner.cuh"
+
+// Byte layout of a serialized support ticket. This is the single description
+// of what gets hashed (GPU and CPU) and what gets broadcast to the node.
+struct TicketLayout {
+    static constexpr size_t kHashSize = 32;
+    static constexpr size_t kAddressSize = 20;
+
+    static constexpr size_t kHashLengthOffset = 0;
+    static constexpr size_t kHashOffset = kHashLengthOffset + 1;
+    static constexpr size_t kAddress1LengthOffset = kHashOffset + kHashSize;
+    static constexpr size_t kAddress1Offset = kAddress1LengthOffset + 1;
+    static constexpr size_t kValueOffset = kAddress1Offset + kAddressSize;
+    static constexpr size_t kAddress2LengthOffset = kValueOffset + 4;
+    static constexpr size_t kAddress2Offset = kAddress2LengthOffset + 1;
+    static constexpr size_t kFlagOffset = kAddress2Offset + kAddressSize;
+    static constexpr size_t kTimestampOffset = kFlagOffset + 1;
+    static constexpr size_t kNonceOffset = kTimestampOffset + 4;
+    static constexpr size_t kSize = kNonceOffset + 4;
+    static constexpr size_t kHexSize = kSize * 2;
+
+    // SHA-256 padded message (0x80 terminator + 64-bit bit length)
+    static constexpr size_t kBlockSize = 64;
+    static constexpr size_t kPaddedSize = ((kSize + 1 + 8 + kBlockSize - 1) / kBlockSize) * kBlockSize;
+    static constexpr size_t kPaddedWords = kPaddedSize / 4;
+
+    // Only the timestamp and nonce change within a job; both sit on word
+    // boundaries in the last block so engines can patch whole words
+    static constexpr size_t kTimestampWord = kTimestampOffset / 4;
+    static constexpr size_t kNonceWord = kNonceOffset / 4;
+
+    // Words before the last block do not depend on the nonce and can be
+    // folded into a midstate once per job
+    static constexpr size_t kTailWord = kPaddedWords - kBlockSize / 4;
+    static constexpr size_t kTailNonceWord = kNonceWord - kTailWord;
+};
+
+static_assert(TicketLayout::kSize == 88, "Support ticket must be 88 bytes");
+static_assert(TicketLayout::kPaddedSize == 128, "Support ticket must hash as two SHA-256 blocks");
+static_assert(TicketLayout::kTimestampOffset % 4 == 0 && TicketLayout::kNonceOffset % 4 == 0,
+              "Timestamp and nonce must be word aligned");
+static_assert(TicketLayout::kTimestampOffset >= TicketLayout::kBlockSize,
+              "Per-nonce fields must live in the last SHA-256 block");
+
+// Job constants handed to the hashing engines: the padded ticket as big-endian
+// message words, with the nonce word left for the engine to fill in
+struct TicketJobConstants {
+    uint32_t words[TicketLayout::kPaddedWords];
+};
+
+// Serialize a header into exactly TicketLayout::kSize bytes
+void serialize_ticket(const MiningHeader& header, uint8_t* out);
+
+// Store a little-endian uint32 field at the given ticket offset
+inline void patch_ticket_u32(uint8_t* ticket, size_t offset, uint32_t value) {
+    ticket[offset] = value & 0xFF;
+    ticket[offset + 1] = (value >> 8) & 0xFF;
+    ticket[offset + 2] = (value >> 16) & 0xFF;
+    ticket[offset + 3] = (value >> 24) & 0xFF;
+}
+
+// Load a little-endian uint32 field from the given ticket offset
+inline uint32_t read_ticket_u32(const uint8_t* ticket, size_t offset) {
+    return (uint32_t)ticket[offset] |
+           ((uint32_t)ticket[offset + 1] << 8) |
+           ((uint32_t)ticket[offset + 2] << 16) |
+           ((uint32_t)ticket[offset + 3] << 24);
+}
+
+// Parse exactly TicketLayout::kSize serialized bytes back into a header;
+// false if a length prefix is not the fixed field size
+bool parse_ticket(const uint8_t* ticket, MiningHeader* header);
+
+// Build the padded message words for a job (nonce word holds header.nonce)
+void build_job_constants(const MiningHeader& header, TicketJobConstants* job);
+
+// Table-driven hex encoding into a caller buffer of 2 * len chars (no terminator)
+void bytes_to_hex(const uint8_t* bytes, size_t len, char* out);
+
+// Table-driven hex decoding of exactly 2 * len chars, false on any non-hex char
+bool hex_decode(const char* hex, uint8_t* bytes, size_t len);
+
+// Hex form of a job's ticket. Built once per job; only the timestamp and
+// nonce characters are rewritten before each broadcast.
+class TicketHexTemplate {
+public:
+    TicketHexTemplate();
+    explicit TicketHexTemplate(const MiningHeader& header);
+
+    void set_timestamp(uint32_t timestamp);
+    void set_nonce(uint32_t nonce);
+
+    const char* data() const { return hex_; }
+    size_t size() const { return TicketLayout::kHexSize; }
+    std::string str() const { return std::string(hex_, TicketLayout::kHexSize); }
+
+private:
+    void patch_u32(size_t offset, uint32_t value);
+
+    char hex_[TicketLayout::kHexSize + 1];
+};
@@ -0,0 +1,108 @@
+#include "throttle.hpp"
+#include <algorithm>
+#include <thread>
+
+// Unused allowance carried over, so an idle moment doesn't buy a burst
+static const double kBurstSeconds = 0.05;
+// Waits are sliced so limits changed while waiting take effect promptly
+static const double kMaxSleepSeconds = 0.1;
+
+Throttle::Throttle()
+    : max_hash_rate_(0)
+    , duty_cycle_(1)
+    , balance_(0)
+    , refilled_(std::chrono::steady_clock::now()) {
+}
+
+void Throttle::set_limits(double max_hash_rate, double duty_cycle) {
+    max_hash_rate_.store(std::max(0.0, max_hash_rate), std::memory_order_relaxed);
+    duty_cycle_.store(duty_cycle <= 0 || duty_cycle > 1 ? 1.0 : duty_cycle, std::memory_order_relaxed);
+}
+
+double Throttle::allowed_rate(double full_rate) const {
+    double rate = max_hash_rate();
+    double duty = duty_cycle();
+    if (duty < 1 && full_rate > 0) {
+        rate = rate > 0 ? std::min(rate, duty * full_rate) : duty * full_rate;
+    }
+    return rate;
+}
+
+void Throttle::refill(double rate, std::chrono::steady_clock::time_point now) {
+    // Another thread on the bucket may have refilled it at a later time
+    std::chrono::duration<double> elapsed = std::max(now - refilled_, std::chrono::steady_clock::duration::zero());
+    refilled_ = std::max(refilled_, now);
+    if (rate <= 0) {
+        balance_ = 0;  // Unlimited: no debt survives lifting the cap
+        return;
+    }
+    balance_ = std::min(balance_ + rate * elapsed.count(), rate * kBurstSeconds);
+}
+
+void Throttle::spend(double hashes, double rate, std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(bucket_mutex_);
+    refill(rate, now);
+    if (rate > 0) {
+        balance_ -= hashes;
+    }
+}
+
+double Throttle::debt_seconds(double rate, std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(bucket_mutex_);
+    refill(rate, now);
+    return balance_ < 0 ? -balance_ / rate : 0.0;
+}
+
+BatchPacer::BatchPacer(Throttle* engine, Throttle* session, double* full_rate)
+    : engine_(engine)
+    , session_(session)
+    , full_rate_(full_rate)
+    , held_back_(true)  // The first interval includes job setup
+    , released_(std::chrono::steady_clock::now()) {
+}
+
+double BatchPacer::pace(const ProgressObserver& progress) {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t hashes = progress.batch_hashes();
+    bool restarted = progress.restarted();
+
+    // With every slot kept busy, the gap between collects is device time
+    std::chrono::duration<double> interval = now - released_;
+    if (!held_back_ && !restarted && interval.count() > 0) {
+        double sample = hashes / interval.count();
+        *full_rate_ = *full_rate_ > 0 ? *full_rate_ + 0.2 * (sample - *full_rate_) : sample;
+    }
+
+    double engine_rate = engine_ ? engine_->allowed_rate(*full_rate_) : 0;
+    double session_rate = session_ ? session_->allowed_rate(*full_rate_) : 0;
+    if (engine_rate > 0) {
+        engine_->spend((double)hashes, engine_rate, now);
+    }
+    if (session_rate > 0) {
+        session_->spend((double)hashes, session_rate, now);
+    }
+
+    double slept = 0;
+    for (;;) {
+        engine_rate = engine_ ? engine_->allowed_rate(*full_rate_) : 0;
+        session_rate = session_ ? session_->allowed_rate(*full_rate_) : 0;
+        double wait = 0;
+        if (engine_rate > 0) {
+            wait = std::max(wait, engine_->debt_seconds(engine_rate, now));
+        }
+        if (session_rate > 0) {
+            wait = std::max(wait, session_->debt_seconds(session_rate, now));
+        }
+        if (wait <= 0) {
+            break;
+        }
+        double step = std::min(wait, kMaxSleepSeconds);
+        std::this_thread::sleep_for(std::chrono::duration<double>(step));
+        slept += step;
+        now = std::chrono::steady_clock::now();
+    }
+
+    held_back_ = slept > 0;
+    released_ = std::chrono::steady_clock::now();
+    return slept;
+}
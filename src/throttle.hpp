@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include "mining_progress.hpp"
+
+// Throughput cap for an engine or a session: a hash rate, a share of the
+// engine's full speed (duty cycle), or both, the lower one winning. Limits
+// may be changed from any thread while mining. A session split over two
+// engines charges both threads' batches to its one bucket, so the bucket has
+// a lock of its own; it is taken once or twice per batch.
+class Throttle {
+public:
+    Throttle();
+
+    // max_hash_rate in H/s, 0 = no cap; duty_cycle in (0, 1], 0 or 1 = no cap
+    void set_limits(double max_hash_rate, double duty_cycle);
+    double max_hash_rate() const { return max_hash_rate_.load(std::memory_order_relaxed); }
+    double duty_cycle() const { return duty_cycle_.load(std::memory_order_relaxed); }
+    bool limited() const { return max_hash_rate() > 0 || duty_cycle() < 1; }
+
+    // Rate the limits allow on an engine that does full_rate unthrottled,
+    // 0 when unlimited (or when only a duty cycle is set and full_rate is unknown)
+    double allowed_rate(double full_rate) const;
+
+    // Token bucket in hashes: charge a batch, then ask how long until the
+    // balance is out of debt at the current allowed rate
+    void spend(double hashes, double rate, std::chrono::steady_clock::time_point now);
+    double debt_seconds(double rate, std::chrono::steady_clock::time_point now);
+
+private:
+    void refill(double rate, std::chrono::steady_clock::time_point now);
+
+    std::atomic<double> max_hash_rate_;
+    std::atomic<double> duty_cycle_;
+    std::mutex bucket_mutex_;  // Guards balance_ and refilled_
+    double balance_;
+    std::chrono::steady_clock::time_point refilled_;
+};
+
+// Paces one session's batch dispatch under its engine's throttle and its
+// own. pace() is called from the BatchCallback, after a batch is collected
+// and before its slot is refilled, so holding it back delays the next launch
+// and nothing inside the pipeline changes. The engine's full speed, needed
+// for duty cycles, is learned from batches that were not held back.
+// Batch sizes come from the job's ProgressObserver.
+class BatchPacer {
+public:
+    // full_rate is the engine's estimate, shared by the sessions that lease it
+    BatchPacer(Throttle* engine, Throttle* session, double* full_rate);
+
+    // Sleeps as long as the caps require; returns the seconds slept.
+    // progress has just observed the batch.
+    double pace(const ProgressObserver& progress);
+
+private:
+    Throttle* engine_;
+    Throttle* session_;
+    double* full_rate_;
+    bool held_back_;  // The previous batch waited, so this interval isn't full speed
+    std::chrono::steady_clock::time_point released_;
+};
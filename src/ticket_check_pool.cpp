@@ -0,0 +1,84 @@
+#include "ticket_check_pool.hpp"
+#include "sha256_host.hpp"
+#include "ticket_verifier.hpp"
+#include "trace.hpp"
+
+// Small enough to balance a batch over the workers, large enough that the
+// queue lock is not taken per ticket
+static const size_t kChunkTickets = 256;
+
+TicketCheckPool::TicketCheckPool(int threads)
+    : shutdown_(false)
+    , passed_metric_(miner_metrics().counter("miner_ticket_checks_total",
+          "Tickets checked by VerifyTickets", metric_label("result", "pass")))
+    , failed_metric_(miner_metrics().counter("miner_ticket_checks_total",
+          "Tickets checked by VerifyTickets", metric_label("result", "fail"))) {
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+        if (threads <= 0) {
+            threads = 1;
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        workers_.emplace_back(&TicketCheckPool::worker_loop, this);
+    }
+}
+
+TicketCheckPool::~TicketCheckPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    work_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void TicketCheckPool::check(TicketCheck* checks, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    TraceSpan span("ticket_checks");
+    Call call;
+    std::unique_lock<std::mutex> lock(mutex_);
+    call.pending = 0;
+    for (size_t offset = 0; offset < count; offset += kChunkTickets) {
+        size_t chunk = count - offset < kChunkTickets ? count - offset : kChunkTickets;
+        queue_.push_back(Chunk{&call, checks + offset, chunk});
+        call.pending++;
+    }
+    work_cv_.notify_all();
+    done_cv_.wait(lock, [&call]() { return call.pending == 0; });
+}
+
+void TicketCheckPool::worker_loop() {
+    for (;;) {
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this]() { return shutdown_ || !queue_.empty(); });
+            if (shutdown_) {
+                return;
+            }
+            chunk = queue_.front();
+            queue_.pop_front();
+        }
+
+        uint64_t passed = 0;
+        for (size_t i = 0; i < chunk.count; i++) {
+            TicketCheck& check = chunk.checks[i];
+            TicketVerifier::ticket_hash(check.header, check.hash);
+            check.valid = hash_meets_target(check.hash, check.target.words);
+            passed += check.valid;
+        }
+        passed_metric_.add(passed);
+        failed_metric_.add(chunk.count - passed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            chunk.call->pending--;
+        }
+        done_cv_.notify_all();
+    }
+}
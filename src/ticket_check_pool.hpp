@@ -0,0 +1,56 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "miner.cuh"
+#include "metrics.hpp"
+
+// A ticket checked on behalf of a downstream validator
+struct TicketCheck {
+    MiningHeader header;
+    Target target;
+    bool valid;        // Out: hash meets the target
+    uint32_t hash[8];  // Out: double SHA-256 in display word order
+};
+
+// Worker threads hashing submitted tickets through the same OpenSSL path as
+// TicketVerifier (SHA-NI / AVX2 when the CPU has them). Calls from several
+// RPCs share the workers; each call is split into chunks so large batches
+// spread over the whole pool while small ones cost one wakeup.
+class TicketCheckPool {
+public:
+    // threads = 0 uses every hardware thread
+    explicit TicketCheckPool(int threads = 0);
+    ~TicketCheckPool();
+
+    // Hash and check every ticket, blocking until all are done
+    void check(TicketCheck* checks, size_t count);
+
+    size_t threads() const { return workers_.size(); }
+
+private:
+    struct Call {
+        size_t pending;  // Chunks not yet finished
+    };
+
+    struct Chunk {
+        Call* call;
+        TicketCheck* checks;
+        size_t count;
+    };
+
+    void worker_loop();
+
+    std::deque<Chunk> queue_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool shutdown_;
+    std::vector<std::thread> workers_;
+    Counter& passed_metric_;
+    Counter& failed_metric_;
+};
@@ -0,0 +1,152 @@
+#include "ticket_verifier.hpp"
+#include "hash_writer.hpp"
+#include "sha256_host.hpp"
+#include "support_ticket.hpp"
+#include "mining_pipeline.hpp"
+#include "trace.hpp"
+#include "log.hpp"
+#include <chrono>
+#include <cstring>
+
+TicketVerifier::TicketVerifier(const std::string& engine_name)
+    : engine_name_(engine_name)
+    , checked_(0)
+    , accepted_(0)
+    , rejected_(0)
+    , found_metric_(miner_metrics().counter("miner_solutions_found_total",
+          "Solutions reported by an engine", metric_label("engine", engine_name)))
+    , verified_metric_(miner_metrics().counter("miner_solutions_verified_total",
+          "Solutions that passed CPU re-verification", metric_label("engine", engine_name)))
+    , rejected_metric_(miner_metrics().counter("miner_solutions_rejected_total",
+          "Solutions rejected by CPU re-verification", metric_label("engine", engine_name))) {
+}
+
+void TicketVerifier::ticket_hash(const MiningHeader& header, uint32_t hash[8]) {
+    uint8_t ticket[TicketLayout::kSize];
+    serialize_ticket(header, ticket);
+
+    // OpenSSL picks the SHA-NI / AVX2 code path for the compression function when available
+    unsigned char first[SHA256_DIGEST_LENGTH];
+    unsigned char second[SHA256_DIGEST_LENGTH];
+    {
+        HashWriter writer;
+        writer.write(ticket, sizeof(ticket));
+        writer.finalize(first);
+    }
+    {
+        HashWriter writer;
+        writer.write(first, sizeof(first));
+        writer.finalize(second);
+    }
+
+    // Display order: digest bytes reversed, packed as big-endian words (matches the kernel output)
+    for (int i = 0; i < 8; i++) {
+        hash[i] = ((uint32_t)second[31 - i*4] << 24) |
+                  ((uint32_t)second[30 - i*4] << 16) |
+                  ((uint32_t)second[29 - i*4] << 8) |
+                  (uint32_t)second[28 - i*4];
+    }
+}
+
+size_t TicketVerifier::verify_batch(const TicketCandidate* candidates, size_t count, VerifyResult* results) {
+    TraceSpan span("verify");
+    size_t accepted = 0;
+    for (size_t i = 0; i < count; i++) {
+        const TicketCandidate& candidate = candidates[i];
+        VerifyResult& result = results[i];
+
+        ticket_hash(candidate.header, result.hash);
+        result.hash_mismatch = candidate.has_device_hash &&
+            memcmp(result.hash, candidate.device_hash, sizeof(result.hash)) != 0;
+        result.valid = !result.hash_mismatch && hash_meets_target(result.hash, candidate.target.words);
+        if (result.valid) {
+            accepted++;
+        }
+    }
+
+    checked_.fetch_add(count, std::memory_order_relaxed);
+    accepted_.fetch_add(accepted, std::memory_order_relaxed);
+    rejected_.fetch_add(count - accepted, std::memory_order_relaxed);
+    found_metric_.add(count);
+    verified_metric_.add(accepted);
+    rejected_metric_.add(count - accepted);
+    return accepted;
+}
+
+bool TicketVerifier::verify(const MiningHeader& header, const Target& target,
+                            const uint32_t* device_hash, VerifyResult* result) {
+    TicketCandidate candidate;
+    candidate.header = header;
+    candidate.target = target;
+    candidate.has_device_hash = device_hash != nullptr;
+    if (device_hash) {
+        memcpy(candidate.device_hash, device_hash, sizeof(candidate.device_hash));
+    }
+
+    VerifyResult local;
+    VerifyResult& out = result ? *result : local;
+    return verify_batch(&candidate, 1, &out) == 1;
+}
+
+// Shared retry loop: mine_fn(header, remaining, device_hash) runs one search
+template <typename MineFn>
+static bool mine_verified_loop(MiningHeader* header, const Target& target, float time_limit,
+                               TicketVerifier& verifier, SubmitTimeline* timeline, VerifyCounts* counts,
+                               MineFn mine_fn) {
+    auto start = std::chrono::steady_clock::now();
+    float remaining = time_limit;
+
+    while (remaining > 0) {
+        uint32_t device_hash[8];
+        if (!mine_fn(header, remaining, device_hash)) {
+            return false;
+        }
+
+        VerifyResult result;
+        bool valid = verifier.verify(*header, target, device_hash, &result);
+        if (counts) {
+            (valid ? counts->accepted : counts->rejected)++;
+        }
+        if (valid) {
+            if (timeline) {
+                timeline->verified = std::chrono::steady_clock::now();
+            }
+            return true;
+        }
+
+        // A faulty device can reject in a tight loop; the counter keeps the full tally
+        MINER_LOG_RATE_LIMITED(LogSeverity::Warning, 10,
+                               "Rejected solution from {} engine at nonce {:08x} ({}), rejected so far: {}",
+                               verifier.engine_name(), header->nonce,
+                               result.hash_mismatch ? "hash mismatch" : "above target", verifier.rejected());
+
+        // Skip the bad nonce and keep searching with whatever time is left
+        header->nonce++;
+        std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+        remaining = time_limit - elapsed.count();
+    }
+    return false;
+}
+
+bool mine_block_verified(MiningHeader* header, Target target, float time_limit,
+                         TicketVerifier& verifier) {
+    return mine_verified_loop(header, target, time_limit, verifier, nullptr, nullptr,
+        [&target](MiningHeader* h, float remaining, uint32_t* device_hash) {
+            return mine_block(h, target, remaining, device_hash);
+        });
+}
+
+bool mine_block_verified(MiningEngine& engine, MiningHeader* header, Target target, float time_limit,
+                         TicketVerifier& verifier, const BatchCallback& on_batch,
+                         SubmitTimeline* timeline, VerifyCounts* counts) {
+    return mine_verified_loop(header, target, time_limit, verifier, timeline, counts,
+        [&](MiningHeader* h, float remaining, uint32_t* device_hash) {
+            PipelineStats stats;
+            bool found = run_pipeline(engine, h, target, remaining, device_hash, on_batch, &stats);
+            if (found && timeline) {
+                timeline->found = stats.found_at;
+                timeline->notified = std::chrono::steady_clock::now();
+            }
+            return found;
+        });
+}
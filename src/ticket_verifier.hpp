@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "miner.cuh"
+#include "mining_pipeline.hpp"
+#include "metrics.hpp"
+#include "submit_latency.hpp"
+
+// A solution reported by an engine, waiting for host-side re-verification
+struct TicketCandidate {
+    MiningHeader header;     // Header with the winning nonce filled in
+    Target target;
+    uint32_t device_hash[8]; // Hash the engine reported (display word order)
+    bool has_device_hash;    // False when the engine did not report a hash
+};
+
+struct VerifyResult {
+    bool valid;              // Hash meets the target and matches the device hash
+    bool hash_mismatch;      // Device-reported hash differs from the CPU hash
+    uint32_t hash[8];        // CPU hash in display word order
+};
+
+// Recomputes the double SHA-256 of the serialized support ticket on the CPU
+// and checks it before anything is broadcast. One verifier per engine, so the
+// rejection counters tell which engine produced bad tickets.
+class TicketVerifier {
+public:
+    explicit TicketVerifier(const std::string& engine_name);
+
+    // Verify a batch of candidates, returns the number of accepted tickets
+    size_t verify_batch(const TicketCandidate* candidates, size_t count, VerifyResult* results);
+
+    // Verify a single header, device_hash may be null
+    bool verify(const MiningHeader& header, const Target& target,
+                const uint32_t* device_hash = nullptr, VerifyResult* result = nullptr);
+
+    const std::string& engine_name() const { return engine_name_; }
+    uint64_t checked() const { return checked_.load(std::memory_order_relaxed); }
+    uint64_t accepted() const { return accepted_.load(std::memory_order_relaxed); }
+    uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+    // Double SHA-256 of the serialized ticket, in display word order
+    static void ticket_hash(const MiningHeader& header, uint32_t hash[8]);
+
+private:
+    std::string engine_name_;
+    std::atomic<uint64_t> checked_;
+    std::atomic<uint64_t> accepted_;
+    std::atomic<uint64_t> rejected_;
+    Counter& found_metric_;
+    Counter& verified_metric_;
+    Counter& rejected_metric_;
+};
+
+// Solutions checked by mine_block_verified calls, for callers that need the
+// counts of their own runs rather than the verifier's running totals
+struct VerifyCounts {
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;
+};
+
+// Mine until a solution passes CPU verification or the time limit expires.
+// Rejected solutions are counted and mining continues past the bad nonce.
+bool mine_block_verified(MiningHeader* header, Target target, float time_limit,
+                         TicketVerifier& verifier);
+
+// Same, on a caller-owned engine (e.g. leased from an EnginePool). timeline
+// (optional) receives the found, notified and verified times of the winner;
+// counts (optional) is added to as each solution is checked, so on_batch
+// sees it up to date.
+bool mine_block_verified(MiningEngine& engine, MiningHeader* header, Target target, float time_limit,
+                         TicketVerifier& verifier, const BatchCallback& on_batch = BatchCallback(),
+                         SubmitTimeline* timeline = nullptr, VerifyCounts* counts = nullptr);
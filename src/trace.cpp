@@ -0,0 +1,129 @@
+#include "trace.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> g_trace_enabled(false);
+
+static const size_t kTraceRingSize = 16384;  // Spans kept per thread
+static const size_t kMaxTraceRings = 256;    // Threads that can record
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    int64_t start_us;
+    int64_t dur_us;
+};
+
+// Single-writer ring: only the owning thread writes, dumps read concurrently
+// and drop anything the writer may have overwritten while they copied
+struct TraceRing {
+    uint32_t tid;
+    std::atomic<uint64_t> head;
+    TraceEvent events[kTraceRingSize];
+};
+
+static const std::chrono::steady_clock::time_point trace_epoch = std::chrono::steady_clock::now();
+static std::mutex trace_rings_mutex;
+static std::vector<std::unique_ptr<TraceRing>> trace_rings;  // Kept after their threads exit
+static std::mutex trace_dump_mutex;  // Sessions ending together dump one at a time
+
+static int64_t trace_micros(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t - trace_epoch).count();
+}
+
+// Ring for the calling thread, registered on first use (null once the cap is hit)
+static TraceRing* thread_ring() {
+    thread_local TraceRing* ring = nullptr;
+    thread_local bool registered = false;
+    if (!registered) {
+        registered = true;
+        std::lock_guard<std::mutex> lock(trace_rings_mutex);
+        if (trace_rings.size() < kMaxTraceRings) {
+            std::unique_ptr<TraceRing> owned(new TraceRing());
+            owned->tid = (uint32_t)trace_rings.size() + 1;
+            owned->head.store(0, std::memory_order_relaxed);
+            ring = owned.get();
+            trace_rings.push_back(std::move(owned));
+        } else {
+            LOG_WARNING("Trace ring limit reached, spans from this thread are dropped");
+        }
+    }
+    return ring;
+}
+
+void trace_enable(bool enabled) {
+    g_trace_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void trace_record(const char* name, const char* category,
+                  std::chrono::steady_clock::time_point start,
+                  std::chrono::steady_clock::time_point end) {
+    TraceRing* ring = thread_ring();
+    if (!ring) {
+        return;
+    }
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    TraceEvent& event = ring->events[head % kTraceRingSize];
+    event.name = name;
+    event.category = category;
+    event.start_us = trace_micros(start);
+    event.dur_us = trace_micros(end) - event.start_us;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+// Written to a temporary file and renamed over path, so a reader never sees
+// a dump half written
+bool trace_dump(const std::string& path) {
+    std::lock_guard<std::mutex> dump_lock(trace_dump_mutex);
+    const std::string temp_path = path + ".tmp";
+    std::ofstream out(temp_path, std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_ERROR("Failed to open trace file: {}", temp_path);
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<TraceEvent> events;
+    std::lock_guard<std::mutex> lock(trace_rings_mutex);
+    for (const auto& ring : trace_rings) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = head > kTraceRingSize ? head - kTraceRingSize : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++) {
+            events.push_back(ring->events[i % kTraceRingSize]);
+        }
+
+        // Slots at or below the new head - size may have been rewritten mid-copy
+        uint64_t after = ring->head.load(std::memory_order_acquire);
+        uint64_t skip = after >= kTraceRingSize && after - kTraceRingSize >= begin
+            ? after - kTraceRingSize - begin + 1 : 0;
+
+        for (size_t i = (size_t)std::min<uint64_t>(skip, events.size()); i < events.size(); i++) {
+            const TraceEvent& event = events[i];
+            out << (first ? "" : ",") << "\n{\"name\":\"" << event.name
+                << "\",\"cat\":\"" << event.category
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid
+                << ",\"ts\":" << event.start_us << ",\"dur\":" << event.dur_us << "}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    out.close();
+    if (!out) {
+        LOG_ERROR("Failed to write trace file: {}", temp_path);
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        LOG_ERROR("Failed to replace trace file {}: {}", path, error.message());
+        return false;
+    }
+    return true;
+}
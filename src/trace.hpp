@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Opt-in span tracing, dumped as Chrome trace-event JSON (chrome://tracing,
+// ui.perfetto.dev). Each thread records into its own fixed-size ring buffer
+// without locks; when tracing is off a span costs one relaxed load.
+// Span names and categories must be string literals.
+
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool trace_enabled() {
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+void trace_enable(bool enabled);
+
+// Record a finished span [start, end) on the calling thread
+void trace_record(const char* name, const char* category,
+                  std::chrono::steady_clock::time_point start,
+                  std::chrono::steady_clock::time_point end);
+
+// Write every thread's buffered spans to path, false on I/O error
+bool trace_dump(const std::string& path);
+
+// Records the enclosing scope as a span
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* category = "miner")
+        : name_(name)
+        , category_(category)
+        , active_(trace_enabled()) {
+        if (active_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (active_) {
+            trace_record(name_, category_, start_, std::chrono::steady_clock::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
@@ -1,17 +1,18 @@
 #include "cuda_miner.h"
-#include <QDebug>
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QTimer>
+#include <climits>
 #include <iostream>
 
 // Include mining header directly
 #include "../miner.cuh"
+#include "../log.hpp"
 
 // Helper for CUDA errors
 static void checkCudaError(cudaError_t error, const char* message) {
     if (error != cudaSuccess) {
-        qDebug() << message << ": " << cudaGetErrorString(error);
+        LOG_ERROR("{}: {}", message, cudaGetErrorString(error));
     }
 }
 
@@ -20,6 +21,7 @@ CudaMinerWorker::CudaMinerWorker(QObject* parent)
     : QObject(parent)
     , mShouldStop(false)
     , mPaused(false)
+    , mVerifier("cuda")
 {
 }
 
@@ -50,15 +52,12 @@ void CudaMinerWorker::doMining(
     mShouldStop = false;
     mPaused = false;
     
-    qDebug() << "Starting CUDA mining with parameters:";
-    qDebug() << "Hash:" << hash;
-    qDebug() << "Address1:" << addr1;
-    qDebug() << "Address2:" << addr2;
-    qDebug() << "Value:" << value;
-    qDebug() << "Timestamp:" << timestamp;
-    qDebug() << "Flag:" << flag;
-    qDebug() << "Target:" << targetStr;
-    qDebug() << "Max time:" << maxTimeSeconds << "seconds";
+    if (log_enabled(LogSeverity::Debug)) {
+        log_write(LogSeverity::Debug, "Starting CUDA mining: hash {}, address1 {}, address2 {}",
+                  hash.toStdString(), addr1.toStdString(), addr2.toStdString());
+        log_write(LogSeverity::Debug, "value {}, timestamp {}, flag {}, target {}, max time {} seconds",
+                  value, timestamp, flag, targetStr.toStdString(), maxTimeSeconds);
+    }
     
     // Initialize mining header
     MiningHeader header;
@@ -104,8 +103,11 @@ void CudaMinerWorker::doMining(
     
     // Set target based on input or use default
     Target target;
-    if (!targetStr.isEmpty() && targetStr.length() == 64) {
-        target = parse_target_hash(targetStr.toStdString().c_str());
+    if (!targetStr.isEmpty()) {
+        if (!parse_target_hash(targetStr.toStdString().c_str(), &target)) {
+            emit resultReady(false, "Invalid target format", 0);
+            return;
+        }
     } else {
         // Decode target to 0x00000000ffff0000000000000000000000000000000000000000000000000000
         // which is a common testnet target
@@ -113,44 +115,59 @@ void CudaMinerWorker::doMining(
         target = decode_compact_target(compact);
     }
     
-    // Track mining progress
-    uint64_t totalHashes = 0;
-    QString bestHash = "";
+    // Configure max time
+    float maxTime = (maxTimeSeconds <= 0) ? 3600.0f : static_cast<float>(maxTimeSeconds);
     
-    // Create a timer to periodically update progress
-    QTimer progressTimer;
-    progressTimer.setInterval(500);
-    progressTimer.setSingleShot(false);
+    // The engine stays resident across jobs, like the server's pool engines
+    if (!mEngine) {
+        mEngine.reset(new CudaEngine());
+    }
+    if (!mEngine->ok()) {
+        mEngine.reset();
+        emit resultReady(false, "Failed to initialize the CUDA device", 0);
+        return;
+    }
     
-    // Connect timer to a lambda that updates progress
-    connect(&progressTimer, &QTimer::timeout, [this, &header, &totalHashes, &bestHash]() {
-        totalHashes = header.nonce;
-        
-        // Progress is just a percentage of time elapsed or nonce space
-        int progress = (header.nonce * 100) / 0xFFFFFFFF;
-        if (progress > 99) progress = 99;
-        
-        emit progressUpdated(progress, totalHashes, bestHash);
-        emit hashRateUpdated(totalHashes / 1000000); // MH/s
+    // Progress is published at batch boundaries and sampled by CudaMiner;
+    // the pipeline drains and returns as soon as a pause or stop is seen
+    mProgress.reset();
+    bool pausedRun = false;  // The run was ended by a pause, not by its budget; a quick resume can't unset it
+    BatchCallback onBatch = mProgress.callback([this, &pausedRun]() {
+        if (mShouldStop) {
+            return false;
+        }
+        if (mPaused) {
+            pausedRun = true;
+            return false;
+        }
+        return true;
     });
     
-    // Start the timer
-    progressTimer.start();
-    
-    // Configure max time
-    float maxTime = (maxTimeSeconds <= 0) ? 3600.0f : static_cast<float>(maxTimeSeconds);
-    
     // Run the mining function (blocking call)
     bool success = false;
     try {
-        success = mine_block(&header, target, maxTime);
+        float remaining = maxTime;
+        while (remaining > 0) {
+            // Solutions are re-verified on the CPU before they are reported
+            QElapsedTimer runTimer;
+            runTimer.start();
+            pausedRun = false;
+            success = mine_block_verified(*mEngine, &header, target, remaining, mVerifier, onBatch);
+            if (success || mShouldStop || !pausedRun) {
+                break;
+            }
+            
+            // Paused: header.nonce is the resume point, time paused doesn't count
+            remaining -= runTimer.elapsed() / 1000.0f;
+            QMutexLocker locker(&mPauseMutex);
+            while (mPaused && !mShouldStop) {
+                mPauseCondition.wait(&mPauseMutex);
+            }
+        }
         
         // If successful, get the hash
         if (success) {
-            // Instead of using mine_kernel_hash (which doesn't exist in the header),
-            // just use the current header info to report the found hash
-            // Create a simple representation of the winning hash
-            bestHash = QString("Found valid block with nonce: %1").arg(header.nonce);
+            QString bestHash = QString("Found valid block with nonce: %1").arg(header.nonce);
 
             // Update the CudaMiner directly with the winning nonce
             if (m_miner) {
@@ -162,13 +179,10 @@ void CudaMinerWorker::doMining(
         }
     }
     catch (const std::exception& e) {
-        qDebug() << "Mining exception:" << e.what();
+        LOG_ERROR("Mining exception: {}", e.what());
         success = false;
     }
     
-    // Stop the timer
-    progressTimer.stop();
-    
     // Send the result
     if (!success) {
         if (mShouldStop) {
@@ -181,7 +195,9 @@ void CudaMinerWorker::doMining(
 
 void CudaMinerWorker::stopMining()
 {
+    QMutexLocker locker(&mPauseMutex);
     mShouldStop = true;
+    mPauseCondition.wakeAll();
 }
 
 void CudaMinerWorker::pauseMining()
@@ -191,13 +207,14 @@ void CudaMinerWorker::pauseMining()
 
 void CudaMinerWorker::resumeMining()
 {
+    QMutexLocker locker(&mPauseMutex);
     mPaused = false;
     mPauseCondition.wakeAll();
 }
 
 // CudaMiner implementation
 CudaMiner::CudaMiner(QObject* parent)
-    : QObject(parent)
+    : MinerBackend(parent)
     , mThread(new QThread())
     , mWorker(new CudaMinerWorker())
     , mActive(false)
@@ -220,28 +237,17 @@ CudaMiner::CudaMiner(QObject* parent)
     // Connect result ready signal
     connect(mWorker, &CudaMinerWorker::resultReady, this, 
             [this](bool success, const QString& message, uint32_t winningNonce) {
+                mFrameTimer.stop();
+                sampleProgress();
                 mActive = false;
                 mPaused = false;
                 mWinningNonce = winningNonce;
                 emit miningCompleted(success, message);
             });
     
-    // Connect progress updated signal
-    connect(mWorker, &CudaMinerWorker::progressUpdated, this,
-            [this](int progress, uint64_t triedNonces, const QString& bestHash) {
-                mTriedNonces = triedNonces;
-                if (!bestHash.isEmpty()) {
-                    mBestHashFound = bestHash;
-                }
-                emit progressUpdated(progress, triedNonces, mBestHashFound);
-            });
-    
-    // Connect hash rate updated signal
-    connect(mWorker, &CudaMinerWorker::hashRateUpdated, this,
-            [this](int hashRate) {
-                mHashRate = hashRate;
-                emit hashRateUpdated(hashRate);
-            });
+    // Progress is sampled at a fixed frame rate rather than pushed per batch
+    mFrameTimer.setInterval(100);
+    connect(&mFrameTimer, &QTimer::timeout, this, &CudaMiner::sampleProgress);
     
     // Start thread
     mThread->start();
@@ -271,7 +277,7 @@ void CudaMiner::startMining(
     int maxTimeSeconds)
 {
     if (mActive) {
-        qDebug() << "Mining already active";
+        LOG_WARNING("Mining already active");
         return;
     }
     
@@ -285,6 +291,7 @@ void CudaMiner::startMining(
     
     // Signal that mining has started
     emit miningStarted();
+    mFrameTimer.start();
     
     // Start mining in worker thread
     QMetaObject::invokeMethod(mWorker, "doMining", Qt::QueuedConnection,
@@ -304,7 +311,7 @@ void CudaMiner::stopMining()
         return;
     }
     
-    QMetaObject::invokeMethod(mWorker, "stopMining", Qt::QueuedConnection);
+    mWorker->stopMining();
 }
 
 void CudaMiner::pauseMining()
@@ -313,7 +320,7 @@ void CudaMiner::pauseMining()
         return;
     }
     
-    QMetaObject::invokeMethod(mWorker, "pauseMining", Qt::QueuedConnection);
+    mWorker->pauseMining();
     mPaused = true;
 }
 
@@ -323,6 +330,27 @@ void CudaMiner::resumeMining()
         return;
     }
     
-    QMetaObject::invokeMethod(mWorker, "resumeMining", Qt::QueuedConnection);
+    mWorker->resumeMining();
     mPaused = false;
 }
+
+void CudaMiner::sampleProgress()
+{
+    MiningProgress progress;
+    if (!mWorker->progress().sample(&progress)) {
+        return;
+    }
+    
+    // Share of the nonce space covered so far
+    MiningSnapshot snapshot;
+    snapshot.progress = static_cast<int>((uint64_t)progress.next_nonce * 100 / 0xFFFFFFFFull);
+    if (snapshot.progress > 99) snapshot.progress = 99;
+    snapshot.hashes = progress.hashes;
+    snapshot.hashRate = progress.hash_rate;
+    snapshot.elapsed = progress.elapsed;
+    snapshot.shares = mWorker->acceptedSolutions();
+    
+    mTriedNonces = progress.hashes;
+    mHashRate = progress.hash_rate >= INT_MAX ? INT_MAX : static_cast<int>(progress.hash_rate);
+    emit progressSampled(snapshot);
+}
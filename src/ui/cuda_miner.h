@@ -3,9 +3,16 @@
 #include <QObject>
 #include <QThread>
 #include <QMutex>
+#include <QTimer>
 #include <QWaitCondition>
+#include <atomic>
+#include <memory>
 #include <cuda_runtime.h>
 #include "../miner.cuh"
+#include "../cuda_engine.hpp"
+#include "../mining_progress.hpp"
+#include "../ticket_verifier.hpp"
+#include "miner_backend.h"
 
 class CudaMiner;
 
@@ -19,30 +26,39 @@ public:
 
     void setCudaMiner(CudaMiner* miner) { m_miner = miner; }
 
+    // Written at batch boundaries by the mining thread, safe to sample anywhere
+    const ProgressObserver& progress() const { return mProgress; }
+    uint64_t acceptedSolutions() const { return mVerifier.accepted(); }
+
 public slots:
     void doMining(const QString& hash, const QString& addr1, const QString& addr2, 
                   uint64_t value, uint64_t timestamp, uint32_t flag,
                   const QString& targetStr, int maxTimeSeconds);
+
+    // These only set flags and are called directly from the GUI thread:
+    // a queued call would wait behind the blocking doMining
     void stopMining();
     void pauseMining();
     void resumeMining();
 
 signals:
     void resultReady(bool success, const QString& message, uint32_t winningNonce = 0);
-    void progressUpdated(int progress, uint64_t triedNonces, const QString& bestHash);
-    void hashRateUpdated(int hashRate);
 
 private:
     QString bytesToHexString(const uint8_t* bytes, size_t len);
     
     QMutex mPauseMutex;
     QWaitCondition mPauseCondition;
-    bool mShouldStop;
-    bool mPaused;
+    std::atomic<bool> mShouldStop;
+    std::atomic<bool> mPaused;
     CudaMiner* m_miner = nullptr;
+    TicketVerifier mVerifier;
+    std::unique_ptr<CudaEngine> mEngine;  // Created on first use, resident after that
+    ProgressObserver mProgress;
 };
 
-class CudaMiner : public QObject
+// Embedded engine: mines in this process on a worker thread
+class CudaMiner : public MinerBackend
 {
     Q_OBJECT
 
@@ -52,30 +68,28 @@ public:
 
     void startMining(const QString& hash, const QString& addr1, const QString& addr2, 
                     uint64_t value, uint64_t timestamp, uint32_t flag,
-                    const QString& targetStr, int maxTimeSeconds);
-    void stopMining();
-    void pauseMining();
-    void resumeMining();
+                    const QString& targetStr, int maxTimeSeconds) override;
+    void stopMining() override;
+    void pauseMining() override;
+    void resumeMining() override;
 
     bool isActive() const { return mActive; }
     bool isPaused() const { return mPaused; }
     int hashRate() const { return mHashRate; }
-    uint32_t winningNonce() const { return mWinningNonce; }
+    uint32_t winningNonce() const override { return mWinningNonce; }
     QString winningHash() const { return mWinningHash; }
     uint64_t triedNonces() const { return mTriedNonces; }
     QString bestHashFound() const { return mBestHashFound; }
 
     void setWinningNonce(uint32_t nonce) { mWinningNonce = nonce; }
 
-signals:
-    void miningStarted();
-    void miningCompleted(bool success, const QString& message);
-    void progressUpdated(int progress, uint64_t triedNonces, const QString& bestHash);
-    void hashRateUpdated(int hashRate);
-
 private:
+    // Samples the worker's progress snapshot once per frame
+    void sampleProgress();
+
     QThread* mThread;
     CudaMinerWorker* mWorker;
+    QTimer mFrameTimer;
     bool mActive;
     bool mPaused;
     int mHashRate;
@@ -0,0 +1,329 @@
+#include "daemon_miner.h"
+#include <chrono>
+#include "../miner.cuh"
+#include "../log.hpp"
+
+static const int kRpcTimeoutSeconds = 5;
+static const uint32_t kWatchIntervalMs = 250;
+static const int kPollIntervalMs = 500;
+
+static void set_deadline(grpc::ClientContext* context) {
+    context->set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(kRpcTimeoutSeconds));
+}
+
+static bool hex_field(const QString& hex, size_t length, std::string* out) {
+    out->assign(length, '\0');
+    if (hex.isEmpty()) {
+        return true;  // Zeros, as for the embedded engine
+    }
+    return hex.length() == (int)length * 2 &&
+           hex_to_bytes(hex.toStdString().c_str(), reinterpret_cast<uint8_t*>(&(*out)[0]), length);
+}
+
+DaemonMiner::DaemonMiner(const std::string& address, QObject* parent)
+    : MinerBackend(parent)
+    , mChannel(grpc::CreateChannel(address, grpc::InsecureChannelCredentials()))
+    , mStub(miner::MinerService::NewStub(mChannel))
+    , mWatchContext(nullptr)
+    , mStop(false)
+    , mPaused(false)
+    , mStreaming(true)
+    , mWinningNonce(0)
+{
+}
+
+DaemonMiner::~DaemonMiner()
+{
+    stopMining();
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+bool DaemonMiner::available(const std::string& address, int timeoutMs)
+{
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+    return channel->WaitForConnected(std::chrono::system_clock::now() + std::chrono::milliseconds(timeoutMs));
+}
+
+void DaemonMiner::startMining(
+    const QString& hash,
+    const QString& addr1,
+    const QString& addr2,
+    uint64_t value,
+    uint64_t timestamp,
+    uint32_t flag,
+    const QString& targetStr,
+    int maxTimeSeconds)
+{
+    miner::StartMiningV2Request request;
+    std::string hashBytes, addr1Bytes, addr2Bytes;
+    if (!hex_field(hash, 32, &hashBytes) || addr1.isEmpty() || !hex_field(addr1, 20, &addr1Bytes) ||
+        addr2.isEmpty() || !hex_field(addr2, 20, &addr2Bytes)) {
+        emit miningCompleted(false, "Invalid hash or address format");
+        return;
+    }
+    request.set_hash(hashBytes);
+    request.set_addr1(addr1Bytes);
+    request.set_addr2(addr2Bytes);
+    request.set_value(static_cast<uint32_t>(value));
+    request.set_timestamp(static_cast<uint32_t>(timestamp));
+    request.set_flag(flag);
+    // Same default as the embedded engine: 64 hex chars or, if empty, the testnet target
+    Target target = decode_compact_target(0x1d00ffff);
+    if (!targetStr.isEmpty() && !parse_target_hash(targetStr.toStdString().c_str(), &target)) {
+        emit miningCompleted(false, "Invalid target format");
+        return;
+    }
+    uint8_t targetBytes[32];
+    target_to_bytes(target, targetBytes);
+    request.set_target(std::string(reinterpret_cast<const char*>(targetBytes), sizeof(targetBytes)));
+    request.set_time_limit(maxTimeSeconds <= 0 ? 3600 : static_cast<uint32_t>(maxTimeSeconds));
+
+    // A finished previous run may still be winding down its thread
+    if (mThread.joinable()) {
+        stopMining();
+        mThread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = false;
+        mPaused = false;
+    }
+    mWinningNonce = 0;
+    mStarted = std::chrono::steady_clock::now();
+
+    emit miningStarted();
+    mThread = std::thread([this, request] { run(request); });
+}
+
+void DaemonMiner::stopMining()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+    if (mWatchContext) {
+        mWatchContext->TryCancel();
+    }
+    mWake.notify_all();
+}
+
+void DaemonMiner::pauseMining()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPaused = true;
+    if (mWatchContext) {
+        mWatchContext->TryCancel();
+    }
+    mWake.notify_all();
+}
+
+void DaemonMiner::resumeMining()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPaused = false;
+    mWake.notify_all();
+}
+
+bool DaemonMiner::interrupted()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStop || mPaused;
+}
+
+void DaemonMiner::publish(const miner::GetStatusV2Response& status)
+{
+    // Same progress scale as the embedded engine: share of the nonce space
+    MiningSnapshot snapshot;
+    snapshot.progress = static_cast<int>((uint64_t)status.current_nonce() * 100 / 0xFFFFFFFFull);
+    if (snapshot.progress > 99) snapshot.progress = 99;
+    snapshot.hashes = status.total_hashes();
+    snapshot.hashRate = status.hash_rate() * 1e6;  // Reported in MH/s
+    snapshot.elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - mStarted).count();
+    snapshot.shares = status.verified_solutions();
+    emit progressSampled(snapshot);
+}
+
+DaemonMiner::Outcome DaemonMiner::follow(const std::string& sessionId, std::string* error)
+{
+    if (!mStreaming) {
+        return poll(sessionId, error);
+    }
+
+    grpc::ClientContext context;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mStop || mPaused) {
+            return Interrupted;
+        }
+        mWatchContext = &context;
+    }
+    miner::WatchStatusRequest request;
+    request.set_session_id(sessionId);
+    request.set_interval_ms(kWatchIntervalMs);
+    std::unique_ptr<grpc::ClientReader<miner::GetStatusV2Response>> reader = mStub->WatchStatus(&context, request);
+
+    miner::GetStatusV2Response status;
+    bool found = false;
+    while (reader->Read(&status)) {
+        publish(status);
+        found = status.solution_found();
+        if (found) {
+            mWinningNonce = status.current_nonce();
+        }
+    }
+    grpc::Status result = reader->Finish();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWatchContext = nullptr;
+    }
+
+    if (interrupted()) {
+        return Interrupted;
+    }
+    if (result.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+        LOG_INFO("Mining server has no status stream, polling instead");
+        mStreaming = false;
+        return poll(sessionId, error);
+    }
+    if (!result.ok()) {
+        *error = result.error_message();
+        return Lost;
+    }
+    return found ? Found : Ended;
+}
+
+DaemonMiner::Outcome DaemonMiner::poll(const std::string& sessionId, std::string* error)
+{
+    for (;;) {
+        miner::GetStatusRequest request;
+        request.set_session_id(sessionId);
+        miner::GetStatusV2Response status;
+        grpc::ClientContext context;
+        set_deadline(&context);
+        grpc::Status result = mStub->GetStatusV2(&context, request, &status);
+        if (!result.ok()) {
+            *error = result.error_message();
+            return Lost;
+        }
+        publish(status);
+        if (status.solution_found()) {
+            mWinningNonce = status.current_nonce();
+            return Found;
+        }
+        if (!status.is_mining()) {
+            return Ended;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWake.wait_for(lock, std::chrono::milliseconds(kPollIntervalMs), [this] { return mStop || mPaused; });
+        if (mStop || mPaused) {
+            return Interrupted;
+        }
+    }
+}
+
+grpc::Status DaemonMiner::pauseSession(const std::string& sessionId, bool cancel, miner::PauseMiningResponse* response)
+{
+    miner::PauseMiningRequest request;
+    request.set_session_id(sessionId);
+    request.set_cancel(cancel);
+    grpc::ClientContext context;
+    set_deadline(&context);
+    return mStub->PauseMining(&context, request, response);
+}
+
+void DaemonMiner::run(miner::StartMiningV2Request request)
+{
+    miner::StartMiningResponse started;
+    grpc::ClientContext startContext;
+    set_deadline(&startContext);
+    grpc::Status result = mStub->StartMiningV2(&startContext, request, &started);
+    if (!result.ok() || !started.success()) {
+        std::string message = result.ok() ? started.message() : result.error_message();
+        emit miningCompleted(false, QString("Mining server refused the job: %1").arg(QString::fromStdString(message)));
+        return;
+    }
+    std::string sessionId = started.session_id();
+    LOG_INFO("Mining on server session {}", sessionId);
+
+    for (;;) {
+        std::string error;
+        Outcome outcome = follow(sessionId, &error);
+        if (outcome == Found) {
+            emit miningCompleted(true, QString("Found valid block with nonce: %1").arg(mWinningNonce.load()));
+            return;
+        }
+        if (outcome == Ended) {
+            emit miningCompleted(false, "Mining failed or was stopped");
+            return;
+        }
+        if (outcome == Lost) {
+            emit miningCompleted(false, QString("Lost mining server: %1").arg(QString::fromStdString(error)));
+            return;
+        }
+
+        // Stop ends the session on the server; pause parks it there with its state
+        bool stop;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            stop = mStop;
+        }
+        miner::PauseMiningResponse paused;
+        result = pauseSession(sessionId, stop, &paused);
+        if (result.error_code() == grpc::StatusCode::FAILED_PRECONDITION) {
+            // Finished on its own meanwhile; report how it ended
+            mStreaming = false;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mPaused = false;
+                mStop = false;
+            }
+            outcome = poll(sessionId, &error);
+            emit miningCompleted(outcome == Found,
+                outcome == Found ? QString("Found valid block with nonce: %1").arg(mWinningNonce.load())
+                                 : QString("Mining failed or was stopped"));
+            return;
+        }
+        if (!result.ok()) {
+            emit miningCompleted(false, QString("Lost mining server: %1").arg(QString::fromStdString(result.error_message())));
+            return;
+        }
+        if (stop) {
+            emit miningCompleted(false, "Mining was stopped by user");
+            return;
+        }
+
+        std::string stateFile = paused.state_file();
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait(lock, [this] { return mStop || !mPaused; });
+            stop = mStop;
+        }
+        if (stop) {
+            // Stopped while paused: the parked session is no longer wanted
+            miner::PauseMiningResponse cancelled;
+            result = pauseSession(sessionId, true, &cancelled);
+            if (!result.ok()) {
+                LOG_WARNING("Failed to cancel paused server session {}: {}", sessionId, result.error_message());
+            }
+            emit miningCompleted(false, "Mining was stopped by user");
+            return;
+        }
+
+        // Same session, with what is left of its budget; servers without
+        // in-memory pause fall back to the state file
+        miner::ResumeMiningRequest resumeRequest;
+        resumeRequest.set_session_id(sessionId);
+        resumeRequest.set_state_file(stateFile);
+        miner::ResumeMiningResponse resumed;
+        grpc::ClientContext resumeContext;
+        set_deadline(&resumeContext);
+        result = mStub->ResumeMining(&resumeContext, resumeRequest, &resumed);
+        if (!result.ok() || !resumed.success()) {
+            std::string message = result.ok() ? resumed.message() : result.error_message();
+            emit miningCompleted(false, QString("Failed to resume on mining server: %1").arg(QString::fromStdString(message)));
+            return;
+        }
+        sessionId = resumed.session_id();
+    }
+}
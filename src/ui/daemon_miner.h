@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <grpcpp/grpcpp.h>
+#include "miner_backend.h"
+#include "../generated/miner.grpc.pb.h"
+
+// Thin client of a running mining server: the job is started there and its
+// progress followed over WatchStatus (GetStatusV2 polling on servers without
+// it), so the server keeps sole ownership of the hardware. Pause maps to
+// PauseMining and resume to ResumeMining; stop cancels the server session.
+class DaemonMiner : public MinerBackend
+{
+    Q_OBJECT
+
+public:
+    explicit DaemonMiner(const std::string& address, QObject* parent = nullptr);
+    ~DaemonMiner();
+
+    // True when a server accepts a connection at address within the timeout
+    static bool available(const std::string& address, int timeoutMs);
+
+    void startMining(const QString& hash, const QString& addr1, const QString& addr2,
+                     uint64_t value, uint64_t timestamp, uint32_t flag,
+                     const QString& targetStr, int maxTimeSeconds) override;
+    void stopMining() override;
+    void pauseMining() override;
+    void resumeMining() override;
+
+    uint32_t winningNonce() const override { return mWinningNonce; }
+
+    // The server broadcasts with its own node RPC settings
+    bool submitsSolutions() const override { return true; }
+
+private:
+    enum Outcome {
+        Found,
+        Ended,        // Time limit reached without a solution
+        Interrupted,  // Pause or stop requested
+        Lost          // RPC failure
+    };
+
+    void run(miner::StartMiningV2Request request);
+    Outcome follow(const std::string& sessionId, std::string* error);
+    Outcome poll(const std::string& sessionId, std::string* error);
+    grpc::Status pauseSession(const std::string& sessionId, bool cancel, miner::PauseMiningResponse* response);
+    void publish(const miner::GetStatusV2Response& status);
+    bool interrupted();
+
+    std::shared_ptr<grpc::Channel> mChannel;
+    std::unique_ptr<miner::MinerService::Stub> mStub;
+    std::thread mThread;
+
+    std::mutex mMutex;                  // Guards the flags and mWatchContext
+    std::condition_variable mWake;
+    grpc::ClientContext* mWatchContext; // Open status stream, cancelled on pause or stop
+    bool mStop;
+    bool mPaused;
+    bool mStreaming;                    // Cleared when the server lacks WatchStatus
+    std::atomic<uint32_t> mWinningNonce;
+    std::chrono::steady_clock::time_point mStarted;  // Set before the thread starts
+};
@@ -0,0 +1,112 @@
+#include "hash_rate_chart.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+
+QString formatHashRate(double hashRate)
+{
+    // Display hash rate in appropriate units (H/s, KH/s, MH/s, GH/s)
+    QString unit;
+    double displayRate = hashRate;
+
+    if (hashRate >= 1e9) {
+        displayRate = hashRate / 1e9;
+        unit = "GH/s";
+    } else if (hashRate >= 1e6) {
+        displayRate = hashRate / 1e6;
+        unit = "MH/s";
+    } else if (hashRate >= 1e3) {
+        displayRate = hashRate / 1e3;
+        unit = "KH/s";
+    } else {
+        unit = "H/s";
+    }
+
+    return QString("%1 %2").arg(displayRate, 0, 'f', 2).arg(unit);
+}
+
+HashRateChart::HashRateChart(QWidget* parent)
+    : QWidget(parent)
+    , mHistory(nullptr)
+{
+    setMinimumHeight(80);
+}
+
+void HashRateChart::setHistory(const RateHistory* history)
+{
+    mHistory = history;
+    update();
+}
+
+void HashRateChart::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    painter.setPen(palette().mid().color());
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+
+    if (!mHistory || mHistory->size() < 2) {
+        painter.setPen(palette().text().color());
+        painter.drawText(rect(), Qt::AlignCenter, "No hash rate samples yet");
+        return;
+    }
+
+    // One bucket per pixel column inside the frame
+    const QRect plot = rect().adjusted(1, 16, -1, -1);
+    mBuckets.resize(std::max(1, plot.width()));
+    mHistory->decimate(mBuckets.data(), mBuckets.size());
+
+    float peak = 0;
+    for (const RateBucket& bucket : mBuckets) {
+        peak = std::max(peak, bucket.maxRate);
+    }
+    if (peak <= 0) {
+        peak = 1;
+    }
+    const double scale = plot.height() / (peak * 1.1);
+    auto y = [&](float rate) { return plot.bottom() - static_cast<int>(rate * scale); };
+
+    // Min/max band, then the average line, then share markers
+    QColor band = palette().highlight().color();
+    band.setAlpha(70);
+    painter.setPen(band);
+    for (size_t i = 0; i < mBuckets.size(); i++) {
+        if (mBuckets[i].count) {
+            int x = plot.left() + static_cast<int>(i);
+            painter.drawLine(x, y(mBuckets[i].minRate), x, y(mBuckets[i].maxRate));
+        }
+    }
+
+    QPainterPath average;
+    bool drawing = false;
+    for (size_t i = 0; i < mBuckets.size(); i++) {
+        if (!mBuckets[i].count) {
+            continue;  // Keep the line across gaps
+        }
+        QPointF point(plot.left() + i, y(mBuckets[i].avgRate));
+        if (drawing) {
+            average.lineTo(point);
+        } else {
+            average.moveTo(point);
+            drawing = true;
+        }
+    }
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(palette().highlight().color(), 1.5));
+    painter.drawPath(average);
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 160, 0));
+    for (size_t i = 0; i < mBuckets.size(); i++) {
+        if (mBuckets[i].shares) {
+            painter.drawEllipse(QPointF(plot.left() + i, plot.top() + 4), 3, 3);
+        }
+    }
+
+    painter.setPen(palette().text().color());
+    painter.drawText(rect().adjusted(4, 1, -4, 0), Qt::AlignLeft | Qt::AlignTop,
+                     QString("Peak %1").arg(formatHashRate(peak)));
+    painter.drawText(rect().adjusted(4, 1, -4, 0), Qt::AlignRight | Qt::AlignTop,
+                     QString("Last %1 s").arg(mHistory->endTime() - mHistory->startTime(), 0, 'f', 0));
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QWidget>
+#include <QString>
+#include <vector>
+#include "rate_history.h"
+
+// "123.45 MH/s" style display of a rate in H/s
+QString formatHashRate(double hashRate);
+
+// Hash rate over the retained history: a min/max band per column with the
+// average drawn through it, and a marker wherever shares were accepted.
+// Repaints only when told to, so callers control the frame rate.
+class HashRateChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HashRateChart(QWidget* parent = nullptr);
+
+    void setHistory(const RateHistory* history);
+
+    QSize sizeHint() const override { return QSize(400, 120); }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    const RateHistory* mHistory;
+    std::vector<RateBucket> mBuckets;  // Reused across repaints
+};
@@ -5,6 +5,8 @@
 #include <QCoreApplication>
 #include <iostream>
 #include "../miner_config.hpp"
+#include "../trace.hpp"
+#include "../log.hpp"
 #include "main_window.h"
 
 int main(int argc, char *argv[])
@@ -42,6 +44,8 @@ int main(int argc, char *argv[])
     
     // Load miner config
     MinerConfig config = MinerConfig::fromFile(configPath.toStdString());
+    trace_enable(!config.trace_file.empty());
+    log_configure(config.log_level, config.log_file);
     
     // Create main window
     MainWindow mainWindow(config);
@@ -35,6 +35,8 @@ MainWindow::~MainWindow()
 {
     if (mCurrentTask) {
         logMessage("Cleaning up mining task");
+        mFrameTimer.stop();
+        mHashRateChart->setHistory(nullptr);
         mCurrentTask->stop();
         delete mCurrentTask;
         mCurrentTask = nullptr;
@@ -112,10 +114,13 @@ void MainWindow::setupUi()
     mBestHashLabel = new QLabel("--", statsGroupBox);
     mTriedNoncesLabel = new QLabel("0", statsGroupBox);
     
+    mHashRateChart = new HashRateChart(statsGroupBox);
+    
     // Add stats labels to layout
     statsLayout->addRow("Hash Rate:", mHashRateLabel);
     statsLayout->addRow("Best Hash:", mBestHashLabel);
     statsLayout->addRow("Tried Nonces:", mTriedNoncesLabel);
+    statsLayout->addRow(mHashRateChart);
     
     // Add status and stats group boxes to main layout
     mainLayout->addWidget(statusGroupBox);
@@ -160,6 +165,10 @@ void MainWindow::setupUi()
     connect(mSettingsButton, &QPushButton::clicked, this, &MainWindow::openSettings);
     connect(mHistoryButton, &QPushButton::clicked, this, &MainWindow::openHistory);
     
+    // 20 frames per second; ticks with nothing new are skipped
+    mFrameTimer.setInterval(50);
+    connect(&mFrameTimer, &QTimer::timeout, this, &MainWindow::refreshProgress);
+    
     // Initialize button states
     mPauseButton->setEnabled(false);
     mStopButton->setEnabled(false);
@@ -210,6 +219,8 @@ void MainWindow::createMiningTask()
 {
     // Clean up any existing task
     if (mCurrentTask) {
+        mFrameTimer.stop();
+        mHashRateChart->setHistory(nullptr);
         mCurrentTask->stop();
         delete mCurrentTask;
         mCurrentTask = nullptr;
@@ -225,11 +236,8 @@ void MainWindow::createMiningTask()
     connect(mCurrentTask, &MiningTask::statusChanged,
             this, &MainWindow::handleMiningStatusChanged);
     
-    connect(mCurrentTask, &MiningTask::progressChanged,
-            this, &MainWindow::updateProgress);
-    
-    connect(mCurrentTask, &MiningTask::hashRateChanged,
-            this, &MainWindow::updateHashRate);
+    mHashRateChart->setHistory(&mCurrentTask->history());
+    mDrawnSerial = mCurrentTask->snapshotSerial();
     
     // Update UI for the new task
     updateUiState();
@@ -256,40 +264,21 @@ void MainWindow::startMining()
     updateButtonState();
 }
 
-void MainWindow::updateProgress(int progress, const QString& progressInfo)
+void MainWindow::refreshProgress()
 {
-    if (!mCurrentTask) {
+    if (!mCurrentTask || mCurrentTask->snapshotSerial() == mDrawnSerial) {
         return;
     }
+    mDrawnSerial = mCurrentTask->snapshotSerial();
     
-    mProgressBar->setValue(progress);
-    mProgressInfoLabel->setText(progressInfo);
-    
-    // Update tried nonces and best hash from the current task
-    mTriedNoncesLabel->setText(QString::number(mCurrentTask->getTriedNonces()));
+    const MiningSnapshot& snapshot = mCurrentTask->snapshot();
+    mProgressBar->setValue(snapshot.progress);
+    mProgressInfoLabel->setText(QString("Tried %1 nonces in %2 s")
+                                .arg(snapshot.hashes).arg(snapshot.elapsed, 0, 'f', 1));
+    mTriedNoncesLabel->setText(QString::number(snapshot.hashes));
     mBestHashLabel->setText(mCurrentTask->getBestHash());
-}
-
-void MainWindow::updateHashRate(int hashRate)
-{
-    // Display hash rate in appropriate units (H/s, KH/s, MH/s, GH/s)
-    QString unit;
-    double displayRate = hashRate;
-    
-    if (hashRate >= 1e9) {
-        displayRate = hashRate / 1e9;
-        unit = "GH/s";
-    } else if (hashRate >= 1e6) {
-        displayRate = hashRate / 1e6;
-        unit = "MH/s";
-    } else if (hashRate >= 1e3) {
-        displayRate = hashRate / 1e3;
-        unit = "KH/s";
-    } else {
-        unit = "H/s";
-    }
-    
-    mHashRateLabel->setText(QString("%1 %2").arg(displayRate, 0, 'f', 2).arg(unit));
+    mHashRateLabel->setText(formatHashRate(snapshot.hashRate));
+    mHashRateChart->update();
 }
 
 void MainWindow::logMessage(const QString& message)
@@ -314,6 +303,14 @@ void MainWindow::logMessage(const QString& message)
 
 void MainWindow::handleMiningStatusChanged(MiningTask::Status status)
 {
+    // Frames only while mining; the last snapshot is drawn once on the way out
+    if (status == MiningTask::Running) {
+        mFrameTimer.start();
+    } else {
+        refreshProgress();
+        mFrameTimer.stop();
+    }
+    
     switch (status) {
         case MiningTask::Idle:
             mStatusLabel->setText("Ready");
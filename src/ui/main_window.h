@@ -10,6 +10,7 @@
 #include <QFormLayout>
 #include <QTextEdit>
 #include <QScrollBar>
+#include <QTimer>
 #include <memory>
 #include <map>
 
@@ -17,6 +18,7 @@
 #include "settings_dialog.h"
 #include "history_dialog.h"
 #include "mining_task.h"
+#include "hash_rate_chart.h"
 
 class SettingsDialog;
 class HistoryDialog;
@@ -35,8 +37,7 @@ private slots:
     void openSettings();
     void openHistory();
     void handleMiningStatusChanged(MiningTask::Status status);
-    void updateProgress(int progress, const QString& progressInfo);
-    void updateHashRate(int hashRate);
+    void refreshProgress();
 
 private:
     void setupUi();
@@ -80,4 +81,9 @@ private:
     QLabel* mHashRateLabel;
     QLabel* mBestHashLabel;
     QLabel* mTriedNoncesLabel;
+    HashRateChart* mHashRateChart;
+
+    // Progress is redrawn at most once per frame, whatever the update rate
+    QTimer mFrameTimer;
+    uint64_t mDrawnSerial = 0;
 };
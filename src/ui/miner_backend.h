@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QObject>
+#include <QMetaType>
+#include <QString>
+#include <cstdint>
+
+// Progress of the running job. Plain data, so a queued cross-thread signal
+// carries no heap allocation.
+struct MiningSnapshot {
+    int progress;        // Percent of the nonce space covered, 0-99
+    uint64_t hashes;     // Nonces tried
+    double hashRate;     // H/s
+    float elapsed;       // Seconds spent mining
+    uint64_t shares;     // Solutions accepted
+};
+Q_DECLARE_METATYPE(MiningSnapshot)
+
+// What MiningTask drives: the embedded engine (CudaMiner) or a running
+// mining server (DaemonMiner). Signals may be emitted from a worker thread.
+class MinerBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MinerBackend(QObject* parent = nullptr) : QObject(parent) {}
+    virtual ~MinerBackend() {}
+
+    virtual void startMining(const QString& hash, const QString& addr1, const QString& addr2,
+                             uint64_t value, uint64_t timestamp, uint32_t flag,
+                             const QString& targetStr, int maxTimeSeconds) = 0;
+    virtual void stopMining() = 0;
+    virtual void pauseMining() = 0;
+    virtual void resumeMining() = 0;
+
+    virtual uint32_t winningNonce() const = 0;
+
+    // True when found tickets are broadcast by the backend itself
+    virtual bool submitsSolutions() const { return false; }
+
+signals:
+    void miningStarted();
+    void miningCompleted(bool success, const QString& message);
+    void progressSampled(const MiningSnapshot& snapshot);
+};
@@ -1,16 +1,26 @@
 #include "mining_task.h"
-#include <QDebug>
 #include <QStandardPaths>
 #include <QDir>
 #include <QMetaType>
 #include <QTcpSocket>
 #include "cuda_miner.h"
+#include "daemon_miner.h"
 #include "../miner.cuh"  // For hex_to_bytes and MiningHeader
+#include "../trace.hpp"
+
+// Level check first, so a disabled level costs no QString building
+#define TASK_LOG(level, message)                                    \
+    do {                                                            \
+        if (log_enabled(MiningTask::severity(level))) {             \
+            logMessage(message, level);                             \
+        }                                                           \
+    } while (0)
 
 // Register uint64_t and uint32_t for Qt's meta-type system
 static bool registerTypes() {
     qRegisterMetaType<uint64_t>("uint64_t");
     qRegisterMetaType<uint32_t>("uint32_t");
+    qRegisterMetaType<MiningSnapshot>("MiningSnapshot");
     return true;
 }
 static bool typesRegistered = registerTypes();
@@ -20,17 +30,17 @@ MiningTask::MiningTask(const MinerConfig& config, const QString& sessionId, QObj
     , mConfig(config)
     , mSessionId(sessionId)
     , mStatus(Idle)
-    , mCudaMiner(nullptr)
-    , mProgress(0)
-    , mHashRate(0)
-    , mTriedNonces(0)
+    , mMiner(nullptr)
+    , mSnapshot()
+    , mSnapshotSerial(0)
     , mBestHash("")
     , mLeaderAddress("")
     , mRewardAddress("")
     , mValue(0)
     , mTimestamp(0)
+    , mTicketReady(false)
 {
-    logMessage("Mining task created with session ID: " + mSessionId);
+    TASK_LOG(LogLevel::Info, "Mining task created with session ID: " + mSessionId);
 }
 
 MiningTask::~MiningTask()
@@ -38,38 +48,32 @@ MiningTask::~MiningTask()
     // Stop mining if it's running
     stop();
     
-    // Delete CUDA miner
-    if (mCudaMiner) {
-        delete mCudaMiner;
-        mCudaMiner = nullptr;
+    // Delete the miner backend
+    if (mMiner) {
+        delete mMiner;
+        mMiner = nullptr;
     }
     
-    logMessage("Mining task destroyed");
+    TASK_LOG(LogLevel::Info, "Mining task destroyed");
 }
 
-void MiningTask::logMessage(const QString& message, LogLevel level) const
+LogSeverity MiningTask::severity(LogLevel level)
 {
-    // Prefix based on log level
-    QString prefix;
     switch (level) {
-        case LogLevel::Info:    prefix = "[INFO]"; break;
-        case LogLevel::Debug:   prefix = "[DEBUG]"; break;
-        case LogLevel::Warning: prefix = "[WARNING]"; break;
-        case LogLevel::Error:   prefix = "[ERROR]"; break;
+        case LogLevel::Debug:   return LogSeverity::Debug;
+        case LogLevel::Warning: return LogSeverity::Warning;
+        case LogLevel::Error:   return LogSeverity::Error;
+        default:                return LogSeverity::Info;
+    }
+}
+
+void MiningTask::logMessage(const QString& message, LogLevel level) const
+{
+    // Timestamp and level prefix are added by the log writer thread
+    LogSeverity sev = severity(level);
+    if (log_enabled(sev)) {
+        log_write(sev, "[Session: {}] {}", mSessionId.toStdString(), message.toStdString());
     }
-    
-    // Get current timestamp
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz");
-    
-    // Format log message
-    QString formattedMessage = QString("%1 %2 [Session: %3] %4")
-                                .arg(timestamp)
-                                .arg(prefix)
-                                .arg(mSessionId)
-                                .arg(message);
-    
-    // Print to console
-    qDebug() << formattedMessage;
 }
 
 void MiningTask::pause()
@@ -78,10 +82,10 @@ void MiningTask::pause()
         return;
     }
     
-    logMessage("Pausing mining task");
+    TASK_LOG(LogLevel::Info, "Pausing mining task");
     
-    if (mCudaMiner) {
-        mCudaMiner->pauseMining();
+    if (mMiner) {
+        mMiner->pauseMining();
     }
     
     setStatus(Paused);
@@ -93,10 +97,10 @@ void MiningTask::resume()
         return;
     }
     
-    logMessage("Resuming mining task");
+    TASK_LOG(LogLevel::Info, "Resuming mining task");
     
-    if (mCudaMiner) {
-        mCudaMiner->resumeMining();
+    if (mMiner) {
+        mMiner->resumeMining();
     }
     
     setStatus(Running);
@@ -108,40 +112,46 @@ void MiningTask::stop()
         return;
     }
     
-    logMessage("Stopping mining task");
+    TASK_LOG(LogLevel::Info, "Stopping mining task");
     
-    if (mCudaMiner) {
+    if (mMiner) {
         // Ensure mining is fully stopped
-        mCudaMiner->stopMining();
+        mMiner->stopMining();
     }
     
     // Set the status to Idle to ensure we're really stopped
     setStatus(Idle);
     
-    logMessage("Mining task stopped successfully");
+    TASK_LOG(LogLevel::Info, "Mining task stopped successfully");
 }
 
 std::pair<QString, uint64_t> MiningTask::getSupportableLeader() const
 {
     try {
-        logMessage("Getting supportable leader from RPC...");
+        TASK_LOG(LogLevel::Info, "Getting supportable leader from RPC...");
         
         // Use Bitcoin RPC to get supportable leader
-        BitcoinRPC rpc(mConfig.rpc_host, mConfig.rpc_port, mConfig.rpc_user, mConfig.rpc_password);
-        
-        auto result = rpc.getSupportableLeader();
+        auto result = rpc().getSupportableLeader();
         
-        logMessage(QString("Got supportable leader: %1, height: %2")
+        TASK_LOG(LogLevel::Info, QString("Got supportable leader: %1, height: %2")
                    .arg(QString::fromStdString(result.first))
                    .arg(result.second));
         
         return {QString::fromStdString(result.first), result.second};
     } catch (const std::exception& e) {
-        logMessage(QString("Error getting supportable leader: %1").arg(e.what()), LogLevel::Error);
+        TASK_LOG(LogLevel::Error, QString("Error getting supportable leader: %1").arg(e.what()));
         throw;
     }
 }
 
+BitcoinRPC& MiningTask::rpc() const
+{
+    if (!mRpc) {
+        mRpc = std::make_unique<BitcoinRPC>(mConfig.rpc_host, mConfig.rpc_port, mConfig.rpc_user, mConfig.rpc_password);
+    }
+    return *mRpc;
+}
+
 void MiningTask::setStatus(Status status)
 {
     if (mStatus != status) {
@@ -158,7 +168,7 @@ void MiningTask::setStatus(Status status)
             case Failed: statusStr = "Failed"; break;
         }
         
-        logMessage(QString("Mining task status changed to: %1").arg(statusStr));
+        TASK_LOG(LogLevel::Info, QString("Mining task status changed to: %1").arg(statusStr));
     }
 }
 
@@ -168,7 +178,10 @@ void MiningTask::startMining()
         return;
     }
     
-    logMessage("Starting mining task");
+    TASK_LOG(LogLevel::Info, "Starting mining task");
+    mSnapshot = MiningSnapshot();
+    mHistory.clear();
+    mSnapshotSerial++;
     
     try {
         // Get supportable leader from RPC
@@ -188,33 +201,38 @@ void MiningTask::startMining()
         mValue = value;
         mTimestamp = timestamp;
         
-        logMessage("Mining parameters:");
-        logMessage(QString("Hash: %1").arg(hash.isEmpty() ? "Empty (using zeros)" : hash));
-        logMessage(QString("Leader address: %1").arg(address1));
-        logMessage(QString("Reward address: %2").arg(address2));
-        logMessage(QString("Height (value): %1").arg(value));
-        logMessage(QString("Timestamp: %1 (%2)").arg(timestamp).arg(currentTime.toString()));
-        logMessage(QString("Flag: %1").arg(mConfig.flag));
-        
-        // Create and start the CUDA miner
-        if (!mCudaMiner) {
-            mCudaMiner = new CudaMiner(this);
+        TASK_LOG(LogLevel::Info, "Mining parameters:");
+        TASK_LOG(LogLevel::Info, QString("Hash: %1").arg(hash.isEmpty() ? "Empty (using zeros)" : hash));
+        TASK_LOG(LogLevel::Info, QString("Leader address: %1").arg(address1));
+        TASK_LOG(LogLevel::Info, QString("Reward address: %2").arg(address2));
+        TASK_LOG(LogLevel::Info, QString("Height (value): %1").arg(value));
+        TASK_LOG(LogLevel::Info, QString("Timestamp: %1 (%2)").arg(timestamp).arg(currentTime.toString()));
+        TASK_LOG(LogLevel::Info, QString("Flag: %1").arg(mConfig.flag));
+        
+        mTicketReady = buildTicketTemplate();
+        
+        // Attach to a running mining server, or mine in-process without one
+        if (!mMiner) {
+            if (!mConfig.daemon_address.empty() && DaemonMiner::available(mConfig.daemon_address, 500)) {
+                TASK_LOG(LogLevel::Info, QString("Attached to mining server at %1").arg(QString::fromStdString(mConfig.daemon_address)));
+                mMiner = new DaemonMiner(mConfig.daemon_address, this);
+            } else {
+                TASK_LOG(LogLevel::Info, "No mining server found, mining in-process");
+                mMiner = new CudaMiner(this);
+            }
             
             // Connect signals
-            connect(mCudaMiner, &CudaMiner::miningStarted, 
+            connect(mMiner, &MinerBackend::miningStarted, 
                     [this]() { emit statusChanged(Running); });
             
-            connect(mCudaMiner, &CudaMiner::miningCompleted, 
+            connect(mMiner, &MinerBackend::miningCompleted, 
                     this, &MiningTask::onMiningCompleted);
             
-            connect(mCudaMiner, &CudaMiner::progressUpdated,
-                    this, &MiningTask::onProgressUpdated);
-            
-            connect(mCudaMiner, &CudaMiner::hashRateUpdated,
-                    this, &MiningTask::onHashRateUpdated);
+            connect(mMiner, &MinerBackend::progressSampled,
+                    this, &MiningTask::onProgressSampled);
         }
         
-        mCudaMiner->startMining(
+        mMiner->startMining(
             hash, 
             address1, 
             address2, 
@@ -227,174 +245,118 @@ void MiningTask::startMining()
         
         setStatus(Running);
     } catch (const std::exception& e) {
-        logMessage(QString("Error starting mining: %1").arg(e.what()), LogLevel::Error);
+        TASK_LOG(LogLevel::Error, QString("Error starting mining: %1").arg(e.what()));
         setStatus(Failed);
     }
 }
 
-void MiningTask::onProgressUpdated(int progress, uint64_t triedNonces, const QString& bestHash)
+void MiningTask::onProgressSampled(const MiningSnapshot& snapshot)
 {
-    // Update progress display
-    QString progressInfo = QString("Tried %1 nonces").arg(triedNonces);
-    if (!bestHash.isEmpty()) {
-        // Only use the first part of the hash (for space considerations)
-        QString shortHash = bestHash.left(16) + "...";
-        progressInfo += QString(", best hash: %1").arg(shortHash);
-    }
-    
-    logMessage(progressInfo, LogLevel::Debug);
-    emit progressChanged(progress, progressInfo);
-}
-
-void MiningTask::onHashRateUpdated(int hashRate)
-{
-    emit hashRateChanged(hashRate);
+    // No formatting or logging here: backends may report at any rate
+    mSnapshot = snapshot;
+    mHistory.push(snapshot.elapsed, snapshot.hashRate, snapshot.shares);
+    mSnapshotSerial++;
 }
 
 void MiningTask::onMiningCompleted(bool success, const QString& message)
 {
-    logMessage(QString("Mining completed: %1").arg(message));
+    TASK_LOG(LogLevel::Info, QString("Mining completed: %1").arg(message));
     
     if (success) {
-        if (mConfig.auto_broadcast) {
-            logMessage("Auto-broadcasting support ticket...");
+        if (mMiner && mMiner->submitsSolutions()) {
+            TASK_LOG(LogLevel::Info, "Support ticket is submitted by the mining server");
+        } else if (mConfig.auto_broadcast) {
+            TASK_LOG(LogLevel::Info, "Auto-broadcasting support ticket...");
             broadcastSupportTicket();
         }
         setStatus(Completed);
     } else {
         setStatus(Failed);
     }
+    
+    if (trace_enabled()) {
+        trace_dump(mConfig.trace_file);
+    }
+}
+
+bool MiningTask::buildTicketTemplate()
+{
+    // Create a mining header exactly like the one used for mining
+    MiningHeader header;
+    memset(&header, 0, sizeof(MiningHeader));
+    
+    // Set hash (32 bytes), empty means zeros
+    header.hash_length = 32;
+    if (!mConfig.hash.empty() && !hex_to_bytes(mConfig.hash.c_str(), header.hash, 32)) {
+        TASK_LOG(LogLevel::Error, "Invalid hash format");
+        return false;
+    }
+    
+    // Set address1 (20 bytes)
+    header.address1_length = 20;
+    if (!hex_to_bytes(mLeaderAddress.toStdString().c_str(), header.address1, 20)) {
+        TASK_LOG(LogLevel::Error, "Invalid leader address format");
+        return false;
+    }
+    
+    // Set address2 (20 bytes)
+    header.address2_length = 20;
+    if (!hex_to_bytes(mRewardAddress.toStdString().c_str(), header.address2, 20)) {
+        TASK_LOG(LogLevel::Error, "Invalid reward address format");
+        return false;
+    }
+    
+    header.value = static_cast<uint32_t>(mValue);
+    header.flag = static_cast<uint8_t>(mConfig.flag);
+    header.timestamp = static_cast<uint32_t>(mTimestamp);
+    header.nonce = 0;
+    
+    mTicketHex = TicketHexTemplate(header);
+    return true;
 }
 
 void MiningTask::broadcastSupportTicket()
 {
-    logMessage("Broadcasting support ticket");
+    TASK_LOG(LogLevel::Info, "Broadcasting support ticket");
     
     try {
-        if (!mCudaMiner) {
-            logMessage("No CUDA miner available", LogLevel::Error);
+        if (!mMiner) {
+            TASK_LOG(LogLevel::Error, "No miner available");
             return;
         }
         
-        // Get the winning nonce from the CUDA miner
-        uint32_t winningNonce = mCudaMiner->winningNonce();
-        logMessage(QString("Using winning nonce for broadcast: %1 (0x%2)")
-                  .arg(winningNonce)
-                  .arg(QString::number(winningNonce, 16).rightJustified(8, '0')));
-        
-        // Use Bitcoin RPC to broadcast the support ticket
-        BitcoinRPC rpc(mConfig.rpc_host, mConfig.rpc_port, mConfig.rpc_user, mConfig.rpc_password);
-        
-        // Create a mining header exactly like the one used for mining
-        MiningHeader header;
-        memset(&header, 0, sizeof(MiningHeader));
-        
-        // Set hash (32 bytes)
-        header.hash_length = 32;
-        if (mConfig.hash.empty()) {
-            // If hash is empty, set it to zeros
-            memset(header.hash, 0, 32);
-        } else {
-            // Convert hash string to bytes
-            if (!hex_to_bytes(mConfig.hash.c_str(), header.hash, 32)) {
-                logMessage("Invalid hash format", LogLevel::Error);
-                return;
-            }
-        }
-        
-        // Set address1 (20 bytes)
-        header.address1_length = 20;
-        if (!hex_to_bytes(mLeaderAddress.toStdString().c_str(), header.address1, 20)) {
-            logMessage("Invalid leader address format", LogLevel::Error);
-            return;
-        }
-        
-        // Set value
-        header.value = static_cast<uint32_t>(mValue);
-        
-        // Set address2 (20 bytes)
-        header.address2_length = 20;
-        if (!hex_to_bytes(mRewardAddress.toStdString().c_str(), header.address2, 20)) {
-            logMessage("Invalid reward address format", LogLevel::Error);
+        if (!mTicketReady) {
+            TASK_LOG(LogLevel::Error, "No support ticket template for this job");
             return;
         }
         
-        // Set flag
-        header.flag = static_cast<uint8_t>(mConfig.flag);
-        
-        // Set timestamp
-        header.timestamp = static_cast<uint32_t>(mTimestamp);
-        
-        // *** Set winning nonce from mining - THIS IS THE CRITICAL PART ***
-        header.nonce = winningNonce;
-        
-        // Generate the hex string from the header
-        std::stringstream ss;
-        ss << std::hex << std::setfill('0');
-        
-        // Version prefix
-        ss << "20";
-        
-        // Hash (32 bytes)
-        for (int i = 0; i < header.hash_length; i++) {
-            ss << std::setw(2) << (int)header.hash[i];
-        }
-        
-        // Address1 (20 bytes) with length prefix
-        ss << "14";  // Length prefix (20)
-        for (int i = 0; i < header.address1_length; i++) {
-            ss << std::setw(2) << (int)header.address1[i];
-        }
-        
-        // Value (block height) - 4 bytes little-endian
-        ss << std::setw(2) << (header.value & 0xFF)           // Lowest byte
-           << std::setw(2) << ((header.value >> 8) & 0xFF)    // Low byte
-           << std::setw(2) << ((header.value >> 16) & 0xFF)   // High byte
-           << std::setw(2) << ((header.value >> 24) & 0xFF);  // Highest byte
-        
-        // Address2 (20 bytes) with length prefix
-        ss << "14";  // Length prefix (20)
-        for (int i = 0; i < header.address2_length; i++) {
-            ss << std::setw(2) << (int)header.address2[i];
-        }
-        
-        // Flag (1 byte) - should be 0 or 1
-        ss << std::setw(2) << (int)header.flag;
-        
-        // Timestamp (4 bytes)
-        ss << std::setw(2) << (header.timestamp & 0xFF)
-           << std::setw(2) << ((header.timestamp >> 8) & 0xFF)
-           << std::setw(2) << ((header.timestamp >> 16) & 0xFF)
-           << std::setw(2) << ((header.timestamp >> 24) & 0xFF);
-        
-        // Nonce (4 bytes) - using the winning nonce
-        ss << std::setw(2) << (header.nonce & 0xFF)
-           << std::setw(2) << ((header.nonce >> 8) & 0xFF)
-           << std::setw(2) << ((header.nonce >> 16) & 0xFF)
-           << std::setw(2) << ((header.nonce >> 24) & 0xFF);
+        // Get the winning nonce from the miner
+        uint32_t winningNonce = mMiner->winningNonce();
+        TASK_LOG(LogLevel::Info, QString("Using winning nonce for broadcast: %1 (0x%2)")
+                  .arg(winningNonce)
+                  .arg(QString::number(winningNonce, 16).rightJustified(8, '0')));
         
-        std::string ticketData = ss.str();
+        // *** Patch the winning nonce from mining - THIS IS THE CRITICAL PART ***
+        mTicketHex.set_nonce(winningNonce);
+        std::string ticketData = mTicketHex.str();
         
         // Log detailed information about the support ticket data 
-        logMessage(QString("Broadcasting support ticket with hex data: %1").arg(QString::fromStdString(ticketData)));
-        logMessage(QString("Hash length: %1").arg(header.hash_length));
-        logMessage(QString("Address1 length: %1").arg(header.address1_length)); 
-        logMessage(QString("Address2 length: %1").arg(header.address2_length));
-        logMessage(QString("Value: 0x%1").arg(QString::number(header.value, 16)));
-        logMessage(QString("Flag: %1").arg(header.flag));
-        logMessage(QString("Timestamp: %1").arg(header.timestamp));
-        logMessage(QString("Nonce: %1 (0x%2)")
-                  .arg(header.nonce)
-                  .arg(QString::number(header.nonce, 16).rightJustified(8, '0')));
+        TASK_LOG(LogLevel::Info, QString("Broadcasting support ticket with hex data: %1").arg(QString::fromStdString(ticketData)));
+        TASK_LOG(LogLevel::Info, QString("Value: 0x%1").arg(QString::number(mValue, 16)));
+        TASK_LOG(LogLevel::Info, QString("Flag: %1").arg(mConfig.flag));
+        TASK_LOG(LogLevel::Info, QString("Timestamp: %1").arg(mTimestamp));
+        TASK_LOG(LogLevel::Info, QString("Nonce: %1 (0x%2)")
+                  .arg(winningNonce)
+                  .arg(QString::number(winningNonce, 16).rightJustified(8, '0')));
         
-        bool success = rpc.broadcastSupportTicket(ticketData);
+        bool success = rpc().broadcastSupportTicket(ticketData);
         
         if (success) {
-            logMessage("Support ticket broadcast successful");
+            TASK_LOG(LogLevel::Info, "Support ticket broadcast successful");
         } else {
-            logMessage("Support ticket broadcast failed", LogLevel::Error);
+            TASK_LOG(LogLevel::Error, "Support ticket broadcast failed");
         }
     } catch (const std::exception& e) {
-        logMessage(QString("Error broadcasting support ticket: %1").arg(e.what()), LogLevel::Error);
+        TASK_LOG(LogLevel::Error, QString("Error broadcasting support ticket: %1").arg(e.what()));
     }
 }
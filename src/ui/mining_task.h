@@ -11,10 +11,11 @@
 #include <grpcpp/grpcpp.h>
 #include "../miner_config.hpp"
 #include "../bitcoin_rpc.hpp"
+#include "../log.hpp"
+#include "../support_ticket.hpp"
 #include "../generated/miner.grpc.pb.h"
-
-// Forward declaration
-class CudaMiner;
+#include "miner_backend.h"
+#include "rate_history.h"
 
 class MiningTask : public QObject {
     Q_OBJECT
@@ -50,10 +51,16 @@ public:
     Status status() const { return mStatus; }
 
     // Get mining task information
-    int getProgress() const { return mProgress; }
-    int getHashRate() const { return mHashRate; }
+    int getProgress() const { return mSnapshot.progress; }
+    double getHashRate() const { return mSnapshot.hashRate; }
     QString getBestHash() const { return mBestHash; }
-    uint64_t getTriedNonces() const { return mTriedNonces; }
+    uint64_t getTriedNonces() const { return mSnapshot.hashes; }
+
+    // Latest progress and the hash rate history. Updates only store these and
+    // bump the serial; the window redraws from them once per frame.
+    const MiningSnapshot& snapshot() const { return mSnapshot; }
+    const RateHistory& history() const { return mHistory; }
+    uint64_t snapshotSerial() const { return mSnapshotSerial; }
     
     // Get mining data
     QString getLeaderAddress() const { return mLeaderAddress; }
@@ -65,22 +72,25 @@ public:
 signals:
     // Mining lifecycle signals
     void statusChanged(Status newStatus);
-    void progressChanged(int progress, const QString& progressInfo);
-    void hashRateChanged(int hashRate);
 
 private slots:
     // CUDA miner event handlers
-    void onProgressUpdated(int progress, uint64_t triedNonces, const QString& bestHash);
-    void onHashRateUpdated(int hashRate);
+    void onProgressSampled(const MiningSnapshot& snapshot);
     void onMiningCompleted(bool success, const QString& message);
 
 private:
     // Get supportable leader from Bitcoin RPC
     std::pair<QString, uint64_t> getSupportableLeader() const;
     
+    // Encode the ticket hex template for the current job
+    bool buildTicketTemplate();
+    
     // Broadcast support ticket when mining completes
     void broadcastSupportTicket();
     
+    // Node RPC client, kept for the task so the broadcast reuses the job fetch connection
+    BitcoinRPC& rpc() const;
+    
     // Log message helper (different log levels for different message types)
     enum LogLevel {
         Info,
@@ -89,6 +99,7 @@ private:
         Error
     };
     void logMessage(const QString& message, LogLevel level = LogLevel::Info) const;
+    static LogSeverity severity(LogLevel level);
     
     // Set task status
     void setStatus(Status status);
@@ -98,13 +109,13 @@ private:
     QString mSessionId;
     Status mStatus;
     
-    // CUDA miner for direct mining
-    CudaMiner* mCudaMiner;
+    // Mining server client, or the embedded CUDA miner without a server
+    MinerBackend* mMiner;
 
     // Progress tracking
-    int mProgress;
-    int mHashRate;
-    uint64_t mTriedNonces;
+    MiningSnapshot mSnapshot;
+    RateHistory mHistory;
+    uint64_t mSnapshotSerial;
     QString mBestHash;
 
     // Mining parameters
@@ -112,4 +123,10 @@ private:
     QString mRewardAddress;
     uint64_t mValue;
     uint64_t mTimestamp;
+    
+    // Ticket hex for the current job, only the nonce is patched at broadcast
+    TicketHexTemplate mTicketHex;
+    bool mTicketReady;
+    
+    mutable std::unique_ptr<BitcoinRPC> mRpc;
 };
@@ -0,0 +1,54 @@
+#include "rate_history.h"
+#include <algorithm>
+
+void RateHistory::push(float time, double hashRate, uint64_t shares)
+{
+    RateSample sample;
+    sample.time = time;
+    sample.hashRate = static_cast<float>(hashRate);
+    sample.shares = static_cast<uint32_t>(shares);
+    if (mSize < kCapacity) {
+        mSamples[(mHead + mSize) % kCapacity] = sample;
+        mSize++;
+    } else {
+        mSamples[mHead] = sample;
+        mHead = (mHead + 1) % kCapacity;
+    }
+}
+
+void RateHistory::decimate(RateBucket* buckets, size_t count) const
+{
+    for (size_t i = 0; i < count; i++) {
+        buckets[i] = RateBucket{0, 0, 0, 0, 0};
+    }
+    if (count == 0 || mSize == 0) {
+        return;
+    }
+
+    float start = startTime();
+    float span = std::max(endTime() - start, 1e-3f);
+    uint32_t previousShares = at(0).shares;
+    for (size_t i = 0; i < mSize; i++) {
+        const RateSample& sample = at(i);
+        size_t column = std::min(count - 1, static_cast<size_t>((sample.time - start) / span * count));
+        RateBucket& bucket = buckets[column];
+        if (bucket.count == 0) {
+            bucket.minRate = sample.hashRate;
+            bucket.maxRate = sample.hashRate;
+        } else {
+            bucket.minRate = std::min(bucket.minRate, sample.hashRate);
+            bucket.maxRate = std::max(bucket.maxRate, sample.hashRate);
+        }
+        bucket.avgRate += sample.hashRate;  // Sum until every sample is in
+        if (sample.shares > previousShares) {
+            bucket.shares += sample.shares - previousShares;
+        }
+        previousShares = sample.shares;
+        bucket.count++;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (buckets[i].count) {
+            buckets[i].avgRate /= buckets[i].count;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct RateSample {
+    float time;        // Seconds since the job started
+    float hashRate;    // H/s
+    uint32_t shares;   // Solutions accepted so far
+};
+
+// One chart column: the samples that fell into one time slice
+struct RateBucket {
+    float minRate;
+    float maxRate;
+    float avgRate;
+    uint32_t shares;   // Shares accepted within the slice
+    uint32_t count;    // Samples in the slice, 0 for a gap
+};
+
+// Fixed-size hash rate history: the newest kCapacity samples are kept and
+// older ones overwritten, so memory and redraw cost don't grow with uptime.
+// Drawing decimates it to one min/max/avg bucket per column, so dips show up
+// even when many samples share a pixel.
+class RateHistory
+{
+public:
+    static const size_t kCapacity = 4096;
+
+    RateHistory() : mHead(0), mSize(0) {}
+
+    void clear() { mHead = 0; mSize = 0; }
+    void push(float time, double hashRate, uint64_t shares);
+
+    size_t size() const { return mSize; }
+    const RateSample& at(size_t index) const { return mSamples[(mHead + index) % kCapacity]; }
+    float startTime() const { return mSize ? at(0).time : 0.0f; }
+    float endTime() const { return mSize ? at(mSize - 1).time : 0.0f; }
+
+    // Spread the retained time span over count equal slices
+    void decimate(RateBucket* buckets, size_t count) const;
+
+private:
+    RateSample mSamples[kCapacity];
+    size_t mHead;  // Oldest sample
+    size_t mSize;
+};
@@ -147,6 +147,35 @@ void SettingsDialog::saveSettings()
         j["flag"] = mConfig.flag;
         j["target"] = mConfig.target;
         j["max_time_seconds"] = mConfig.max_time_seconds;
+        j["cuda_engines"] = mConfig.cuda_engines;
+        j["cpu_engines"] = mConfig.cpu_engines;
+        j["trace_file"] = mConfig.trace_file;
+        j["log_level"] = mConfig.log_level;
+        j["log_file"] = mConfig.log_file;
+        j["stats_segment"] = mConfig.stats_segment;
+        j["coordinator"] = mConfig.coordinator;
+        j["lease_seconds"] = mConfig.lease_seconds;
+        j["lease_expiry_seconds"] = mConfig.lease_expiry_seconds;
+        j["host_lease_file"] = mConfig.host_lease_file;
+        j["http_port"] = mConfig.http_port;
+        j["http_threads"] = mConfig.http_threads;
+        j["daemon_address"] = mConfig.daemon_address;
+        j["time_budget_probability"] = mConfig.time_budget_probability;
+        j["max_time_budget"] = mConfig.max_time_budget;
+        j["schedule_by_expected_time"] = mConfig.schedule_by_expected_time;
+        j["engine_max_hash_rate"] = mConfig.engine_max_hash_rate;
+        j["engine_duty_cycle"] = mConfig.engine_duty_cycle;
+        j["verify_threads"] = mConfig.verify_threads;
+        j["spill_paused_sessions"] = mConfig.spill_paused_sessions;
+        j["session_retention_seconds"] = mConfig.session_retention_seconds;
+        j["paused_session_ttl_seconds"] = mConfig.paused_session_ttl_seconds;
+        j["max_retired_sessions"] = mConfig.max_retired_sessions;
+        j["session_archive"] = mConfig.session_archive;
+        j["duplicate_jobs"] = mConfig.duplicate_jobs;
+        j["duplicate_timestamp_window"] = mConfig.duplicate_timestamp_window;
+        j["speculative_mining"] = mConfig.speculative_mining;
+        j["speculative_share"] = mConfig.speculative_share;
+        j["leader_poll_seconds"] = mConfig.leader_poll_seconds;
         
         // Save to file
         std::ofstream file(config_path);